@@ -0,0 +1,25 @@
+; ALU benchmark: a tight loop of register arithmetic & one branch, nothing touches memory outside of
+; fetching instructions. Measures the instruction dispatcher.
+;
+;   emu_out --headless --nosound --nopace --cycles 400000000 bench\alu.gb
+
+    .title "BENCH ALU"
+
+    .org 0x150
+start:
+    di
+    ld sp, 0xFFFE
+    ld c, 0x5A
+outer:
+    ld b, 0             ; 256 times round the inner loop
+inner:
+    and e
+    xor a
+    or c
+    inc c
+    dec c
+    cp 0x10
+    ld a, b
+    dec b
+    jr nz, inner
+    jp outer
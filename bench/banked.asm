@@ -0,0 +1,47 @@
+; Banked read benchmark: switches MBC1 ROM banks & reads every byte of each one. Measures the bus,
+; mostly the switchable ROM bank path & the MBC register writes.
+;
+;   emu_out --headless --nosound --nopace --cycles 400000000 bench\banked.gb
+
+    .title "BENCH BANKED"
+    .type 0x01          ; ROM_MBC1
+
+BANKS = 8
+
+    .org 0x150
+start:
+    di
+    ld sp, 0xFFFE
+loop:
+    ld c, 1
+select:
+    xor a
+    or c
+    ld (0x2000), a      ; Select bank C
+    call readBank
+    inc c
+    xor a
+    or c
+    cp BANKS
+    jr nz, select
+    jp loop
+
+; Read all 16KB of the bank mapped at 0x4000, 64 bytes per time round the loop
+readBank:
+    ld hl, 0x4000
+    ld b, 0             ; 256 * 64 bytes
+.read:
+    .rept 64
+    ldi a, (hl)
+    .endr
+    dec b
+    jr nz, .read
+    ret
+
+; Every bank is filled with its own number
+BANK = 1
+    .rept BANKS - 1
+    .bank BANK
+    .ds 0x4000, BANK
+BANK = BANK + 1
+    .endr
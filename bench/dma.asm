@@ -0,0 +1,26 @@
+; DMA benchmark: starts OAM DMA transfers back to back. Measures the DMA copy & the IO register path.
+;
+;   emu_out --headless --nosound --nopace --cycles 40000000 bench\dma.gb
+
+    .title "BENCH DMA"
+
+    .org 0x150
+start:
+    di
+    ld sp, 0xFFFE
+
+    ; Something to copy: 160 bytes of sprite data at 0xC000
+    ld hl, 0xC09F
+    ld b, 160
+fill:
+    ld a, b
+    ldd (hl), a
+    dec b
+    jr nz, fill
+
+loop:
+    ld a, 0xC0
+    .rept 16
+    ldh (0x46), a
+    .endr
+    jp loop
@@ -0,0 +1,134 @@
+/*
+    NAME: TMC
+    INIT DATE: 19/10/2026
+    LAST EDIT DATE: 19/10/2026
+    DESC:
+        The APU (sound). Two pulse channels, the wave channel, the noise channel and the frame sequencer.
+
+        The APU is never ticked per cycle. Instead it is 'caught up' to the CPU's ticks whenever a sound
+        register is touched (and at the end of every frame), and each channel works out when its output
+        next changes. Every change is added to the output as a band-limited step, so the sample rate
+        never has to match the Game Boy's clock.
+
+        Finished stereo samples go into 'audioRing', read by the SDL audio callback, and can also be
+        dumped to a .wav file.
+*/
+
+#pragma once
+
+#include "ringbuffer.h"
+
+#define APU_CLOCK_RATE 4194304 // Ticks per second
+#define AUDIO_SAMPLE_RATE 48000
+#define AUDIO_RING_SIZE 8192 // Stereo samples, ~170ms at 48kHz
+
+// Band-limited step synthesis
+#define BLIP_PHASE_BITS 5 // Each output sample is split into 32 sub-sample positions
+#define BLIP_PHASES (1 << BLIP_PHASE_BITS)
+#define BLIP_TAPS 16      // Width of the band-limited step, in samples
+#define BLIP_UNIT_BITS 12 // Each phase of the kernel sums to 1 << BLIP_UNIT_BITS
+#define BLIP_BASS_SHIFT 9 // How quickly the DC offset is removed from the output
+#define BLIP_SIZE 4096    // Samples that can be waiting before they have to be read out
+
+struct square
+{
+    unsigned char enabled;
+    unsigned char dacEnabled;
+    unsigned char duty;
+    unsigned char dutyStep;
+    unsigned short frequency;
+    unsigned int timer; // Ticks until the next duty step
+    unsigned short length;
+    unsigned char lengthEnable;
+
+    unsigned char volume;
+    unsigned char envelopeVolume; // Initial volume, from NRx2
+    unsigned char envelopeAdd;
+    unsigned char envelopePeriod;
+    unsigned char envelopeTimer;
+
+    // Sweep, only used by channel 1
+    unsigned char sweepPeriod;
+    unsigned char sweepNegate;
+    unsigned char sweepShift;
+    unsigned char sweepTimer;
+    unsigned char sweepEnabled;
+    unsigned short shadowFrequency;
+};
+
+struct wave
+{
+    unsigned char enabled;
+    unsigned char dacEnabled;
+    unsigned short frequency;
+    unsigned int timer;
+    unsigned char position; // Which of the 32 4-bit samples is playing
+    unsigned short length;
+    unsigned char lengthEnable;
+    unsigned char volumeShift; // 4 = muted
+};
+
+struct noise
+{
+    unsigned char enabled;
+    unsigned char dacEnabled;
+    unsigned short lfsr;
+    unsigned char widthMode; // 7-bit LFSR when set
+    unsigned char divisorCode;
+    unsigned char clockShift;
+    unsigned int timer;
+    unsigned short length;
+    unsigned char lengthEnable;
+
+    unsigned char volume;
+    unsigned char envelopeVolume;
+    unsigned char envelopeAdd;
+    unsigned char envelopePeriod;
+    unsigned char envelopeTimer;
+};
+
+struct apu
+{
+    unsigned char enabled; // NR52 bit 7
+    struct square square[2];
+    struct wave wave;
+    struct noise noise;
+
+    unsigned int sequencerTimer; // Ticks until the next 512Hz frame sequencer step
+    unsigned char sequencerStep;
+
+    unsigned long lastTicks;    // CPU ticks the APU has been caught up to
+    unsigned char amplitude[4]; // Current DAC input of each channel, 0-15
+    int outLeft;                // Current mixed level already handed to the synthesiser
+    int outRight;
+
+    unsigned char mute; // Keep emulating but throw the samples away (used by run-ahead, turbo etc)
+} extern apu;
+
+// Samples that have been synthesized but not read out yet. Part of save states, so rewinding the
+// machine (run-ahead) rewinds its audio too.
+struct blip
+{
+    int buffer[2][BLIP_SIZE + BLIP_TAPS]; // Left & right deltas
+    int integrator[2];
+    unsigned long long offset; // Sample position (32.32 fixed point) of 'ticks'
+    unsigned long ticks;
+    unsigned long long factor; // Samples per tick (32.32 fixed point)
+} extern blip;
+
+extern struct ringbuffer audioRing;
+extern unsigned long audioDroppedSamples;
+
+void apuReset(void);
+void apuCatchUp(void);
+void apuEndFrame(void);
+unsigned char apuRead(unsigned short address);
+unsigned char apuPeek(unsigned short address);
+void apuWrite(unsigned short address, unsigned char value);
+
+void apuSetRate(double ratio);
+
+int openAudio(void);
+int audioIsOpen(void);
+int startWav(const char *fileName);
+void closeAPU(void);
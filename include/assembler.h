@@ -0,0 +1,41 @@
+/*
+    NAME: TMC
+    INIT DATE: 19/10/2026
+    LAST EDIT DATE: 19/10/2026
+    DESC:
+        A small SM83 assembler, for building ROMs that test or benchmark one thing at a time (see
+        'bench/' and 'tools/gbasm.c').
+
+        Mnemonics come from the CPU's own instruction list ('include/instructions.inc'), written the way
+        the disassembler prints them: "LD (0xFF00 + 0x44), A", "LDI A, (HL)", "CB 0x37". Spaces and
+        case don't matter, numbers can be written as 0x1F, $1F, %11111, 31 or 'c', and the usual
+        shorthands work too: LDH, LD (HL+)/(HL-), LD (C), JP (HL), ADC A, B...
+
+            ; comment
+            label:              labels are case insensitive and can be used before they are defined
+            NAME = expression   constant
+            .org address        move to an address in the current bank
+            .bank n             start filling ROM bank n (mapped at 0x4000-0x7FFF)
+            .db 1, "text", 'c'  bytes & strings
+            .dw 0x1234, label   little endian words
+            .ds count[, fill]   reserve bytes
+            .rept n ... .endr   repeat a block of lines
+            .title "NAME"       header name (up to 16 characters)
+            .type n             header cartridge type (see enum romType)
+            .ram n              header RAM size code
+
+        Expressions take + - * / % & | ^ << >> ~, brackets, HIGH() & LOW(), and @ for the address of the
+        current line.
+
+        The header gets the Nintendo logo, a sized ROM size byte and both checksums filled in. If nothing
+        is placed at the entry point (0x100), "NOP; JP 0x150" is put there.
+*/
+
+#pragma once
+
+#include <stddef.h>
+
+#define ASSEMBLER_MAX_BANKS 512
+#define ASSEMBLER_MAX_SYMBOLS 4096
+
+int assemble(const char *source, const char *sourceName, unsigned char **rom, size_t *size);
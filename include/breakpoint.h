@@ -0,0 +1,54 @@
+/*
+    NAME: TMC
+    INIT DATE: 19/10/2026
+    LAST EDIT DATE: 19/10/2026
+    DESC:
+        Execution breakpoints and read/write watchpoints, kept as bitmaps with one bit per address so
+        checking an address costs the same no matter how many are set.
+
+        Breakpoints in the switchable ROM bank (0x4000-0x7FFF) are kept per bank, so a breakpoint only
+        fires when its bank is the one mapped in. Every other address has one bit in a flat 64K-bit map.
+
+        A breakpoint can have a condition (see condition.h). It is compiled when the breakpoint is set,
+        and only run when the CPU reaches the breakpoint's address.
+
+        Nothing here is looked at unless 'debugActive' is set, so a normal run only pays for one
+        predictable branch in the CPU core's step and the memory bus.
+*/
+
+#pragma once
+
+#define BREAKPOINT_BANKS 512                 // Most banks any supported MBC can map
+#define BREAKPOINT_BANK_BYTES (0x4000 / 8)   // One bit per address of a 16KB ROM bank
+#define MAX_BREAKPOINT_CONDITIONS 64
+
+#define BITMAP_TEST(map, address) ((map)[(address) >> 3] & (1 << ((address) & 7)))
+#define BITMAP_SET(map, address) ((map)[(address) >> 3] |= (1 << ((address) & 7)))
+#define BITMAP_CLEAR(map, address) ((map)[(address) >> 3] &= ~(1 << ((address) & 7)))
+
+#define WATCH_READ (1 << 0)
+#define WATCH_WRITE (1 << 1)
+
+extern unsigned char debugActive; // Set while anything below (or the debug window) needs checking
+
+// The last watchpoint that stopped the machine, for the debugger to report (0 once reported)
+extern unsigned short watchHitAddress;
+extern unsigned char watchHitType;
+
+extern unsigned char breakpointMap[0x10000 / 8];
+extern unsigned char *bankBreakpointMaps[BREAKPOINT_BANKS]; // NULL until the bank gets a breakpoint
+extern unsigned char readWatchMap[0x10000 / 8];
+extern unsigned char writeWatchMap[0x10000 / 8];
+
+int setBreakpoint(unsigned short bank, unsigned short address);
+int setConditionalBreakpoint(unsigned short bank, unsigned short address, const char *expression);
+void clearBreakpoint(unsigned short bank, unsigned short address);
+int setWatchpoint(unsigned short address, unsigned char type);
+void clearWatchpoint(unsigned short address, unsigned char type);
+void clearAllBreakpoints(void);
+
+int checkBreakpoint(unsigned short address);
+void watchpointHit(unsigned short address, unsigned char type);
+void updateDebugActive(void);
+
+int parseBreakpoint(const char *text, unsigned short *bank, unsigned short *address);
@@ -0,0 +1,68 @@
+/*
+    NAME: TMC
+    INIT DATE: 19/10/2026
+    LAST EDIT DATE: 19/10/2026
+    DESC:
+        Video & audio capture (--capture <file>, --captureaudio <file>). Every finished frame, and
+        the audio made during it, is copied into a buffer from a fixed pool and handed to a writer
+        thread, which does the encoding and the writing. Nothing is allocated per frame.
+
+        Video is written as Y4M (160x144 or the --scaler size, 4:2:0, ~59.73fps), audio as raw
+        16-bit stereo PCM at AUDIO_SAMPLE_RATE. Either can go to a file, a FIFO / named pipe, or
+        stdout ("-", the emulator's own output is moved to stderr). For example:
+
+            emu_out --headless --capture - game.gb | ffmpeg -i - game.mp4
+
+        The core never waits on a slow consumer for long. With a full pool, --capturemode picks what
+        happens:
+            drop    the frame is dropped and counted (default)
+            wait    wait up to CAPTURE_WAIT_MS for a buffer, then drop
+        With --nopace the core easily outruns the encoder, so batch recordings want 'wait'.
+*/
+
+#pragma once
+
+#include <stddef.h>
+#include <stdio.h>
+#include <stdatomic.h>
+#include "main.h"
+#include "ringbuffer.h"
+#include "scaler.h"
+
+#define CAPTURE_POOL_FRAMES 8       // Must be a power of 2
+#define CAPTURE_AUDIO_SAMPLES 4096  // Stereo samples per frame buffer, a frame makes ~800
+#define CAPTURE_WAIT_MS 100
+
+enum captureMode
+{
+    CAPTURE_DROP,
+    CAPTURE_WAIT,
+};
+
+struct captureFrame
+{
+    unsigned int pixels[SCREEN_WIDTH * SCREEN_HEIGHT];
+    short audio[CAPTURE_AUDIO_SAMPLES * 2];
+    unsigned int audioSamples;
+};
+
+struct capture
+{
+    unsigned char enabled;
+    enum captureMode mode;
+    FILE *video;
+    FILE *audio;
+
+    struct captureFrame *pool;
+    struct ringbuffer freeFrames; // Indexes into 'pool', writer thread -> core
+    struct ringbuffer fullFrames; // core -> writer thread
+
+    unsigned long frames;  // Handed to the writer
+    unsigned long dropped; // Pool was full
+    atomic_int failed;     // The writer couldn't write, everything since has been thrown away
+} extern capture;
+
+int startCapture(const char *videoName, const char *audioName, enum captureMode mode, enum scalerMode scalerMode);
+void captureAudio(const short *samples, size_t count);
+void captureFrame(const unsigned int *pixels);
+void stopCapture(void);
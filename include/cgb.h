@@ -0,0 +1,64 @@
+/*
+    NAME: TMC
+    INIT DATE: 19/10/2026
+    LAST EDIT DATE: 19/10/2026
+    DESC:
+        Game Boy Color mode. Used when the ROM's header says it supports the CGB (0x143 bit 7), unless
+        --dmg is given. On top of the DMG the CGB has:
+
+            VBK   0xFF4F    2 banks of VRAM. Bank 1 holds more tile data and, under the tile maps,
+                            an attribute byte for every map cell (palette, bank, flips, priority).
+            SVBK  0xFF70    8 banks of WRAM, bank 0 always at 0xC000 and 1 - 7 switched in at 0xD000.
+            BCPS/BCPD       8 background and 8 sprite palettes of 4 RGB555 colours each, written a byte
+            OCPS/OCPD       at a time through an index register that can count up by itself.
+            0xFF68 - 0xFF6B
+            KEY1  0xFF4D    Double speed. Arm bit 0, then STOP switches speeds. The CPU then gets twice
+                            as much done per line, the PPU, APU and serial port run as before.
+            HDMA1 - 5       Copies to VRAM in 16 byte blocks. General purpose DMA does the whole copy
+            0xFF51 - 0xFF55 at once, HBLANK DMA one block at the start of every HBLANK.
+
+        The switchable banks are reached through the 'vramBank' and 'wramBank' pointers (memory.h),
+        so switching is a pointer change and reads/writes cost no more than on a DMG. Both DMA kinds
+        are done as memcpys of whole blocks rather than a byte at a time through the bus.
+*/
+
+#pragma once
+
+#define CGB_PALETTE_AUTOINCREMENT (1 << 7)
+#define CGB_KEY1_ARMED (1 << 0)
+#define CGB_HDMA_HBLANK (1 << 7) // HDMA5 bit 7 on write: HBLANK DMA instead of general purpose
+
+#define CGB_HDMA_BLOCK 16
+#define CGB_HDMA_BLOCK_TICKS 32 // A general purpose block holds the CPU up this long, in either speed
+
+// The registers readCgb/writeCgb look after
+#define CGB_REGISTER(address) ((address) == 0xFF4D || (address) == 0xFF4F || ((address) >= 0xFF51 && (address) <= 0xFF55) || \
+                               ((address) >= 0xFF68 && (address) <= 0xFF6B) || (address) == 0xFF70)
+
+// Tick cost of CPU work. In double speed the CPU gets through the same work in half the (PPU) ticks.
+#define CPU_TICKS(n) ((n) >> cgb.doubleSpeed)
+
+struct cgb
+{
+    unsigned char enabled;     // Running as a CGB
+    unsigned char doubleSpeed; // KEY1 bit 7
+    unsigned char speedArmed;  // KEY1 bit 0
+    unsigned char vbk;         // VRAM bank, 0 - 1
+    unsigned char svbk;        // WRAM bank at 0xD000, 1 - 7
+
+    unsigned char paletteIndex[2]; // BCPS, OCPS
+    unsigned char paletteRam[2][64]; // Background then sprite palettes, RGB555 little endian
+
+    unsigned short hdmaSource;
+    unsigned short hdmaDestination; // Offset into VRAM
+    unsigned char hdmaBlocks;       // Blocks left of the HBLANK DMA in progress
+    unsigned char hdmaActive;
+} extern cgb;
+
+void selectModel(unsigned char dmg);
+void cgbReset(void);
+void mapCgbBanks(void);
+unsigned char readCgb(unsigned short address);
+void writeCgb(unsigned short address, unsigned char value);
+int cgbSpeedSwitch(void);
+void cgbHblank(void);
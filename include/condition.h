@@ -0,0 +1,33 @@
+/*
+    NAME: TMC
+    INIT DATE: 19/10/2026
+    LAST EDIT DATE: 19/10/2026
+    DESC:
+        Breakpoint conditions, e.g. "A == 0x3F && [HL] > 4 && LY == 144".
+
+        A condition is compiled once (when the breakpoint is set) into a small stack bytecode, and that
+        bytecode is only run when the CPU lands on the breakpoint's address, so a condition on a loop that
+        runs millions of times never re-parses the string.
+
+        Syntax is C-like:
+            Numbers     10, 0x3F, $3F
+            Registers   A F B C D E H L AF BC DE HL SP PC
+            Machine     LY LCDC SCX SCY MODE STAT LYC WX WY (GPU), TICKS, BANK (ROM bank)
+            Memory      [expression] reads a byte through peekByte (no watchpoints or other side effects)
+            Operators   ! ~ - (unary), * / %, + -, << >>, < <= > >=, == !=, &, ^, |, &&, ||, ( )
+        Names are case insensitive.
+*/
+
+#pragma once
+
+#define CONDITION_MAX_CODE 256 // Bytes of bytecode per condition
+#define CONDITION_STACK 16     // Deepest the VM stack can get
+
+struct condition
+{
+    unsigned char code[CONDITION_MAX_CODE];
+    unsigned short length;
+};
+
+int compileCondition(const char *text, struct condition *condition);
+unsigned int runCondition(const struct condition *condition);
@@ -32,52 +32,38 @@ struct instruction
 {
     char *disassembly;
     unsigned char operandLength;
-    void *execute;
 } extern const instructions[256];
 
+#define CPU_MCYCLE_TICKS 2 // One M-cycle in 'instructionTicks' (what a NOP takes)
+
+/*
+    A CPU core, one per accuracy tier (see the bottom of cpu.c). The frame loop only ever calls
+    'cpu->step()' to run an instruction. Both are compiled from 'include/cpucore.inc', and differ only
+    in how the bus and time are handled, fixed when they are compiled:
+        fast    the instruction's time is added after it has run
+        cycle   each memory access is an M-cycle later than the one before, and the PPU is caught up
+                before it happens
+*/
+struct cpuCore
+{
+    const char *name;
+    void (*step)(void);
+};
+
+extern const struct cpuCore *cpu;
+extern const struct cpuCore fastCore;
+extern const struct cpuCore cycleCore;
+extern const struct cpuCore flatCore; // Only for --cputest, see cputest.h
+
 extern const unsigned char instructionTicks[256];
 
 extern unsigned long ticks;
 extern unsigned char stopped;
 
 void reset(void);
-void stepCPU(void);
+int selectCpuCore(const char *name);
 
 void undefined(void); // The function that runs if an opcode isn't defined!
-
-void nop(void);
-void jp_nn(unsigned short operand);
-void xor_a(void);
-void ld_hl_nn(unsigned short value);
-void rst_18(void);
-void ld_c_n(unsigned char value);
-void ld_b_n(unsigned char value);
-void ldd_hlp_a(void);
-void dec_b(void);
-void jr_nz_n(unsigned char value);
-void dec_c(void);
-void di(void);
-void ld_b_a(void);
-void ld_de_nn(unsigned short value);
-void ldi_a_hlp(void);
-void ld_bc_nn(unsigned short value);
-void ld_bcp_a(void);
-void ld_a_n(unsigned char value);
-void ld_ff_n_ap(unsigned char value);
-void ld_ff_ap_n(unsigned char value);
-void cp_n(unsigned char value);
-void ld_hlp_n(unsigned char value);
-void ld_nnp_a(unsigned short value);
-void ld_sp_nn(unsigned short value);
-void ld_ff_c_a(void);
-void inc_c(void);
-void call_nn(unsigned short value);
-void dec_bc(void);
-void ld_a_b(void);
-void or_c(void);
-void ret(void);
-void and_e(void);
-void rst_38(void);
 static unsigned char dec(unsigned char value);
 static unsigned char inc(unsigned char value);
 static void and(unsigned char value);
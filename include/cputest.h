@@ -0,0 +1,57 @@
+/*
+    NAME: TMC
+    INIT DATE: 19/10/2026
+    LAST EDIT DATE: 19/10/2026
+    DESC:
+        Single step CPU tests (--cputest <file.json>). Runs the per-opcode test vectors from the
+        SingleStepTests sm83 set, each a JSON array of:
+
+            {"name": "...",
+             "initial": {"pc": .., "sp": .., "a": .. "l": .., "ime": .., "ie": .., "ram": [[address, value], ...]},
+             "final":   { same },
+             "cycles":  [[address, value, "r-m" | "-wm" | "---"], ...]}     (an entry can also be null)
+
+        Each vector is one instruction, run on the 'flat' CPU core (cpu.c). That core is built from the
+        same 'include/cpucore.inc' as the others, but its bus is 'flatBus': 64KB of plain RAM, with
+        every read & write logged. A vector passes if the registers, IME, the listed RAM, the reads &
+        writes (in order) and the number of M-cycles all match.
+
+        The file is read in one go and parsed one vector at a time as it is run, by a parser that only
+        knows this layout (no tree is built and nothing is allocated per vector). 'tools/testrunner.c'
+        runs a whole directory of these files at once, one emulator process per file.
+
+        With --test <result file> the result is written in the test ROM format (see testrom.h), with
+        the failures listed under "details:".
+
+        --coretest runs a few instructions on both the fast & cycle cores (from WRAM, through the real
+        bus) and checks they take the same number of ticks, including conditional jumps taken & not.
+        It reports the same way.
+*/
+
+#pragma once
+
+#define CPU_TEST_MAX_RAM 32      // RAM entries in a vector's state
+#define CPU_TEST_MAX_ACCESSES 16 // Bus accesses one instruction can make
+#define CPU_TEST_MAX_REPORTS 8   // Failures described in full, per file
+
+struct busAccess
+{
+    unsigned short address;
+    unsigned char value;
+    unsigned char write;
+};
+
+struct flatBus
+{
+    unsigned char memory[0x10000];
+    struct busAccess log[CPU_TEST_MAX_ACCESSES];
+    unsigned int logLength;
+    unsigned char undefined; // The instruction isn't implemented
+} extern flatBus;
+
+unsigned char flatRead(unsigned short address);
+void flatWrite(unsigned short address, unsigned char value);
+void flatUndefined(void);
+
+int runCpuTests(const char *fileName, const char *resultName);
+int runCoreTimingTests(const char *resultName);
@@ -1,3 +1,12 @@
 #pragma once
 
-void drawFramebuffer(void);
\ No newline at end of file
+#include "main.h"
+
+// Frame currently being drawn by the GPU, one 32-bit ARGB value per pixel. This is the back buffer of
+// a triple buffer, so it changes every time a frame is published.
+extern unsigned int *framebuffer;
+
+int initDisplay(const char *title);
+void publishFrame(void);
+int presentFrame(void);
+void closeDisplay(void);
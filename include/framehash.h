@@ -0,0 +1,58 @@
+/*
+    NAME: TMC
+    INIT DATE: 19/10/2026
+    LAST EDIT DATE: 19/10/2026
+    DESC:
+        Frame hashing & dumps, for checking the picture without a window. Every finished frame (at
+        VBLANK) is hashed with XXH64, about 10us a frame, so it can be left on for a whole soak run.
+
+            --hashlog <file>    write "<frame> <hash>" for every frame
+            --golden <file>     compare against a hash log from a known good run, stop at the first
+                                frame that differs and dump it as golden_<frame>.png. The emulator
+                                exits with 1 if a frame differs or it stops before the log's last.
+            --dump <frames>     save frames as frame_<frame>.png, e.g. "60,120,300-310"
+            --dumpraw           save dumps as .raw instead (160x144 32-bit ARGB, host byte order)
+
+        Frames are counted from 0 and every emulated frame is rendered while any of these are on.
+*/
+
+#pragma once
+
+#include <stddef.h>
+#include <stdio.h>
+#include "xxhash.h"
+
+#define FRAME_DUMP_RANGES 64
+
+struct frameRange
+{
+    unsigned long first;
+    unsigned long last;
+};
+
+struct frameHash
+{
+    unsigned char enabled;
+    unsigned long frame;            // Number of the frame being finished
+    unsigned long long hash;        // Hash of the last finished frame
+    FILE *log;
+
+    unsigned long long *golden;     // Expected hash of frame n, for 'goldenCount' frames
+    unsigned char *goldenKnown;     // Frame n has an expected hash
+    unsigned long goldenCount;      // Highest frame with an expected hash + 1
+    unsigned long goldenEntries;    // Frames with an expected hash
+    unsigned long goldenMatched;    // Of those, frames run so far that matched
+    long mismatch;                  // First frame that didn't match, -1 if none
+
+    struct frameRange dumps[FRAME_DUMP_RANGES];
+    unsigned int dumpCount;
+    unsigned char dumpRaw;
+} extern frameHash;
+
+int writePNG(const char *fileName, const unsigned int *pixels, int width, int height);
+
+int startHashLog(const char *fileName);
+int loadGolden(const char *fileName);
+int setFrameDumps(const char *list);
+void frameHashEndFrame(const unsigned int *pixels);
+int stopFrameHash(void);
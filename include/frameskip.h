@@ -0,0 +1,29 @@
+/*
+    NAME: TMC
+    INIT DATE: 19/10/2026
+    LAST EDIT DATE: 19/10/2026
+    DESC:
+        Frame skipping & turbo (fast-forward) mode. The CPU, timers and interrupts always run at full
+        speed, only the pixel pipeline (renderScanline) is skipped on frames nobody will see.
+*/
+
+#pragma once
+
+enum frameskipMode
+{
+    FRAMESKIP_OFF = 0,   // Render & present every frame
+    FRAMESKIP_FIXED = 1, // Render 1 frame in every 'interval' frames
+    FRAMESKIP_TURBO = 2, // Run as fast as possible, only render when the host is due a new frame (60Hz)
+};
+
+struct frameskip
+{
+    enum frameskipMode mode;
+    unsigned int interval;        // Only used by FRAMESKIP_FIXED
+    unsigned int counter;         // Frames emulated since the last rendered one
+    unsigned char renderFrame;    // Does the frame currently being emulated run the pixel pipeline?
+    unsigned long long lastFrame; // Host time (performance counter) the last frame was rendered at
+} extern frameskip;
+
+void setFrameskip(enum frameskipMode mode, unsigned int interval);
+void frameskipEndFrame(void);
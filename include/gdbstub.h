@@ -0,0 +1,28 @@
+/*
+    NAME: TMC
+    INIT DATE: 19/10/2026
+    LAST EDIT DATE: 19/10/2026
+    DESC:
+        GDB remote serial protocol stub (--gdb <port>). Listens on 127.0.0.1 and replaces the debug
+        message box: while a debugger is attached, stopping (a breakpoint, watchpoint, single step or
+        Ctrl-C) waits for the debugger instead of popping up a window for every instruction.
+
+        GDB has no Game Boy target, so registers are sent in the layout of its z80 target (the closest
+        one it knows): AF BC DE HL SP PC, then IX IY AF' BC' DE' HL' IR which are always 0.
+        Connect with e.g. 'gdb-multiarch -ex "set architecture z80" -ex "target remote :2345"'.
+
+        Breakpoints & watchpoints (Z0-Z4) go into the same bitmaps as --break & --watch. Addresses above
+        0xFFFF pick the ROM bank for a breakpoint in 0x4000-0x7FFF (bank << 16 | address), otherwise the
+        bank mapped in when it is set is used.
+*/
+
+#pragma once
+
+#define GDB_PACKET_SIZE 4096
+
+extern unsigned char gdbEnabled;
+
+int startGdbStub(unsigned short port);
+void gdbPoll(void);
+void gdbStop(void);
+void closeGdbStub(void);
@@ -1,13 +1,71 @@
 #pragma once
 
+// LCD control (0xFF40) bits. Names taken from Cinoop.
+#define GPU_CONTROL_BGENABLE (1 << 0)
+#define GPU_CONTROL_SPRITEENABLE (1 << 1)
+#define GPU_CONTROL_SPRITEVDOUBLE (1 << 2)
+#define GPU_CONTROL_TILEMAP (1 << 3)
+#define GPU_CONTROL_TILESET (1 << 4)
+#define GPU_CONTROL_WINDOWENABLE (1 << 5)
+#define GPU_CONTROL_WINDOWTILEMAP (1 << 6)
+#define GPU_CONTROL_DISPLAYENABLE (1 << 7)
+
+// LCD status (0xFF41) bits. 0 & 1 are the mode, 3 - 6 pick which events raise the LCDSTAT interrupt.
+#define GPU_STATUS_COINCIDENCE (1 << 2) // LY == LYC, read only
+#define GPU_STATUS_HBLANKINT (1 << 3)
+#define GPU_STATUS_VBLANKINT (1 << 4)
+#define GPU_STATUS_OAMINT (1 << 5)
+#define GPU_STATUS_COINCIDENCEINT (1 << 6)
+#define GPU_STATUS_WRITABLE 0x78
+
+#define TILE_COUNT 768 // 384 in each VRAM bank, bank 1's from 384 on
+
+// CGB attributes, of a background map cell (VRAM bank 1) or a sprite (OAM byte 3)
+#define GPU_ATTRIBUTE_PALETTE 0x07 // CGB palette number
+#define GPU_ATTRIBUTE_BANK (1 << 3)
+#define GPU_ATTRIBUTE_XFLIP (1 << 5)
+#define GPU_ATTRIBUTE_YFLIP (1 << 6)
+#define GPU_ATTRIBUTE_PRIORITY (1 << 7) // Background: over sprites. Sprite: behind background colours 1 - 3.
+
+enum gpuMode
+{
+	GPU_MODE_HBLANK = 0,
+	GPU_MODE_VBLANK = 1,
+	GPU_MODE_OAM = 2,
+	GPU_MODE_VRAM = 3,
+};
+
 struct gpu {
 	unsigned char control;
+	unsigned char status; // Only the interrupt enable bits, the rest is worked out when STAT is read
 	unsigned char scrollX;
 	unsigned char scrollY;
 	unsigned char scanline;
+	unsigned char lyCompare;
+	unsigned char windowX; // WX, the window's left edge is at WX - 7
+	unsigned char windowY;
+	unsigned char windowLine; // Which line of the window is next, only counts lines the window was on
+	unsigned char backgroundPalette; // BGP
+	unsigned char spritePalette[2]; // OBP0, OBP1
 	unsigned long tick;
+	unsigned char frameComplete; // Set when the GPU enters VBLANK, cleared by whoever consumes the frame
+	enum gpuMode mode;
+	unsigned long lastTicks; // CPU ticks the last time stepGPU ran
 } extern gpu;
 
+extern unsigned char tiles[TILE_COUNT][8][8];       // Colour number of every pixel of every tile
+extern unsigned char packedTiles[TILE_COUNT][8][2]; // The same, 4 pixels to a byte (leftmost in bits 7-6)
+extern unsigned int tileStamps[TILE_COUNT][8];      // Changes whenever a tile row does, for the background cache
+
 void
 stepGPU(void);
-void hblank(void);
\ No newline at end of file
+void hblank(void);
+void setGpuMode(enum gpuMode mode);
+void endScanline(void);
+void endVblankLine(void);
+unsigned char readStatus(void);
+void writeStatus(unsigned char value);
+void writeLyCompare(unsigned char value);
+void renderScanline(void);
+void updateTile(unsigned short offset);
+void invalidateBackground(void);
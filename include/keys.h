@@ -2,22 +2,22 @@
 
 struct keys1
 {
-    unsigned char start : 1; // adding a tailing ': 1' defines this as only contaning a single bit
-    unsigned char select : 1;
+    unsigned char a : 1; // adding a tailing ': 1' defines this as only contaning a single bit
     unsigned char b : 1;
-    unsigned char a : 1;
+    unsigned char select : 1;
+    unsigned char start : 1;
 
-    // Because I am defining individual bits here, I have to consider if it is big or little endian.
-    // By default windows is big endian (most significant bits on the left), so it has this order.
+    // Because I am defining individual bits here, I have to consider which order the compiler packs them in.
+    // GCC fills bitfields from the least significant bit up, so 'a' is bit 0, matching P1 (0xFF00).
 };
 
 // Same deal below as above, but this is the array for if reading dpad
 struct keys2
 {
-    unsigned char down : 1;
-    unsigned char up : 1;
-    unsigned char left : 1;
     unsigned char right : 1;
+    unsigned char left : 1;
+    unsigned char up : 1;
+    unsigned char down : 1;
 };
 
 // This was taken from Cinoop directly, but it just makes so much sense ;-;
@@ -26,6 +26,7 @@ struct keys2
     keys.key1 - first 4 bits of keys byte
     keys.key2 - second 4 bits of keys byte
 
+    Like the real register, a bit is 0 when the key is held down.
 */
 struct keys {
 	union {
@@ -43,4 +44,12 @@ struct keys {
 		
 		unsigned char c;
 	};
-} extern keys;
\ No newline at end of file
+} extern keys;
+
+// What P1 (0xFF00) reads as for each combination of its two select bits (bits 4 & 5)
+extern unsigned char joypadTable[4];
+
+void updateJoypad(void);
+void keyEvent(int scancode, unsigned char pressed);
+unsigned char readJoypad(void);
+void writeJoypad(unsigned char value);
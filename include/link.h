@@ -0,0 +1,48 @@
+/*
+    NAME: TMC
+    INIT DATE: 19/10/2026
+    LAST EDIT DATE: 19/10/2026
+    DESC:
+        A link cable between two Game Boys in the same process (--link <rom>). The first machine is
+        the one shown, heard and controlled. The second runs the other ROM with no input, video or sound.
+
+        All machine state is global, so only one machine can be live at a time and both run on the
+        emulation thread. The second machine is kept in a save state and swapped in (loadState) to
+        catch up to the first, then swapped back out. They are kept in lock-step this way, a quantum at
+        a time. A quantum ends no later than the earliest moment a transfer could finish:
+
+            - a transfer already in progress on either side finishes at its 'endTicks',
+            - one started during a quantum can't finish for SERIAL_TRANSFER_TICKS.
+
+        So a quantum is never longer than SERIAL_TRANSFER_TICKS (about 17 swaps a frame), and ends
+        exactly on the tick a transfer finishes. Both bytes are swapped there and the serial interrupt
+        raised on the side that clocked it, and on the other if it was waiting with SC = 0x80. Neither
+        machine can see the other in between, so this is exact while costing far less than stepping
+        both an instruction at a time.
+*/
+
+#pragma once
+
+#include "rom.h"
+#include "state.h"
+
+struct linkCable
+{
+    unsigned char connected;
+    unsigned char otherRunning; // The second machine is the live one
+
+    struct savestate self;  // The first machine while the second one runs
+    struct savestate other; // The second machine the rest of the time
+
+    // The second machine's cartridge, swapped in with its state
+    unsigned char *cart;
+    enum romType cartType;
+    unsigned short romBankCount;
+
+    unsigned long syncTicks;   // First machine ticks at which the quantum ends
+    unsigned long lastTicks;   // First machine ticks at the end of the last quantum
+    unsigned long otherTarget; // Second machine ticks it has been run up to (plus any overrun)
+} extern linkCable;
+
+int startLink(char *fileName, unsigned char dmg);
+void linkSync(void);
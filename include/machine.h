@@ -0,0 +1,34 @@
+/*
+    NAME: TMC
+    INIT DATE: 19/10/2026
+    LAST EDIT DATE: 19/10/2026
+    DESC:
+        Runs the emulated machine a frame at a time. With a window, this runs on its own thread and
+        only talks to the presentation (main) thread through the frame triple buffer (display.c) and
+        the input queue below.
+*/
+
+#pragma once
+
+#include <stdatomic.h>
+#include "ringbuffer.h"
+
+#define INPUT_QUEUE_SIZE 64
+
+// Sent from the presentation thread to the emulation thread
+struct inputEvent
+{
+    unsigned char pressed; // 1 = key down, 0 = key up
+    int scancode;          // SDL scancode, mapped to the joypad by keys.c
+};
+
+extern atomic_int emulationRunning;
+extern struct ringbuffer inputQueue;
+extern unsigned long frameLimit;
+extern unsigned long long cycleLimit; // Stop after this many ticks (0 = run forever)
+extern unsigned long long elapsedTicks;
+extern unsigned int runAhead;
+
+void runFrame(void);
+void endFrame(void);
+int emulationThread(void *data);
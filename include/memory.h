@@ -13,15 +13,20 @@
 extern const unsigned char ioReset[0x100];
 
 extern unsigned char *cart;
+extern unsigned short romBank; // ROM bank mapped at 0x4000-0x7FFF
 extern unsigned char sram[0x2000];
 extern unsigned char io[0x100];
-extern unsigned char vram[0x2000];
+extern unsigned char vram[0x4000]; // Both CGB banks, bank 0 first. A DMG only uses bank 0.
 extern unsigned char oam[0x100];
-extern unsigned char wram[0x2000];
+extern unsigned char wram[0x8000]; // All 8 CGB banks. A DMG only uses 0 & 1.
+extern unsigned char *vramBank; // The VRAM bank mapped at 0x8000 (see cgb.h)
+extern unsigned char *wramBank; // The WRAM bank mapped at 0xD000
 extern unsigned char hram[0x80];
 
 unsigned char readByte(unsigned short address);
+unsigned char peekByte(unsigned short address); // readByte without side effects, for debuggers
 void writeByte(unsigned short address, unsigned char value);
+void pokeByte(unsigned short address, unsigned char value); // writeByte without side effects, for debuggers
 
 unsigned short readShort(unsigned short address);
 void writeShortToStack(unsigned short value);
@@ -0,0 +1,77 @@
+/*
+    NAME: TMC
+    INIT DATE: 19/10/2026
+    LAST EDIT DATE: 19/10/2026
+    DESC:
+        Memory access statistics, only built with -DGBM_MEMSTATS (see the second line of compile.txt).
+        Every CPU read & write (and OAM DMA, which goes through the same bus) is counted per region and
+        per 256 byte page. Addresses readByte/writeByte have nothing mapped at are counted too, instead of
+        printed.
+
+        Only the real machine's accesses are counted. Nothing is counted while MEMSTATS_SUSPEND is in
+        effect: the frames run-ahead runs & then rewinds, and the linked machine's turns (link.c). Reads
+        by the trace & debuggers go through peekByte, which isn't counted either.
+
+        On exit, and when M is pressed, this is written out as:
+
+            <MEMSTATS_FILE>.csv     reads & writes per region, per page, and per invalid address
+            <MEMSTATS_FILE>.png     a heatmap of the pages, reads on the left, writes on the right. Each
+                                    is 16 x 16 pages, 0x0000 top left, a row per 0x1000. The colour
+                                    goes black - blue - red - yellow - white on a log scale, and pages
+                                    never touched are grey.
+
+        Presses of M write _1, _2, ... after the name, so a run can be looked at in parts.
+
+        Without GBM_MEMSTATS the MEMSTATS_* macros below are empty, so memory.c is exactly what it was,
+        and the invalid address messages are printed as before.
+*/
+
+#pragma once
+
+#define MEMSTATS_FILE "memstats"
+
+enum memRegion
+{
+    REGION_ROM0,     // 0x0000 - 0x3FFF
+    REGION_ROMX,     // 0x4000 - 0x7FFF, banked
+    REGION_VRAM,     // 0x8000 - 0x9FFF
+    REGION_SRAM,     // 0xA000 - 0xBFFF
+    REGION_WRAM,     // 0xC000 - 0xDFFF
+    REGION_ECHO,     // 0xE000 - 0xFDFF
+    REGION_OAM,      // 0xFE00 - 0xFE9F
+    REGION_UNUSABLE, // 0xFEA0 - 0xFEFF
+    REGION_IO,       // 0xFF00 - 0xFF7F
+    REGION_HRAM,     // 0xFF80 - 0xFFFE
+    REGION_IE,       // 0xFFFF
+    REGION_COUNT,
+};
+
+#ifdef GBM_MEMSTATS
+
+#define MEMSTATS_READ(address) memStatsAccess(address, 0)
+#define MEMSTATS_WRITE(address) memStatsAccess(address, 1)
+#define MEMSTATS_INVALID(address, write) memStatsInvalid(address, write) // 1 = counted, don't print
+#define MEMSTATS_DUMP() dumpMemStats()
+#define MEMSTATS_FINISH() finishMemStats()
+#define MEMSTATS_SUSPEND() (memStatsSuspended++)
+#define MEMSTATS_RESUME() (memStatsSuspended--)
+
+extern unsigned int memStatsSuspended; // Nothing is counted while this is above 0
+
+void memStatsAccess(unsigned short address, int write);
+int memStatsInvalid(unsigned short address, int write);
+void dumpMemStats(void);
+void finishMemStats(void);
+
+#else
+
+// Still statements, so 'if (x) MEMSTATS_DUMP();' doesn't leave an empty body
+#define MEMSTATS_READ(address) do {} while (0)
+#define MEMSTATS_WRITE(address) do {} while (0)
+#define MEMSTATS_INVALID(address, write) 0
+#define MEMSTATS_DUMP() do {} while (0)
+#define MEMSTATS_FINISH() do {} while (0)
+#define MEMSTATS_SUSPEND() do {} while (0)
+#define MEMSTATS_RESUME() do {} while (0)
+
+#endif
@@ -0,0 +1,31 @@
+/*
+    NAME: TMC
+    INIT DATE: 19/10/2026
+    LAST EDIT DATE: 19/10/2026
+    DESC:
+        Keeps emulation running at the real DMG speed: 4194304 ticks a second, 70224 ticks a frame
+        (~59.73 frames a second).
+
+        Without audio, frames are paced against a high resolution clock; most of the wait is a normal
+        sleep and only the last couple of milliseconds are spun on, so very little host CPU is wasted.
+        With audio, the audio device's clock is the master instead. Emulation waits on the fill level of
+        the audio ring, and the APU's output rate is nudged by a fraction of a percent to keep the ring
+        near its target so it never runs dry (crackle) or overflows (dropped samples).
+*/
+
+#pragma once
+
+#define FRAME_TICKS 70224
+#define FRAME_RATE (4194304.0 / FRAME_TICKS)
+
+struct pacing
+{
+    unsigned char enabled;
+    unsigned long long nextFrame;     // Performance counter value the next frame is due at
+    unsigned long long frameDuration; // Performance counter units per frame
+    unsigned long long spinTime;      // The final part of each wait that is spun instead of slept
+    double rate;                      // Last rate ratio given to the APU (1.0 = exact)
+} extern pacing;
+
+void initPacing(unsigned char enabled);
+void paceFrame(void);
@@ -0,0 +1,46 @@
+/*
+    NAME: TMC
+    INIT DATE: 19/10/2026
+    LAST EDIT DATE: 19/10/2026
+    DESC:
+        DMG palettes. A write to BGP, OBP0 or OBP1 (0xFF47 - 0xFF49) runs the register's 4 colour numbers
+        through the current theme straight away, so the renderer only ever looks up finished host pixels.
+
+        The background also gets a 256 entry table from a packed tile byte (4 pixels, 2 bits each, the
+        leftmost in the top bits, see 'packedTiles' in gpu.h) to the 4 host pixels it draws.
+
+        Themes (--palette <name>, P cycles through them) only change what the tables are built from:
+            grey        white -> black
+            green       the DMG's green LCD
+            pocket      the Game Boy Pocket's grey-green LCD
+            custom      --palette RRGGBB,RRGGBB,RRGGBB,RRGGBB (lightest first)
+
+        In CGB mode the colour palettes are used instead (see cgb.h). A write to BCPD/OCPD turns the one
+        colour it changed into a host pixel, and background palettes get a new stamp so the background
+        cache redraws whatever used them. Themes don't apply to those.
+*/
+
+#pragma once
+
+struct paletteTheme
+{
+    const char *name;
+    unsigned int shades[4]; // Host pixels for shades 0 (lightest) to 3
+};
+
+struct palettes
+{
+    unsigned int background[4]; // BGP colour number -> host pixel
+    unsigned int sprite[2][4];  // OBP0/OBP1 colour number -> host pixel (0 is never drawn)
+    unsigned int backgroundRow[256][4];
+    unsigned int cgbBackground[8][4]; // CGB colour palettes -> host pixels
+    unsigned int cgbSprite[8][4];
+    unsigned int cgbBackgroundStamps[8]; // Changes whenever a background colour palette does
+    const struct paletteTheme *theme;
+} extern palettes;
+
+int setPaletteTheme(const char *name);
+void nextPaletteTheme(void);
+void writePalette(unsigned short address, unsigned char value);
+void writeColourPalette(int sprites, int colour);
+void rebuildPalettes(void);
@@ -0,0 +1,64 @@
+/*
+    NAME: TMC
+    INIT DATE: 19/10/2026
+    LAST EDIT DATE: 19/10/2026
+    DESC:
+        PPU engines. The frame loop only ever calls 'ppu->step()', which catches the PPU up to the
+        CPU. Both engines share the GPU state, the mode/interrupt handling and the tile caches in gpu.c.
+
+            fast        mode 3 is always 172 ticks and the whole line is drawn from the background
+                        cache when it ends (gpu.c). Register writes during mode 3 only show on the
+                        next line.
+            accurate    a pixel FIFO stepped one dot at a time (ppufifo.c). Registers are read when
+                        the hardware reads them, so mid-line SCX/BGP/LCDC changes show up where they
+                        happen, and mode 3 gets longer for fine scrolling, sprites and the window.
+                        5 - 10x slower than 'fast'.
+            auto        'fast', until a PPU register is written during mode 3. The frames after that
+                        run on 'accurate', until PPU_AUTO_HOLD_FRAMES go by without one.
+
+        --ppu <engine> picks one at startup. Otherwise the ROM's title is looked up in PPU_LIST_FILE,
+        lines of "<title> = <engine>" ('#' starts a comment), and 'auto' is used if it isn't there.
+        Engines only change at the start of VBLANK, never part way through a line.
+*/
+
+#pragma once
+
+#define PPU_AUTO_HOLD_FRAMES 60
+#define PPU_LIST_FILE "ppu.txt"
+
+enum ppuSelection
+{
+    PPU_FAST,
+    PPU_ACCURATE,
+    PPU_AUTO,
+};
+
+struct ppuEngine
+{
+    const char *name;
+    void (*step)(void);
+};
+
+/*
+    Auto mode's bookkeeping. It is part of the save state, along with 'ppu', so a frame that run-ahead
+    rewinds can't leave the engine switched, and the linked machine's writes aren't counted for the
+    first one.
+*/
+struct ppuAuto
+{
+    unsigned long midLineWrites; // This frame
+    unsigned int cleanFrames;    // In a row, on 'accurate' in auto mode
+} extern ppuAuto;
+
+extern const struct ppuEngine *ppu;
+extern const struct ppuEngine fastEngine;
+extern const struct ppuEngine accurateEngine;
+
+int parsePpuSelection(const char *name, enum ppuSelection *selection);
+void selectPpu(enum ppuSelection selection);
+void selectPpuForRom(const char *title);
+void ppuMidLineWrite(void);
+void ppuEndFrame(void);
+
+// ppufifo.c
+void stepAccurateGPU(void);
@@ -0,0 +1,36 @@
+/*
+    NAME: TMC
+    INIT DATE: 19/10/2026
+    LAST EDIT DATE: 19/10/2026
+    DESC:
+        Lock-free single-producer / single-consumer ring buffer of fixed size elements.
+        Exactly one thread may write and exactly one (other) thread may read. Neither side ever blocks,
+        a full ring just accepts fewer elements and an empty ring just returns fewer.
+*/
+
+#pragma once
+
+#include <stddef.h>
+#include <stdatomic.h>
+
+struct ringbuffer
+{
+    unsigned char *data;
+    size_t elementSize;
+    size_t capacity; // In elements, always a power of two so indexes can be masked
+
+    // Head & tail only ever count up, they are masked when indexing. Kept on separate cache lines so
+    // the producer & consumer threads don't fight over the same line.
+    _Atomic size_t head; // Only written by the producer
+    char padding[64];
+    _Atomic size_t tail; // Only written by the consumer
+};
+
+int ringbufferInit(struct ringbuffer *ring, size_t elementSize, size_t capacity);
+void ringbufferFree(struct ringbuffer *ring);
+void ringbufferClear(struct ringbuffer *ring);
+
+size_t ringbufferWrite(struct ringbuffer *ring, const void *elements, size_t count);
+size_t ringbufferRead(struct ringbuffer *ring, void *elements, size_t count);
+size_t ringbufferCount(struct ringbuffer *ring);
+size_t ringbufferSpace(struct ringbuffer *ring);
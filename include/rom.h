@@ -9,10 +9,20 @@
 #pragma once
 
 //Offests into memory that define certain parts of the game.
+#define ROM_OFFSET_ENTRY 0x100  //Where the boot ROM jumps to, room for 4 bytes (normally NOP; JP 0x150).
+#define ROM_OFFSET_LOGO 0x104   //The Nintendo logo, which the boot ROM checks before starting the game.
 #define ROM_OFFSET_NAME 0x134   //What the ROM says is its name.
+#define ROM_OFFSET_CGB 0x143    //CGB support, the last byte of the name on older ROMs.
 #define ROM_OFFSET_TYPE 0x147   //What type of ROM it is. Preset, see lower enum.
 #define ROM_OFFSET_ROM_SIZE 0x148   //What size is the ROM.
 #define ROM_OFFSET_RAM_SIZE 0x149   //How much RAM does the ROM have.
+#define ROM_OFFSET_HEADER_CHECKSUM 0x14D    //Checksum of 0x134-0x14C, checked by the boot ROM.
+#define ROM_OFFSET_GLOBAL_CHECKSUM 0x14E    //16 bit big endian sum of every other byte in the ROM.
+#define ROM_HEADER_END 0x150    //First byte after the header.
+
+//Values of the CGB byte. Anything without bit 7 set is a DMG ROM.
+#define ROM_CGB_ENHANCED 0x80   //Uses CGB features, but still runs on a DMG.
+#define ROM_CGB_ONLY 0xC0       //Only runs on a CGB.
 
 //Enum of all ROM types. Taken from Cinoop, but information found at p11: http://marc.rawer.de/Gameboy/Docs/GBCPUman.pdf (also in '/references')
 enum romType {
@@ -45,6 +55,9 @@ enum romType {
 };
 
 extern const char *romTypeString[256];
+extern enum romType cartType;
+extern unsigned short romBankCount; // 16KB banks in the loaded ROM (a power of 2)
+extern unsigned char cartCgb; // The header's CGB byte
 
 int loadROM(char *filename);
 void unloadROM(void);
\ No newline at end of file
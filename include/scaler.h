@@ -0,0 +1,47 @@
+/*
+    NAME: TMC
+    INIT DATE: 19/10/2026
+    LAST EDIT DATE: 19/10/2026
+    DESC:
+        CPU side upscalers (--scaler <name>), for machines where SDL's renderer falls back to software
+        and for scaled headless capture.
+
+            none        leave it to SDL (the default)
+            nearest     integer nearest neighbour, SCALING_FACTOR times
+            scale2x     Scale2x / AdvMAME2x, rounds off diagonal edges of pixel art
+            scale3x     Scale3x / AdvMAME3x
+            lcd         3x with a dark pixel grid, and ghosting (each frame is blended with the last
+                        one, like the slow DMG LCD)
+
+        Every scaler has a plain C version. SSE2 & AVX2 versions are picked at runtime when the CPU has
+        them (scale2x & scale3x only have SSE2).
+*/
+
+#pragma once
+
+enum scalerMode
+{
+    SCALER_NONE,
+    SCALER_NEAREST,
+    SCALER_SCALE2X,
+    SCALER_SCALE3X,
+    SCALER_LCD,
+};
+
+// One per consumer (the window, the capture), as the LCD ghosting needs the last frame it was given
+struct scaler
+{
+    enum scalerMode mode;
+    int factor;
+    void (*scale)(struct scaler *scaler, const unsigned int *source, unsigned int *destination, int pitch);
+    unsigned int *previous; // Last frame, for ghosting
+    const char *name;
+    const char *kernel;     // "C", "SSE2" or "AVX2"
+};
+
+extern enum scalerMode scalerMode; // From the command line
+
+int parseScalerMode(const char *name, enum scalerMode *mode);
+int initScaler(struct scaler *scaler, enum scalerMode mode);
+void scaleFrame(struct scaler *scaler, const unsigned int *source, unsigned int *destination, int pitch);
+void freeScaler(struct scaler *scaler);
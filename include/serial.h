@@ -0,0 +1,38 @@
+/*
+    NAME: TMC
+    INIT DATE: 19/10/2026
+    LAST EDIT DATE: 19/10/2026
+    DESC:
+        The serial port (SB 0xFF01, SC 0xFF02). Unless --link plugs in a second machine (link.c),
+        nothing is plugged into the link port, so a transfer clocked by the Game Boy itself (SC = 0x81)
+        shifts out SB and shifts in 0xFF, finishing after 8 bits at 8192Hz, and then raises the serial
+        interrupt. A transfer waiting on an external clock never finishes, just like on hardware with
+        no cable.
+
+        Every byte sent is also kept in 'serialCapture'. Test ROMs (blargg's etc.) print their results
+        this way.
+*/
+
+#pragma once
+
+#define SERIAL_TRANSFER_TICKS 4096 // 8 bits at 8192Hz
+#define SERIAL_CAPTURE_SIZE 8192
+
+#define SERIAL_CONTROL_START (1 << 7)
+#define SERIAL_CONTROL_INTERNAL (1 << 0)
+
+struct serialPort
+{
+    unsigned char data;    // SB
+    unsigned char control; // SC
+    unsigned char transferring;
+    unsigned long endTicks; // When the transfer in progress finishes
+} extern serialPort;
+
+extern char serialCapture[SERIAL_CAPTURE_SIZE + 1]; // Always null terminated
+extern unsigned int serialCaptureLength;
+
+void serialReset(void);
+unsigned char serialRead(unsigned short address);
+void serialWrite(unsigned short address, unsigned char value);
+void stepSerial(void);
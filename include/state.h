@@ -0,0 +1,53 @@
+/*
+    NAME: TMC
+    INIT DATE: 19/10/2026
+    LAST EDIT DATE: 19/10/2026
+    DESC:
+        In-memory save states. A save state is a plain copy of every piece of machine state, so saving &
+        loading are a handful of memcpys (under 200KB) and take microseconds. The cartridge ROM is
+        never written so it isn't part of the state.
+*/
+
+#pragma once
+
+#include "registers.h"
+#include "interupts.h"
+#include "gpu.h"
+#include "apu.h"
+#include "keys.h"
+#include "serial.h"
+#include "cgb.h"
+#include "ppu.h"
+
+struct savestate
+{
+    struct registers registers;
+    struct interrupt interrupt;
+    struct gpu gpu;
+    struct apu apu;
+    struct blip blip;
+    struct keys keys;
+    unsigned char joypadTable[4];
+
+    unsigned long ticks;
+    unsigned char stopped;
+    unsigned short romBank;
+    struct serialPort serialPort;
+    struct cgb cgb;
+    const struct ppuEngine *ppu; // Auto mode switches engine as the machine runs
+    struct ppuAuto ppuAuto;
+    unsigned int serialCaptureLength; // The captured bytes themselves are re-sent identically
+
+    unsigned char sram[0x2000];
+    unsigned char io[0x100];
+    unsigned char vram[0x4000];
+    unsigned char oam[0x100];
+    unsigned char wram[0x8000];
+    unsigned char hram[0x80];
+    unsigned char tiles[TILE_COUNT][8][8]; // Decoded from vram, but cheaper to copy than to rebuild
+    unsigned char packedTiles[TILE_COUNT][8][2];
+    unsigned int tileStamps[TILE_COUNT][8];
+};
+
+void saveState(struct savestate *state);
+void loadState(const struct savestate *state);
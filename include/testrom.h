@@ -0,0 +1,44 @@
+/*
+    NAME: TMC
+    INIT DATE: 19/10/2026
+    LAST EDIT DATE: 19/10/2026
+    DESC:
+        Test ROM mode (--test <result file>), used by 'tools/testrunner.c' to run whole directories of
+        test ROMs. The machine stops as soon as the ROM reports a result, or when the cycle budget
+        (--cycles) runs out, and a small result file is written on exit:
+
+            PASSED | FAILED | TIMEOUT | ERROR
+            cycles: <ticks run>
+            registers: A:.. F:.. B:.. C:.. D:.. E:.. H:.. L:.. SP:.... PC:....
+            serial:
+            <everything sent through the serial port>
+
+        Results are read from the serial output ("Passed" / "Failed", as blargg's ROMs print) or from
+        the registers at a 'LD B, B' (Mooneye's ROMs: B C D E H L = 3 5 8 13 21 34 passes, all 0x42
+        fails). ERROR means the emulator quit first (e.g. an undefined opcode). The emulator exits with 1
+        for anything but PASSED.
+*/
+
+#pragma once
+
+enum testResult
+{
+    TEST_RUNNING,
+    TEST_PASSED,
+    TEST_FAILED,
+    TEST_TIMEOUT,
+    TEST_ERROR,
+};
+
+struct testRom
+{
+    unsigned char enabled;
+    enum testResult result;
+    const char *resultName;
+    unsigned int checkedLength; // Serial output already searched
+} extern testRom;
+
+int startTestRom(const char *resultName);
+void testRomEndFrame(void);
+void testRomBreakpoint(void);
+int finishTestRom(void);
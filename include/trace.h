@@ -0,0 +1,41 @@
+/*
+    NAME: TMC
+    INIT DATE: 19/10/2026
+    LAST EDIT DATE: 19/10/2026
+    DESC:
+        Binary instruction trace. One fixed-size record is written per instruction, just before it runs,
+        into a large buffer that is only written out when full. A trace file is a 'traceHeader' followed
+        by records, in the host's byte order (little endian on every machine we build for).
+
+        'tools/gbtrace.c' converts traces to the common text log format (the one used by Gameboy Doctor
+        and most other emulators' logs) and finds the first difference between two traces.
+*/
+
+#pragma once
+
+#define TRACE_MAGIC "GBMTRACE"
+#define TRACE_VERSION 1
+
+struct traceHeader
+{
+    char magic[8];
+    unsigned int version;
+    unsigned int recordSize;
+};
+
+struct traceRecord
+{
+    unsigned char a, f, b, c, d, e, h, l;
+    unsigned short sp;
+    unsigned short pc;
+    unsigned char pcmem[4]; // The opcode and the 3 bytes after it
+    unsigned int ticks;     // Low 32 bits of the CPU ticks
+    unsigned char ly;       // gpu.scanline
+    unsigned char padding[3];
+};
+
+extern unsigned char traceEnabled;
+
+int startTrace(const char *fileName);
+void traceInstruction(void);
+void stopTrace(void);
@@ -0,0 +1,33 @@
+/*
+    NAME: TMC
+    INIT DATE: 19/10/2026
+    LAST EDIT DATE: 19/10/2026
+    DESC:
+        Lock-free triple buffer for handing finished frames from the emulation thread to the presentation
+        thread. The producer always owns one buffer (the one being drawn into), the consumer always owns
+        one (the one being shown), and the third sits in the 'middle' waiting to be swapped by either side
+        with a single atomic exchange. Neither side ever waits for the other; if the consumer is slow the
+        producer simply overwrites the middle buffer with a newer frame, so a shown frame is never torn.
+*/
+
+#pragma once
+
+#include <stdatomic.h>
+
+#define TRIPLEBUFFER_NEW 0x80 // Set in 'middle' when it holds a frame the consumer hasn't seen
+
+// Statically initialised: {{back, middle, front buffers}, 1, 0, 2}
+struct triplebuffer
+{
+    void *buffers[3];
+    _Atomic unsigned char middle; // Index of the buffer in the middle, plus TRIPLEBUFFER_NEW
+    unsigned char back;           // Owned by the producer
+    unsigned char front;          // Owned by the consumer
+};
+
+void *triplebufferPublish(struct triplebuffer *triple);
+int triplebufferAcquire(struct triplebuffer *triple);
+
+// Buffer the producer should draw into / the consumer should read from
+#define triplebufferBack(triple) ((triple)->buffers[(triple)->back])
+#define triplebufferFront(triple) ((triple)->buffers[(triple)->front])
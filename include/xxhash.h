@@ -0,0 +1,13 @@
+/*
+    NAME: TMC
+    INIT DATE: 19/10/2026
+    LAST EDIT DATE: 19/10/2026
+    DESC:
+        XXH64, a fast 64-bit non-cryptographic hash. See 'src/xxhash.c'.
+*/
+
+#pragma once
+
+#include <stddef.h>
+
+unsigned long long xxh64(const void *data, size_t length, unsigned long long seed);
@@ -0,0 +1,865 @@
+/*
+    NAME: TMC
+    INIT DATE: 19/10/2026
+    LAST EDIT DATE: 19/10/2026
+    DESC:
+        The APU. See 'include/apu.h' for the overall idea.
+
+        Samples are made with band-limited step synthesis (the same idea as blargg's blip_buf). Every
+        time the mixed output changes, a pre-computed band-limited step is added into a 'delta' buffer
+        at the exact (fractional) sample position of the change. Reading samples out is then just a
+        running sum of that buffer. This means the work done is per output CHANGE rather than per tick.
+*/
+
+#include "../include/apu.h"
+#include "../include/cpu.h"
+#include "../include/memory.h"
+#include "../include/capture.h"
+#include <SDL2/SDL.h>
+#include <stdio.h>
+#include <string.h>
+#include <math.h>
+
+#define SEQUENCER_PERIOD (APU_CLOCK_RATE / 512) // Frame sequencer runs at 512Hz
+#define APU_VOLUME_SCALE 64                     // Largest mix is 4 channels * 15 * 8 = 480, * 64 fits a short
+
+struct apu apu;
+struct blip blip;
+struct ringbuffer audioRing;
+unsigned long audioDroppedSamples;
+
+static short blipKernel[BLIP_PHASES][BLIP_TAPS];
+static short samples[BLIP_SIZE * 2];
+
+static SDL_AudioDeviceID audioDevice;
+static FILE *wavFile;
+static unsigned long wavSamples;
+
+// Duty cycles as 8 steps, first step in the most significant bit
+static const unsigned char dutyTable[4] = {0x01, 0x81, 0x87, 0x7E};
+static const unsigned char noiseDivisors[8] = {8, 16, 32, 48, 64, 80, 96, 112};
+
+// Bits that always read back as 1 for each register from 0xFF10 to 0xFF2F
+static const unsigned char readMasks[0x20] = {
+    0x80, 0x3F, 0x00, 0xFF, 0xBF, 0xFF, 0x3F, 0x00, 0xFF, 0xBF, 0x7F, 0xFF, 0x9F, 0xFF, 0xBF, 0xFF,
+    0xFF, 0x00, 0x00, 0xBF, 0x00, 0x00, 0x70, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF};
+
+/*===========================================
+    BAND-LIMITED SYNTHESIS
+============================================*/
+
+/*
+    buildKernel
+    ---
+    Windowed-sinc impulse for every sub-sample phase. Each phase is normalised so it sums to exactly
+    1 << BLIP_UNIT_BITS, otherwise the running sum would slowly drift.
+*/
+static void buildKernel(void)
+{
+    int phase, i;
+
+    for (phase = 0; phase < BLIP_PHASES; phase++)
+    {
+        double impulse[BLIP_TAPS];
+        double sum = 0;
+        int total = 0;
+        int largest = 0;
+
+        for (i = 0; i < BLIP_TAPS; i++)
+        {
+            double x = (i - BLIP_TAPS / 2 + 1) - (double)phase / BLIP_PHASES;
+            double window = 0.42 + 0.5 * cos(M_PI * x / (BLIP_TAPS / 2)) + 0.08 * cos(2 * M_PI * x / (BLIP_TAPS / 2));
+            double cutoff = 0.9; // Just under nyquist
+
+            impulse[i] = (x == 0 ? cutoff : sin(M_PI * cutoff * x) / (M_PI * x)) * window;
+            sum += impulse[i];
+        }
+
+        for (i = 0; i < BLIP_TAPS; i++)
+        {
+            blipKernel[phase][i] = (short)floor(impulse[i] / sum * (1 << BLIP_UNIT_BITS) + 0.5);
+            total += blipKernel[phase][i];
+            if (blipKernel[phase][i] > blipKernel[phase][largest])
+                largest = i;
+        }
+
+        // Put any rounding error into the biggest tap
+        blipKernel[phase][largest] += (1 << BLIP_UNIT_BITS) - total;
+    }
+}
+
+/*
+    addDelta
+    ---
+    Add a step of the given size to the left & right outputs at the given CPU tick.
+*/
+static void addDelta(unsigned long time, int deltaLeft, int deltaRight)
+{
+    unsigned long long position = blip.offset + (unsigned long long)(time - blip.ticks) * blip.factor;
+    const short *kernel = blipKernel[(position >> (32 - BLIP_PHASE_BITS)) & (BLIP_PHASES - 1)];
+    int *left = &blip.buffer[0][position >> 32];
+    int *right = &blip.buffer[1][position >> 32];
+    int i;
+
+    for (i = 0; i < BLIP_TAPS; i++)
+    {
+        left[i] += kernel[i] * deltaLeft;
+        right[i] += kernel[i] * deltaRight;
+    }
+}
+
+/*
+    flushSamples
+    ---
+    Turn every whole sample up to 'apu.lastTicks' into output, and hand it to the audio device, the
+    .wav file and/or the capture.
+*/
+static void flushSamples(void)
+{
+    unsigned long long position = blip.offset + (unsigned long long)(apu.lastTicks - blip.ticks) * blip.factor;
+    size_t count = (size_t)(position >> 32);
+    size_t n;
+    int c;
+
+    for (c = 0; c < 2; c++)
+    {
+        int sum = blip.integrator[c];
+        int *buffer = blip.buffer[c];
+
+        for (n = 0; n < count; n++)
+        {
+            int sample = sum >> BLIP_UNIT_BITS;
+            sum += buffer[n];
+
+            if (sample > 32767)
+                sample = 32767;
+            else if (sample < -32768)
+                sample = -32768;
+
+            samples[n * 2 + c] = (short)sample;
+
+            // Leaky integrator, removes the DC offset
+            sum -= sample << (BLIP_UNIT_BITS - BLIP_BASS_SHIFT);
+        }
+
+        blip.integrator[c] = sum;
+
+        // The tail of the most recent steps is still waiting to be read, move it to the front
+        memmove(buffer, buffer + count, BLIP_TAPS * sizeof(int));
+        memset(buffer + BLIP_TAPS, 0, count * sizeof(int));
+    }
+
+    blip.offset = position - ((unsigned long long)count << 32);
+    blip.ticks = apu.lastTicks;
+
+    if (apu.mute || count == 0)
+        return;
+
+    if (capture.enabled)
+        captureAudio(samples, count);
+
+    if (wavFile != NULL)
+    {
+        fwrite(samples, sizeof(short) * 2, count, wavFile);
+        wavSamples += count;
+    }
+
+    if (audioDevice)
+        audioDroppedSamples += count - ringbufferWrite(&audioRing, samples, count);
+}
+
+/*===========================================
+    CHANNELS
+============================================*/
+
+/*
+    updateOutput
+    ---
+    Mix the channels with the panning (NR51) and master volume (NR50), and add a step to the output if
+    the mix has changed.
+*/
+static void updateOutput(unsigned long time)
+{
+    unsigned char panning = io[0x25];
+    unsigned char volume = io[0x24];
+    int left = 0;
+    int right = 0;
+    int c;
+
+    for (c = 0; c < 4; c++)
+    {
+        if (panning & (0x10 << c))
+            left += apu.amplitude[c];
+        if (panning & (0x01 << c))
+            right += apu.amplitude[c];
+    }
+
+    left *= ((volume >> 4) & 7) + 1;
+    right *= (volume & 7) + 1;
+
+    if (left != apu.outLeft || right != apu.outRight)
+    {
+        addDelta(time, (left - apu.outLeft) * APU_VOLUME_SCALE, (right - apu.outRight) * APU_VOLUME_SCALE);
+        apu.outLeft = left;
+        apu.outRight = right;
+    }
+}
+
+static void setAmplitude(int channel, unsigned long time, unsigned char amplitude)
+{
+    if (apu.amplitude[channel] != amplitude)
+    {
+        apu.amplitude[channel] = amplitude;
+        updateOutput(time);
+    }
+}
+
+static unsigned char squareAmplitude(struct square *channel)
+{
+    if (!channel->enabled || !channel->dacEnabled)
+        return 0;
+
+    return ((dutyTable[channel->duty] >> (7 - channel->dutyStep)) & 1) ? channel->volume : 0;
+}
+
+static unsigned char waveAmplitude(void)
+{
+    unsigned char sample;
+
+    if (!apu.wave.enabled || !apu.wave.dacEnabled)
+        return 0;
+
+    // Two 4-bit samples per byte of wave RAM, high nibble first
+    sample = io[0x30 + (apu.wave.position >> 1)];
+    sample = (apu.wave.position & 1) ? (sample & 0x0F) : (sample >> 4);
+
+    return sample >> apu.wave.volumeShift;
+}
+
+static unsigned char noiseAmplitude(void)
+{
+    if (!apu.noise.enabled || !apu.noise.dacEnabled)
+        return 0;
+
+    return (apu.noise.lfsr & 1) ? 0 : apu.noise.volume;
+}
+
+/*
+    refreshAmplitudes
+    ---
+    Recalculate every channel's output after something other than a channel's own timer has changed
+    (a register write, or the frame sequencer).
+*/
+static void refreshAmplitudes(unsigned long time)
+{
+    apu.amplitude[0] = squareAmplitude(&apu.square[0]);
+    apu.amplitude[1] = squareAmplitude(&apu.square[1]);
+    apu.amplitude[2] = waveAmplitude();
+    apu.amplitude[3] = noiseAmplitude();
+
+    updateOutput(time);
+}
+
+/*
+    runSquare
+    ---
+    Run a pulse channel for 'length' ticks from 'apu.lastTicks', adding a step whenever its output
+    changes. A channel that can't be heard just jumps its position in the waveform forward.
+*/
+static void runSquare(int index, unsigned long length)
+{
+    struct square *channel = &apu.square[index];
+    unsigned long time = apu.lastTicks;
+    unsigned int period = (2048 - channel->frequency) * 4;
+
+    if (!channel->enabled || !channel->dacEnabled || !channel->volume)
+    {
+        if (length < channel->timer)
+        {
+            channel->timer -= length;
+            return;
+        }
+
+        length -= channel->timer;
+        channel->dutyStep = (channel->dutyStep + 1 + length / period) & 7;
+        channel->timer = period - length % period;
+        return;
+    }
+
+    while (channel->timer <= length)
+    {
+        time += channel->timer;
+        length -= channel->timer;
+        channel->timer = period;
+        channel->dutyStep = (channel->dutyStep + 1) & 7;
+
+        setAmplitude(index, time, squareAmplitude(channel));
+    }
+
+    channel->timer -= length;
+}
+
+static void runWave(unsigned long length)
+{
+    unsigned long time = apu.lastTicks;
+    unsigned int period = (2048 - apu.wave.frequency) * 2;
+
+    if (!apu.wave.enabled || !apu.wave.dacEnabled || apu.wave.volumeShift == 4)
+    {
+        if (length < apu.wave.timer)
+        {
+            apu.wave.timer -= length;
+            return;
+        }
+
+        length -= apu.wave.timer;
+        apu.wave.position = (apu.wave.position + 1 + length / period) & 31;
+        apu.wave.timer = period - length % period;
+        return;
+    }
+
+    while (apu.wave.timer <= length)
+    {
+        time += apu.wave.timer;
+        length -= apu.wave.timer;
+        apu.wave.timer = period;
+        apu.wave.position = (apu.wave.position + 1) & 31;
+
+        setAmplitude(2, time, waveAmplitude());
+    }
+
+    apu.wave.timer -= length;
+}
+
+static void runNoise(unsigned long length)
+{
+    unsigned long time = apu.lastTicks;
+    unsigned int period = noiseDivisors[apu.noise.divisorCode] << apu.noise.clockShift;
+    unsigned short feedback;
+
+    // A disabled channel's LFSR doesn't matter, it is reset when the channel is triggered
+    if (!apu.noise.enabled || !apu.noise.dacEnabled)
+    {
+        if (length < apu.noise.timer)
+            apu.noise.timer -= length;
+        else
+            apu.noise.timer = period - (length - apu.noise.timer) % period;
+        return;
+    }
+
+    while (apu.noise.timer <= length)
+    {
+        time += apu.noise.timer;
+        length -= apu.noise.timer;
+        apu.noise.timer = period;
+
+        feedback = (apu.noise.lfsr ^ (apu.noise.lfsr >> 1)) & 1;
+        apu.noise.lfsr = (apu.noise.lfsr >> 1) | (feedback << 14);
+        if (apu.noise.widthMode)
+            apu.noise.lfsr = (apu.noise.lfsr & ~0x40) | (feedback << 6);
+
+        setAmplitude(3, time, noiseAmplitude());
+    }
+
+    apu.noise.timer -= length;
+}
+
+/*===========================================
+    FRAME SEQUENCER
+============================================*/
+
+static unsigned short sweepCalculation(void)
+{
+    struct square *channel = &apu.square[0];
+    unsigned short change = channel->shadowFrequency >> channel->sweepShift;
+    unsigned short frequency = channel->sweepNegate ? channel->shadowFrequency - change : channel->shadowFrequency + change;
+
+    // Overflowing the 11-bit frequency switches the channel off
+    if (frequency > 2047)
+        channel->enabled = 0;
+
+    return frequency;
+}
+
+static void clockLength(unsigned char *enabled, unsigned short *length, unsigned char lengthEnable)
+{
+    if (lengthEnable && *length)
+    {
+        (*length)--;
+        if (*length == 0)
+            *enabled = 0;
+    }
+}
+
+static void clockEnvelope(unsigned char *volume, unsigned char *timer, unsigned char period, unsigned char add)
+{
+    if (!period)
+        return;
+
+    if (--(*timer) == 0)
+    {
+        *timer = period;
+        if (add && *volume < 15)
+            (*volume)++;
+        else if (!add && *volume > 0)
+            (*volume)--;
+    }
+}
+
+static void clockSequencer(void)
+{
+    unsigned char step = apu.sequencerStep;
+    struct square *sweep = &apu.square[0];
+    int i;
+
+    apu.sequencerStep = (step + 1) & 7;
+
+    if (!apu.enabled)
+        return;
+
+    // Length counters on every even step
+    if (!(step & 1))
+    {
+        for (i = 0; i < 2; i++)
+            clockLength(&apu.square[i].enabled, &apu.square[i].length, apu.square[i].lengthEnable);
+        clockLength(&apu.wave.enabled, &apu.wave.length, apu.wave.lengthEnable);
+        clockLength(&apu.noise.enabled, &apu.noise.length, apu.noise.lengthEnable);
+    }
+
+    // Channel 1's frequency sweep on steps 2 & 6
+    if ((step == 2 || step == 6) && --sweep->sweepTimer == 0)
+    {
+        sweep->sweepTimer = sweep->sweepPeriod ? sweep->sweepPeriod : 8;
+
+        if (sweep->sweepEnabled && sweep->sweepPeriod)
+        {
+            unsigned short frequency = sweepCalculation();
+            if (frequency <= 2047 && sweep->sweepShift)
+            {
+                sweep->frequency = sweep->shadowFrequency = frequency;
+                sweepCalculation();
+            }
+        }
+    }
+
+    // Volume envelopes on step 7
+    if (step == 7)
+    {
+        for (i = 0; i < 2; i++)
+            clockEnvelope(&apu.square[i].volume, &apu.square[i].envelopeTimer, apu.square[i].envelopePeriod, apu.square[i].envelopeAdd);
+        clockEnvelope(&apu.noise.volume, &apu.noise.envelopeTimer, apu.noise.envelopePeriod, apu.noise.envelopeAdd);
+    }
+
+    refreshAmplitudes(apu.lastTicks);
+}
+
+/*===========================================
+    INTERFACE
+============================================*/
+
+void apuReset(void)
+{
+    static unsigned char kernelBuilt = 0;
+    unsigned char mute = apu.mute;
+
+    if (!kernelBuilt)
+    {
+        buildKernel();
+        kernelBuilt = 1;
+    }
+
+    memset(&apu, 0, sizeof(apu));
+    apu.enabled = 1;
+    apu.mute = mute;
+    apu.sequencerTimer = SEQUENCER_PERIOD;
+    apu.noise.lfsr = 0x7FFF;
+    apu.wave.volumeShift = 4;
+    apu.lastTicks = ticks;
+
+    memset(&blip, 0, sizeof(blip));
+    blip.offset = 0;
+    blip.ticks = ticks;
+    blip.factor = ((unsigned long long)AUDIO_SAMPLE_RATE << 32) / APU_CLOCK_RATE;
+}
+
+/*
+    apuSetRate
+    ---
+    Make slightly more (ratio > 1) or fewer (ratio < 1) samples per tick. Used by pacing to keep the
+    audio ring level. Only call right after apuEndFrame, when no deltas are waiting past the last flush.
+*/
+void apuSetRate(double ratio)
+{
+    blip.factor = (unsigned long long)(((double)AUDIO_SAMPLE_RATE * 4294967296.0 / APU_CLOCK_RATE) * ratio);
+}
+
+/*
+    apuCatchUp
+    ---
+    Synthesize everything from where the APU was last left up to the current CPU ticks. This is run in
+    chunks that end on frame sequencer steps, which are the only changes not caused by a register write.
+*/
+void apuCatchUp(void)
+{
+    unsigned long length;
+
+    while (apu.lastTicks != ticks)
+    {
+        length = ticks - apu.lastTicks;
+        if (length > apu.sequencerTimer)
+            length = apu.sequencerTimer;
+
+        if (apu.enabled)
+        {
+            runSquare(0, length);
+            runSquare(1, length);
+            runWave(length);
+            runNoise(length);
+        }
+
+        apu.lastTicks += length;
+        apu.sequencerTimer -= length;
+
+        if (apu.sequencerTimer == 0)
+        {
+            apu.sequencerTimer = SEQUENCER_PERIOD;
+            clockSequencer();
+        }
+
+        // Don't let the delta buffer overflow if nothing has asked for samples in a while
+        if ((blip.offset + (unsigned long long)(apu.lastTicks - blip.ticks) * blip.factor) >> 32 > BLIP_SIZE - 256)
+            flushSamples();
+    }
+}
+
+/*
+    apuEndFrame
+    ---
+    Called once per frame, hands every finished sample over to the audio device / .wav file.
+*/
+void apuEndFrame(void)
+{
+    apuCatchUp();
+    flushSamples();
+}
+
+unsigned char apuRead(unsigned short address)
+{
+    // Length counters may have switched channels off since the last write
+    if (address == 0xFF26)
+        apuCatchUp();
+
+    return apuPeek(address);
+}
+
+/*
+    apuPeek
+    ---
+    apuRead without catching up first, so NR52 shows the channels as of the last catch up. For
+    peekByte.
+*/
+unsigned char apuPeek(unsigned short address)
+{
+    unsigned char value;
+
+    // Wave RAM reads back as is
+    if (address >= 0xFF30)
+        return io[address - 0xFF00];
+
+    if (address == 0xFF26)
+    {
+        value = (apu.enabled ? 0x80 : 0) | 0x70;
+        value |= apu.square[0].enabled ? 0x01 : 0;
+        value |= apu.square[1].enabled ? 0x02 : 0;
+        value |= apu.wave.enabled ? 0x04 : 0;
+        value |= apu.noise.enabled ? 0x08 : 0;
+        return value;
+    }
+
+    return io[address - 0xFF00] | readMasks[address - 0xFF10];
+}
+
+static void writeSquare(int index, int reg, unsigned char value)
+{
+    struct square *channel = &apu.square[index];
+
+    switch (reg)
+    {
+    case 0: // NR10, sweep
+        channel->sweepPeriod = (value >> 4) & 7;
+        channel->sweepNegate = (value >> 3) & 1;
+        channel->sweepShift = value & 7;
+        break;
+
+    case 1: // NRx1, duty & length
+        channel->duty = value >> 6;
+        channel->length = 64 - (value & 0x3F);
+        break;
+
+    case 2: // NRx2, envelope
+        channel->envelopeVolume = value >> 4;
+        channel->envelopeAdd = (value >> 3) & 1;
+        channel->envelopePeriod = value & 7;
+        channel->dacEnabled = (value & 0xF8) != 0;
+        if (!channel->dacEnabled)
+            channel->enabled = 0;
+        break;
+
+    case 3: // NRx3, frequency low
+        channel->frequency = (channel->frequency & 0x700) | value;
+        break;
+
+    case 4: // NRx4, frequency high, length enable & trigger
+        channel->frequency = (channel->frequency & 0xFF) | ((value & 7) << 8);
+        channel->lengthEnable = (value >> 6) & 1;
+
+        if (value & 0x80)
+        {
+            channel->enabled = channel->dacEnabled;
+            if (channel->length == 0)
+                channel->length = 64;
+            channel->timer = (2048 - channel->frequency) * 4;
+            channel->volume = channel->envelopeVolume;
+            channel->envelopeTimer = channel->envelopePeriod;
+
+            if (index == 0)
+            {
+                channel->shadowFrequency = channel->frequency;
+                channel->sweepTimer = channel->sweepPeriod ? channel->sweepPeriod : 8;
+                channel->sweepEnabled = channel->sweepPeriod || channel->sweepShift;
+                if (channel->sweepShift)
+                    sweepCalculation();
+            }
+        }
+        break;
+    }
+}
+
+void apuWrite(unsigned short address, unsigned char value)
+{
+    apuCatchUp();
+
+    // While the APU is switched off only NR52 and wave RAM can be written
+    if (!apu.enabled && address != 0xFF26 && address < 0xFF30)
+        return;
+
+    io[address - 0xFF00] = value;
+
+    if (address >= 0xFF10 && address <= 0xFF14)
+        writeSquare(0, address - 0xFF10, value);
+    else if (address >= 0xFF16 && address <= 0xFF19)
+        writeSquare(1, address - 0xFF15, value);
+
+    switch (address)
+    {
+    case 0xFF1A: // NR30, wave DAC
+        apu.wave.dacEnabled = value >> 7;
+        if (!apu.wave.dacEnabled)
+            apu.wave.enabled = 0;
+        break;
+
+    case 0xFF1B: // NR31, length
+        apu.wave.length = 256 - value;
+        break;
+
+    case 0xFF1C: // NR32, volume. 0 = mute, 1 = 100%, 2 = 50%, 3 = 25%
+        apu.wave.volumeShift = ((value >> 5) & 3) ? ((value >> 5) & 3) - 1 : 4;
+        break;
+
+    case 0xFF1D: // NR33
+        apu.wave.frequency = (apu.wave.frequency & 0x700) | value;
+        break;
+
+    case 0xFF1E: // NR34
+        apu.wave.frequency = (apu.wave.frequency & 0xFF) | ((value & 7) << 8);
+        apu.wave.lengthEnable = (value >> 6) & 1;
+        if (value & 0x80)
+        {
+            apu.wave.enabled = apu.wave.dacEnabled;
+            if (apu.wave.length == 0)
+                apu.wave.length = 256;
+            apu.wave.timer = (2048 - apu.wave.frequency) * 2;
+            apu.wave.position = 0;
+        }
+        break;
+
+    case 0xFF20: // NR41
+        apu.noise.length = 64 - (value & 0x3F);
+        break;
+
+    case 0xFF21: // NR42
+        apu.noise.envelopeVolume = value >> 4;
+        apu.noise.envelopeAdd = (value >> 3) & 1;
+        apu.noise.envelopePeriod = value & 7;
+        apu.noise.dacEnabled = (value & 0xF8) != 0;
+        if (!apu.noise.dacEnabled)
+            apu.noise.enabled = 0;
+        break;
+
+    case 0xFF22: // NR43
+        apu.noise.clockShift = value >> 4;
+        apu.noise.widthMode = (value >> 3) & 1;
+        apu.noise.divisorCode = value & 7;
+        break;
+
+    case 0xFF23: // NR44
+        apu.noise.lengthEnable = (value >> 6) & 1;
+        if (value & 0x80)
+        {
+            apu.noise.enabled = apu.noise.dacEnabled;
+            if (apu.noise.length == 0)
+                apu.noise.length = 64;
+            apu.noise.timer = noiseDivisors[apu.noise.divisorCode] << apu.noise.clockShift;
+            apu.noise.volume = apu.noise.envelopeVolume;
+            apu.noise.envelopeTimer = apu.noise.envelopePeriod;
+            apu.noise.lfsr = 0x7FFF;
+        }
+        break;
+
+    case 0xFF26: // NR52, power
+        if (!(value & 0x80) && apu.enabled)
+        {
+            // Powering off clears every sound register
+            memset(&io[0x10], 0, 0x26 - 0x10);
+            memset(apu.square, 0, sizeof(apu.square));
+            memset(&apu.wave, 0, sizeof(apu.wave));
+            memset(&apu.noise, 0, sizeof(apu.noise));
+            apu.wave.volumeShift = 4;
+            apu.enabled = 0;
+        }
+        else if ((value & 0x80) && !apu.enabled)
+        {
+            apu.enabled = 1;
+            apu.sequencerStep = 0;
+        }
+        break;
+    }
+
+    refreshAmplitudes(apu.lastTicks);
+}
+
+/*===========================================
+    OUTPUT
+============================================*/
+
+/*
+    audioCallback
+    ---
+    Runs on SDL's audio thread. Only ever reads from the ring, if emulation is running behind it
+    plays silence rather than waiting.
+*/
+static void audioCallback(void *userdata, Uint8 *stream, int length)
+{
+    size_t wanted = length / (sizeof(short) * 2);
+    size_t got = ringbufferRead(&audioRing, stream, wanted);
+
+    memset(stream + got * sizeof(short) * 2, 0, (wanted - got) * sizeof(short) * 2);
+}
+
+/*
+    openAudio
+    ---
+    Open the audio device & start playing from the ring. Returns 1 on success.
+*/
+int openAudio(void)
+{
+    SDL_AudioSpec want;
+    SDL_AudioSpec have;
+
+    if (SDL_InitSubSystem(SDL_INIT_AUDIO) != 0)
+    {
+        printf("Failed to start audio: %s\n", SDL_GetError());
+        return 0;
+    }
+
+    if (!ringbufferInit(&audioRing, sizeof(short) * 2, AUDIO_RING_SIZE))
+        return 0;
+
+    memset(&want, 0, sizeof(want));
+    want.freq = AUDIO_SAMPLE_RATE;
+    want.format = AUDIO_S16SYS;
+    want.channels = 2;
+    want.samples = 512;
+    want.callback = audioCallback;
+
+    audioDevice = SDL_OpenAudioDevice(NULL, 0, &want, &have, 0);
+    if (!audioDevice)
+    {
+        printf("Failed to open audio device: %s\n", SDL_GetError());
+        ringbufferFree(&audioRing);
+        return 0;
+    }
+
+    SDL_PauseAudioDevice(audioDevice, 0);
+    return 1;
+}
+
+int audioIsOpen(void)
+{
+    return audioDevice != 0;
+}
+
+static void writeLittleEndian(unsigned long value, int bytes)
+{
+    while (bytes--)
+    {
+        fputc(value & 0xFF, wavFile);
+        value >>= 8;
+    }
+}
+
+static void writeWavHeader(void)
+{
+    unsigned long dataSize = wavSamples * sizeof(short) * 2;
+
+    fwrite("RIFF", 4, 1, wavFile);
+    writeLittleEndian(36 + dataSize, 4);
+    fwrite("WAVEfmt ", 8, 1, wavFile);
+    writeLittleEndian(16, 4);                              // fmt chunk size
+    writeLittleEndian(1, 2);                               // PCM
+    writeLittleEndian(2, 2);                               // Stereo
+    writeLittleEndian(AUDIO_SAMPLE_RATE, 4);               // Sample rate
+    writeLittleEndian(AUDIO_SAMPLE_RATE * 2 * 2, 4);       // Bytes per second
+    writeLittleEndian(2 * 2, 2);                           // Bytes per sample frame
+    writeLittleEndian(16, 2);                              // Bits per sample
+    fwrite("data", 4, 1, wavFile);
+    writeLittleEndian(dataSize, 4);
+}
+
+/*
+    startWav
+    ---
+    Dump every sample to a .wav file as well (or instead, if there is no audio device). The sizes in
+    the header are filled in by closeAPU. Returns 1 on success.
+*/
+int startWav(const char *fileName)
+{
+    wavFile = fopen(fileName, "wb");
+    if (wavFile == NULL)
+    {
+        printf("Failed to open \"%s\" for writing.\n", fileName);
+        return 0;
+    }
+
+    wavSamples = 0;
+    writeWavHeader();
+    return 1;
+}
+
+void closeAPU(void)
+{
+    if (audioDevice)
+    {
+        SDL_CloseAudioDevice(audioDevice);
+        audioDevice = 0;
+        ringbufferFree(&audioRing);
+    }
+
+    if (wavFile != NULL)
+    {
+        rewind(wavFile);
+        writeWavHeader();
+        fclose(wavFile);
+        wavFile = NULL;
+    }
+}
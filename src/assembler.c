@@ -0,0 +1,1115 @@
+/*
+    NAME: TMC
+    INIT DATE: 19/10/2026
+    LAST EDIT DATE: 19/10/2026
+    DESC:
+        SM83 assembler. See 'include/assembler.h'.
+
+        Every line is first put in a canonical form: upper case, no spaces, and every number written as
+        0X<hex>. The disassembly strings from 'instructions.inc' are split at their operand ("0x%02X")
+        into a prefix & suffix and put through the same function, so matching an instruction is just
+        comparing the start & end of two strings, and whatever is between them is the operand.
+
+        The source is assembled twice. The first pass finds out where every label is, the second one
+        writes the bytes.
+*/
+
+#include "../include/assembler.h"
+#include "../include/rom.h"
+#include <ctype.h>
+#include <stdarg.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define MAX_LINE 512
+#define MAX_SYMBOL_NAME 64
+#define BANK_SIZE 0x4000
+
+enum operandKind
+{
+    OPERAND_NONE,
+    OPERAND_BYTE,
+    OPERAND_WORD,
+    OPERAND_RELATIVE, // JR, stored as a signed offset from the next instruction
+    OPERAND_ZERO,     // STOP, which is followed by a 0 byte
+};
+
+struct mnemonic
+{
+    char prefix[48];
+    char suffix[48];
+    unsigned char opcode;
+    unsigned char operand;
+};
+
+struct symbol
+{
+    char name[MAX_SYMBOL_NAME];
+    long value;
+    int line; // Where it was first defined
+    unsigned char isLabel;
+};
+
+struct assembler
+{
+    const char *sourceName;
+    char **lines;
+    int lineCount;
+    int line;
+    int pass;
+    int errors;   // In this pass
+    int reported; // Printed, over both passes
+    unsigned char loud;
+
+    unsigned char *rom;
+    unsigned int bank;
+    unsigned int address;  // Address the CPU sees
+    unsigned long position; // Offset into the ROM file
+    unsigned long end;      // One past the highest byte written
+    unsigned char entryWritten;
+
+    char title[17];
+    unsigned char cartType;
+    unsigned char ramSize;
+
+    struct symbol symbols[ASSEMBLER_MAX_SYMBOLS];
+    int symbolCount;
+};
+
+#define INSTRUCTION(opcode, disassembly, operandLength, execute) {disassembly, operandLength},
+static const struct
+{
+    const char *disassembly;
+    unsigned char operandLength;
+} instructionList[256] = {
+#include "../include/instructions.inc"
+};
+#undef INSTRUCTION
+
+static struct mnemonic mnemonics[256];
+static int mnemonicCount;
+
+// Other ways of writing the same instruction, in canonical form. Only the start of a line is replaced.
+static const char *aliases[][2] = {
+    {"LDH(", "LD(0XFF00+"},
+    {"LDHA,(", "LDA,(0XFF00+"},
+    {"LD(C),A", "LD(0XFF00+C),A"},
+    {"LDA,(C)", "LDA,(0XFF00+C)"},
+    {"LD(HL+),A", "LDI(HL),A"},
+    {"LD(HLI),A", "LDI(HL),A"},
+    {"LDA,(HL+)", "LDIA,(HL)"},
+    {"LDA,(HLI)", "LDIA,(HL)"},
+    {"LD(HL-),A", "LDD(HL),A"},
+    {"LD(HLD),A", "LDD(HL),A"},
+    {"LDA,(HL-)", "LDDA,(HL)"},
+    {"LDA,(HLD)", "LDDA,(HL)"},
+    {"JP(HL)", "JPHL"},
+    {"ADDA,A", "ADDA"},
+    {"ADCA,", "ADC"},
+    {"SUBA,", "SUB"},
+    {"SBCA,", "SBC"},
+    {"ANDA,", "AND"},
+    {"XORA,", "XOR"},
+    {"ORA,", "OR"},
+    {"CPA,", "CP"},
+};
+
+static const char *registerNames[] = {"A", "B", "C", "D", "E", "H", "L", "AF", "BC", "DE", "HL", "SP", "NZ", "Z", "NC",
+                                      "(C)", "(BC)", "(DE)", "(HL)", "(SP)"};
+
+static const unsigned char nintendoLogo[48] = {
+    0xCE, 0xED, 0x66, 0x66, 0xCC, 0x0D, 0x00, 0x0B, 0x03, 0x73, 0x00, 0x83, 0x00, 0x0C, 0x00, 0x0D,
+    0x00, 0x08, 0x11, 0x1F, 0x88, 0x89, 0x00, 0x0E, 0xDC, 0xCC, 0x6E, 0xE6, 0xDD, 0xDD, 0xD9, 0x99,
+    0xBB, 0xBB, 0x67, 0x63, 0x6E, 0x0E, 0xEC, 0xCC, 0xDD, 0xDC, 0x99, 0x9F, 0xBB, 0xB9, 0x33, 0x3E,
+};
+
+static void error(struct assembler *as, const char *format, ...)
+{
+    va_list args;
+
+    // Pass 1 only counts errors, they are printed when pass 2 runs into them again
+    as->errors++;
+    if (as->pass == 1 && !as->loud)
+        return;
+
+    printf("%s:%d: ", as->sourceName, as->line);
+    va_start(args, format);
+    vprintf(format, args);
+    va_end(args);
+    printf("\n");
+    as->reported++;
+}
+
+static int isSymbolStart(char c)
+{
+    return isalpha((unsigned char)c) || c == '_' || c == '.';
+}
+
+static int isSymbolChar(char c)
+{
+    return isalnum((unsigned char)c) || c == '_' || c == '.';
+}
+
+/*
+    canonical
+    ---
+    Upper case, strip spaces, and rewrite every number as 0X<hex>, so "ld a, $1f" and "LD A,0x1F" both
+    become "LDA,0X1F". % only starts a binary number where a value has to start (after an operator, a
+    bracket, or the mnemonic), so "X % 10" is still modulo.
+*/
+static void canonical(const char *in, char *out, size_t size)
+{
+    size_t length = 0;
+    char previous = ','; // Last character that wasn't a space
+    int words = 0;       // Symbols so far
+    char number[20];
+
+    while (*in != '\0' && length + sizeof(number) < size)
+    {
+        unsigned long value;
+        int boundary = (!isSymbolChar(previous) && previous != ')') || (words == 1 && previous == 'A');
+
+        if (isspace((unsigned char)*in))
+        {
+            in++;
+            continue;
+        }
+
+        // Symbols and numbers swallow their own digits, so a digit here always starts a number. $ and
+        // characters can't mean anything else.
+        if (isdigit((unsigned char)*in) || (*in == '$' && isxdigit((unsigned char)in[1])) ||
+            (*in == '\'' && in[1] != '\0' && in[2] == '\'') || (boundary && *in == '%' && (in[1] == '0' || in[1] == '1')))
+        {
+            char *stop;
+
+            if (*in == '$')
+                value = strtoul(in + 1, &stop, 16);
+            else if (*in == '%')
+                value = strtoul(in + 1, &stop, 2);
+            else if (*in == '\'')
+            {
+                value = (unsigned char)in[1];
+                stop = (char *)in + 3;
+            }
+            else if (in[0] == '0' && (in[1] == 'x' || in[1] == 'X'))
+                value = strtoul(in + 2, &stop, 16);
+            else
+                value = strtoul(in, &stop, 10);
+
+            in = stop;
+            sprintf(number, "0X%lX", value);
+            memcpy(out + length, number, strlen(number));
+            length += strlen(number);
+            previous = '0';
+            continue;
+        }
+
+        // Symbols are copied whole, so the digits in "LOOP2" aren't read as a number
+        if (isSymbolStart(*in))
+        {
+            while (isSymbolChar(*in) && length + 1 < size)
+                out[length++] = toupper((unsigned char)*in++);
+            previous = 'A';
+            words++;
+            continue;
+        }
+
+        out[length++] = toupper((unsigned char)*in);
+        previous = *in++;
+    }
+
+    out[length] = '\0';
+}
+
+/*
+    loadMnemonics
+    ---
+    Split every disassembly string at its operand and store both halves in canonical form.
+*/
+static void loadMnemonics(void)
+{
+    int i;
+
+    if (mnemonicCount)
+        return;
+
+    for (i = 0; i < 256; i++)
+    {
+        const char *text = instructionList[i].disassembly;
+        const char *placeholder = strstr(text, "%0");
+        struct mnemonic *m = &mnemonics[mnemonicCount];
+        char part[64];
+
+        if (!strcmp(text, "UNKNOWN"))
+            continue;
+
+        m->opcode = i;
+        if (placeholder == NULL)
+        {
+            canonical(text, m->prefix, sizeof(m->prefix));
+            m->suffix[0] = '\0';
+            m->operand = instructionList[i].operandLength ? OPERAND_ZERO : OPERAND_NONE;
+        }
+        else
+        {
+            const char *operandStart = placeholder;
+
+            if (operandStart - text >= 2 && !strncmp(operandStart - 2, "0x", 2))
+                operandStart -= 2;
+
+            memcpy(part, text, operandStart - text);
+            part[operandStart - text] = '\0';
+            canonical(part, m->prefix, sizeof(m->prefix));
+            canonical(placeholder + 4, m->suffix, sizeof(m->suffix));
+
+            if (!strncmp(m->prefix, "JR", 2))
+                m->operand = OPERAND_RELATIVE;
+            else
+                m->operand = placeholder[2] == '4' ? OPERAND_WORD : OPERAND_BYTE;
+        }
+
+        mnemonicCount++;
+    }
+}
+
+static struct symbol *findSymbol(struct assembler *as, const char *name)
+{
+    int i;
+
+    for (i = 0; i < as->symbolCount; i++)
+    {
+        if (!strcmp(as->symbols[i].name, name))
+            return &as->symbols[i];
+    }
+
+    return NULL;
+}
+
+static void defineSymbol(struct assembler *as, const char *name, long value, int isLabel)
+{
+    struct symbol *s = findSymbol(as, name);
+
+    if (s == NULL)
+    {
+        if (as->symbolCount == ASSEMBLER_MAX_SYMBOLS || strlen(name) >= MAX_SYMBOL_NAME)
+        {
+            error(as, "too many symbols, or \"%s\" is too long", name);
+            return;
+        }
+
+        s = &as->symbols[as->symbolCount++];
+        strcpy(s->name, name);
+        s->value = value;
+        s->line = as->line;
+        s->isLabel = isLabel;
+        return;
+    }
+
+    if (as->pass == 1 && (isLabel || s->isLabel))
+    {
+        as->loud = 1;
+        error(as, "\"%s\" is already defined on line %d", name, s->line);
+        as->loud = 0;
+        return;
+    }
+    if (as->pass == 2 && isLabel && s->line != as->line)
+        return;
+    if (as->pass == 2 && isLabel && s->value != value)
+        error(as, "\"%s\" moved between passes (0x%lX -> 0x%lX)", name, s->value, value);
+
+    s->value = value;
+}
+
+/*
+    Expressions
+    ---
+    Precedence climbing over canonical text. 'known' is cleared when an undefined symbol is used, which
+    is fine in pass 1 (the label may come later) and an error in pass 2.
+*/
+struct expression
+{
+    struct assembler *as;
+    const char *text;
+    int known;
+    int failed;
+};
+
+static long parseExpression(struct expression *e, int precedence);
+
+static long parsePrimary(struct expression *e)
+{
+    char name[MAX_SYMBOL_NAME];
+    size_t length = 0;
+    struct symbol *s;
+    long value;
+
+    if (*e->text == '(')
+    {
+        e->text++;
+        value = parseExpression(e, 0);
+        if (*e->text != ')')
+            e->failed = 1;
+        else
+            e->text++;
+        return value;
+    }
+    if (*e->text == '-')
+    {
+        e->text++;
+        return -parsePrimary(e);
+    }
+    if (*e->text == '+')
+    {
+        e->text++;
+        return parsePrimary(e);
+    }
+    if (*e->text == '~')
+    {
+        e->text++;
+        return ~parsePrimary(e);
+    }
+    if (*e->text == '@')
+    {
+        e->text++;
+        return e->as->address;
+    }
+    if (!strncmp(e->text, "0X", 2))
+    {
+        char *stop;
+        value = strtol(e->text + 2, &stop, 16);
+        e->text = stop;
+        return value;
+    }
+    if (!isSymbolStart(*e->text))
+    {
+        e->failed = 1;
+        return 0;
+    }
+
+    while (isSymbolChar(*e->text))
+    {
+        if (length + 1 < sizeof(name))
+            name[length++] = *e->text;
+        e->text++;
+    }
+    name[length] = '\0';
+
+    if (*e->text == '(' && (!strcmp(name, "HIGH") || !strcmp(name, "LOW")))
+    {
+        value = parsePrimary(e);
+        return name[0] == 'H' ? (value >> 8) & 0xFF : value & 0xFF;
+    }
+
+    s = findSymbol(e->as, name);
+    if (s == NULL)
+    {
+        if (e->as->pass == 2)
+            error(e->as, "unknown symbol \"%s\"", name);
+        e->known = 0;
+        return 0;
+    }
+
+    return s->value;
+}
+
+// Binary operators from lowest to highest precedence
+static const char *binaryOperators[][3] = {
+    {"|"},
+    {"^"},
+    {"&"},
+    {"<<", ">>"},
+    {"+", "-"},
+    {"*", "/", "%"},
+};
+
+static long parseExpression(struct expression *e, int precedence)
+{
+    long left;
+    int i;
+
+    if (precedence == sizeof(binaryOperators) / sizeof(binaryOperators[0]))
+        return parsePrimary(e);
+
+    left = parseExpression(e, precedence + 1);
+    for (;;)
+    {
+        const char *op = NULL;
+        long right;
+
+        for (i = 0; i < 3 && binaryOperators[precedence][i] != NULL; i++)
+        {
+            if (!strncmp(e->text, binaryOperators[precedence][i], strlen(binaryOperators[precedence][i])))
+                op = binaryOperators[precedence][i];
+        }
+        if (op == NULL)
+            return left;
+
+        e->text += strlen(op);
+        right = parseExpression(e, precedence + 1);
+
+        switch (op[0])
+        {
+        case '|': left |= right; break;
+        case '^': left ^= right; break;
+        case '&': left &= right; break;
+        case '<': left <<= right; break;
+        case '>': left >>= right; break;
+        case '+': left += right; break;
+        case '-': left -= right; break;
+        case '*': left *= right; break;
+        case '/':
+        case '%':
+            if (right == 0)
+            {
+                if (e->known)
+                    e->failed = 1;
+                left = 0;
+            }
+            else
+                left = op[0] == '/' ? left / right : left % right;
+            break;
+        }
+    }
+}
+
+/*
+    evaluate
+    ---
+    Evaluate canonical text. Returns 0 on a syntax error; '*known' says whether every symbol was defined.
+*/
+static int evaluate(struct assembler *as, const char *text, long *value, int *known)
+{
+    struct expression e = {as, text, 1, 0};
+
+    *value = parseExpression(&e, 0);
+    if (known != NULL)
+        *known = e.known;
+
+    if (e.failed || *e.text != '\0')
+    {
+        error(as, "bad expression \"%s\"", text);
+        return 0;
+    }
+
+    return 1;
+}
+
+// Evaluate something that decides where code goes, which has to be known in the first pass
+static int evaluateNow(struct assembler *as, const char *text, long *value)
+{
+    char buffer[MAX_LINE];
+    int known;
+
+    canonical(text, buffer, sizeof(buffer));
+    if (!evaluate(as, buffer, value, &known))
+        return 0;
+
+    if (!known)
+    {
+        // Report it in pass 1, in pass 2 the symbol is known and it would look fine
+        as->loud = 1;
+        error(as, "\"%s\" must only use symbols defined above it", buffer);
+        as->loud = 0;
+        return 0;
+    }
+
+    return 1;
+}
+
+static void emit(struct assembler *as, unsigned char byte)
+{
+    if (as->address > 0x7FFF)
+    {
+        if (as->address == 0x8000)
+            error(as, "code runs past the end of ROM bank %u", as->bank);
+        as->address++;
+        return;
+    }
+
+    if (as->bank == 0 && as->position >= ROM_OFFSET_LOGO && as->position < ROM_HEADER_END)
+        error(as, "code overlaps the cartridge header (0x%04lX)", as->position);
+    if (as->bank == 0 && as->position >= ROM_OFFSET_ENTRY && as->position < ROM_OFFSET_LOGO)
+        as->entryWritten = 1;
+
+    if (as->pass == 2)
+        as->rom[as->position] = byte;
+
+    as->position++;
+    as->address++;
+    if (as->position > as->end)
+        as->end = as->position;
+}
+
+static int isRegister(const char *text)
+{
+    size_t i;
+
+    for (i = 0; i < sizeof(registerNames) / sizeof(registerNames[0]); i++)
+    {
+        if (!strcmp(text, registerNames[i]))
+            return 1;
+    }
+
+    return 0;
+}
+
+/*
+    assembleInstruction
+    ---
+    Find the mnemonic that matches a canonical line. A mnemonic without an operand has to match exactly,
+    otherwise the one with the longest fixed text around the operand wins, so "LDA,(0XFF00+0X44)" is the
+    high RAM load rather than a 16 bit address load of "0XFF00+0X44".
+*/
+static void assembleInstruction(struct assembler *as, char *text)
+{
+    char aliased[MAX_LINE];
+    char operand[MAX_LINE];
+    struct mnemonic *best = NULL;
+    size_t bestLength = 0;
+    size_t length;
+    size_t i;
+    long value;
+
+    for (i = 0; i < sizeof(aliases) / sizeof(aliases[0]); i++)
+    {
+        size_t aliasLength = strlen(aliases[i][0]);
+        if (!strncmp(text, aliases[i][0], aliasLength) && strlen(text) + 16 < sizeof(aliased))
+        {
+            sprintf(aliased, "%s%s", aliases[i][1], text + aliasLength);
+            text = aliased;
+            break;
+        }
+    }
+
+    length = strlen(text);
+    for (i = 0; i < (size_t)mnemonicCount; i++)
+    {
+        struct mnemonic *m = &mnemonics[i];
+        size_t prefixLength = strlen(m->prefix);
+        size_t suffixLength = strlen(m->suffix);
+
+        if (m->operand == OPERAND_NONE || m->operand == OPERAND_ZERO)
+        {
+            if (!strcmp(text, m->prefix))
+            {
+                best = m;
+                break;
+            }
+            continue;
+        }
+
+        if (length <= prefixLength + suffixLength || prefixLength + suffixLength < bestLength)
+            continue;
+        if (strncmp(text, m->prefix, prefixLength) || strcmp(text + length - suffixLength, m->suffix))
+            continue;
+
+        memcpy(operand, text + prefixLength, length - prefixLength - suffixLength);
+        operand[length - prefixLength - suffixLength] = '\0';
+        if (isRegister(operand))
+            continue;
+
+        best = m;
+        bestLength = prefixLength + suffixLength;
+    }
+
+    if (best == NULL)
+    {
+        error(as, "unknown instruction \"%s\"", as->lines[as->line - 1] + strspn(as->lines[as->line - 1], " \t"));
+        return;
+    }
+
+    // Re-cut the operand, the last match tried isn't necessarily the best one
+    if (best->operand != OPERAND_NONE && best->operand != OPERAND_ZERO)
+    {
+        size_t prefixLength = strlen(best->prefix);
+        size_t suffixLength = strlen(best->suffix);
+        memcpy(operand, text + prefixLength, length - prefixLength - suffixLength);
+        operand[length - prefixLength - suffixLength] = '\0';
+    }
+
+    if (best->opcode == 0xCB)
+    {
+        // "CB n" is the whole instruction, not an opcode & operand
+        if (!evaluate(as, operand, &value, NULL))
+            return;
+        if (as->pass == 2 && (value < 0 || value > 0xFF))
+            error(as, "CB opcode 0x%lX out of range", value);
+        emit(as, 0xCB);
+        emit(as, value);
+        return;
+    }
+
+    emit(as, best->opcode);
+
+    switch (best->operand)
+    {
+    case OPERAND_ZERO:
+        emit(as, 0);
+        break;
+
+    case OPERAND_BYTE:
+        if (!evaluate(as, operand, &value, NULL))
+            value = 0;
+        if (as->pass == 2 && (value < -128 || value > 0xFF))
+            error(as, "0x%lX doesn't fit in a byte", value);
+        emit(as, value);
+        break;
+
+    case OPERAND_WORD:
+        if (!evaluate(as, operand, &value, NULL))
+            value = 0;
+        if (as->pass == 2 && (value < -32768 || value > 0xFFFF))
+            error(as, "0x%lX doesn't fit in a word", value);
+        emit(as, value);
+        emit(as, value >> 8);
+        break;
+
+    case OPERAND_RELATIVE:
+        if (!evaluate(as, operand, &value, NULL))
+            value = as->address + 1;
+        value -= as->address + 1; // From the end of the instruction, the opcode is already out
+        if (as->pass == 2 && (value < -128 || value > 127))
+            error(as, "jump target is %ld bytes away, JR reaches -128 to 127", value);
+        emit(as, value);
+        break;
+    }
+}
+
+/*
+    splitList
+    ---
+    Split the operands of .db/.dw at commas, leaving commas inside strings alone. Returns the count.
+*/
+static int splitList(char *text, char **items, int maxItems)
+{
+    int count = 0;
+    char quote = 0;
+
+    while (*text != '\0' && count < maxItems)
+    {
+        while (isspace((unsigned char)*text))
+            text++;
+        items[count++] = text;
+
+        for (; *text != '\0'; text++)
+        {
+            if (quote)
+            {
+                if (*text == quote)
+                    quote = 0;
+            }
+            else if (*text == '"' || (*text == '\'' && text[1] != '\0' && text[2] == '\''))
+                quote = *text;
+            else if (*text == ',')
+                break;
+        }
+
+        if (*text == ',')
+            *text++ = '\0';
+    }
+
+    return count;
+}
+
+static void emitData(struct assembler *as, char *arguments, int width)
+{
+    char *items[128];
+    char buffer[MAX_LINE];
+    int count = splitList(arguments, items, 128);
+    int i;
+
+    for (i = 0; i < count; i++)
+    {
+        long value;
+        char *item = items[i];
+
+        if (width == 1 && item[0] == '"')
+        {
+            for (item++; *item != '\0' && *item != '"'; item++)
+                emit(as, *item);
+            continue;
+        }
+
+        canonical(item, buffer, sizeof(buffer));
+        if (!evaluate(as, buffer, &value, NULL))
+            value = 0;
+
+        if (as->pass == 2 && width == 1 && (value < -128 || value > 0xFF))
+            error(as, "0x%lX doesn't fit in a byte", value);
+        emit(as, value);
+        if (width == 2)
+            emit(as, value >> 8);
+    }
+}
+
+static void processLines(struct assembler *as, int from, int to);
+
+/*
+    findEndr
+    ---
+    Index of the .endr that closes the .rept on line 'from', or -1.
+*/
+static int findEndr(struct assembler *as, int from, int to)
+{
+    int depth = 0;
+    int i;
+
+    for (i = from; i < to; i++)
+    {
+        char word[8] = "";
+        char *p;
+
+        sscanf(as->lines[i], " %7s", word);
+        for (p = word; *p != '\0'; p++)
+            *p = tolower((unsigned char)*p);
+
+        if (!strcmp(word, ".rept"))
+            depth++;
+        else if (!strcmp(word, ".endr") && --depth == 0)
+            return i;
+    }
+
+    return -1;
+}
+
+/*
+    directive
+    ---
+    Handle a line starting with '.'. Returns the line to carry on from (different for .rept).
+*/
+static int directive(struct assembler *as, char *text, int index, int to)
+{
+    char name[16];
+    char *arguments;
+    size_t length = 0;
+    long value;
+
+    while (isSymbolChar(*text) && length + 1 < sizeof(name))
+        name[length++] = tolower((unsigned char)*text++);
+    name[length] = '\0';
+
+    arguments = text;
+    while (isspace((unsigned char)*arguments))
+        arguments++;
+
+    if (!strcmp(name, ".org"))
+    {
+        if (!evaluateNow(as, arguments, &value))
+            return index + 1;
+
+        if (as->bank == 0 ? value < 0 || value > 0x7FFF : value < 0x4000 || value > 0x7FFF)
+            error(as, ".org 0x%lX is outside of ROM bank %u", value, as->bank);
+        else if ((unsigned long)value < as->address)
+            error(as, ".org 0x%lX goes backwards", value);
+        else
+        {
+            as->address = value;
+            as->position = as->bank == 0 ? (unsigned long)value : as->bank * BANK_SIZE + (unsigned long)value - 0x4000;
+        }
+    }
+    else if (!strcmp(name, ".bank"))
+    {
+        if (!evaluateNow(as, arguments, &value))
+            return index + 1;
+
+        if (value < 1 || value >= ASSEMBLER_MAX_BANKS)
+            error(as, "bank %ld out of range (1-%d)", value, ASSEMBLER_MAX_BANKS - 1);
+        else
+        {
+            as->bank = value;
+            as->address = 0x4000;
+            as->position = value * BANK_SIZE;
+            if (as->position > as->end)
+                as->end = as->position;
+        }
+    }
+    else if (!strcmp(name, ".db"))
+        emitData(as, arguments, 1);
+    else if (!strcmp(name, ".dw"))
+        emitData(as, arguments, 2);
+    else if (!strcmp(name, ".ds"))
+    {
+        char *items[2];
+        long fill = 0;
+        int count = splitList(arguments, items, 2);
+
+        if (count == 0 || !evaluateNow(as, items[0], &value))
+            return index + 1;
+        if (count == 2 && !evaluateNow(as, items[1], &fill))
+            return index + 1;
+
+        while (value-- > 0)
+            emit(as, fill);
+    }
+    else if (!strcmp(name, ".rept"))
+    {
+        int endr = findEndr(as, index, to);
+
+        if (endr < 0)
+        {
+            error(as, ".rept without .endr");
+            return to;
+        }
+
+        if (evaluateNow(as, arguments, &value))
+        {
+            while (value-- > 0)
+                processLines(as, index + 1, endr);
+        }
+
+        return endr + 1;
+    }
+    else if (!strcmp(name, ".endr"))
+        error(as, ".endr without .rept");
+    else if (!strcmp(name, ".title"))
+    {
+        char *end = strrchr(arguments, '"');
+
+        if (arguments[0] != '"' || end == arguments || end - arguments - 1 > 16)
+            error(as, ".title needs a quoted name of up to 16 characters");
+        else
+        {
+            memset(as->title, 0, sizeof(as->title));
+            memcpy(as->title, arguments + 1, end - arguments - 1);
+        }
+    }
+    else if (!strcmp(name, ".type") || !strcmp(name, ".ram"))
+    {
+        if (!evaluateNow(as, arguments, &value))
+            return index + 1;
+
+        if (value < 0 || value > 0xFF)
+            error(as, "%s 0x%lX doesn't fit in a byte", name, value);
+        else if (name[1] == 't')
+            as->cartType = value;
+        else
+            as->ramSize = value;
+    }
+    else
+        error(as, "unknown directive \"%s\"", name);
+
+    return index + 1;
+}
+
+/*
+    processLines
+    ---
+    Assemble lines [from, to) for the current pass.
+*/
+static void processLines(struct assembler *as, int from, int to)
+{
+    char buffer[MAX_LINE];
+    char text[MAX_LINE];
+    int index = from;
+
+    while (index < to)
+    {
+        char *start = text;
+        char *p;
+        char quote = 0;
+
+        as->line = index + 1;
+        strncpy(text, as->lines[index], sizeof(text) - 1);
+        text[sizeof(text) - 1] = '\0';
+
+        // Cut the comment off, ignoring ';' in strings
+        for (p = text; *p != '\0'; p++)
+        {
+            if (quote && *p == quote)
+                quote = 0;
+            else if (!quote && (*p == '"' || (*p == '\'' && p[1] != '\0' && p[2] == '\'')))
+                quote = *p;
+            else if (!quote && *p == ';')
+            {
+                *p = '\0';
+                break;
+            }
+        }
+
+        while (isspace((unsigned char)*start))
+            start++;
+
+        // Label
+        p = start;
+        while (isSymbolChar(*p))
+            p++;
+        if (p != start && *p == ':')
+        {
+            *p = '\0';
+            canonical(start, buffer, sizeof(buffer));
+            defineSymbol(as, buffer, as->address, 1);
+            start = p + 1;
+            while (isspace((unsigned char)*start))
+                start++;
+        }
+
+        if (*start == '\0')
+        {
+            index++;
+            continue;
+        }
+
+        if (*start == '.')
+        {
+            index = directive(as, start, index, to);
+            continue;
+        }
+
+        // Constant
+        p = start;
+        while (isSymbolChar(*p))
+            p++;
+        while (isspace((unsigned char)*p))
+            p++;
+        if (*p == '=' && p != start)
+        {
+            long value;
+            char name[MAX_SYMBOL_NAME];
+
+            *p = '\0';
+            canonical(start, name, sizeof(name));
+            if (evaluateNow(as, p + 1, &value))
+                defineSymbol(as, name, value, 0);
+            index++;
+            continue;
+        }
+
+        canonical(start, buffer, sizeof(buffer));
+        assembleInstruction(as, buffer);
+        index++;
+    }
+}
+
+static void runPass(struct assembler *as, int pass)
+{
+    as->pass = pass;
+    as->errors = 0;
+    as->bank = 0;
+    as->address = 0;
+    as->position = 0;
+    as->end = 0;
+    as->entryWritten = 0;
+
+    processLines(as, 0, as->lineCount);
+}
+
+/*
+    writeHeader
+    ---
+    Fill in the entry point (unless the source has its own), the logo, the header fields & both checksums.
+*/
+static void writeHeader(struct assembler *as, unsigned char *rom, size_t size)
+{
+    unsigned char checksum = 0;
+    unsigned short globalChecksum = 0;
+    unsigned char romSizeCode = 0;
+    size_t i;
+
+    if (!as->entryWritten)
+    {
+        static const unsigned char entry[4] = {0x00, 0xC3, ROM_HEADER_END & 0xFF, ROM_HEADER_END >> 8}; // NOP; JP 0x150
+        memcpy(rom + ROM_OFFSET_ENTRY, entry, sizeof(entry));
+    }
+
+    memcpy(rom + ROM_OFFSET_LOGO, nintendoLogo, sizeof(nintendoLogo));
+    memcpy(rom + ROM_OFFSET_NAME, as->title, 16);
+
+    // 32KB << n
+    while (((size_t)0x8000 << romSizeCode) < size)
+        romSizeCode++;
+
+    rom[ROM_OFFSET_TYPE] = as->cartType;
+    rom[ROM_OFFSET_ROM_SIZE] = romSizeCode;
+    rom[ROM_OFFSET_RAM_SIZE] = as->ramSize;
+
+    for (i = ROM_OFFSET_NAME; i < ROM_OFFSET_HEADER_CHECKSUM; i++)
+        checksum = checksum - rom[i] - 1;
+    rom[ROM_OFFSET_HEADER_CHECKSUM] = checksum;
+
+    rom[ROM_OFFSET_GLOBAL_CHECKSUM] = 0;
+    rom[ROM_OFFSET_GLOBAL_CHECKSUM + 1] = 0;
+    for (i = 0; i < size; i++)
+        globalChecksum += rom[i];
+    rom[ROM_OFFSET_GLOBAL_CHECKSUM] = globalChecksum >> 8;
+    rom[ROM_OFFSET_GLOBAL_CHECKSUM + 1] = globalChecksum & 0xFF;
+}
+
+/*
+    assemble
+    ---
+    Assemble 'source' into a cartridge image. On success '*rom' is a malloc'd image of '*size' bytes
+    (a power of 2, 32KB or more) and 1 is returned. Errors are printed as "<sourceName>:<line>: ...".
+*/
+int assemble(const char *source, const char *sourceName, unsigned char **rom, size_t *size)
+{
+    struct assembler *as = calloc(1, sizeof(struct assembler));
+    char *copy = malloc(strlen(source) + 1);
+    char *p;
+    size_t romSize;
+    int result = 0;
+
+    if (as == NULL || copy == NULL)
+    {
+        printf("Out of memory.\n");
+        free(as);
+        free(copy);
+        return 0;
+    }
+
+    loadMnemonics();
+    as->sourceName = sourceName;
+
+    // Split into lines
+    strcpy(copy, source);
+    as->lines = malloc(sizeof(char *) * (strlen(source) + 1));
+    for (p = copy; as->lines != NULL;)
+    {
+        char *end = strchr(p, '\n');
+        as->lines[as->lineCount++] = p;
+        if (end == NULL)
+            break;
+        if (end > p && end[-1] == '\r')
+            end[-1] = '\0';
+        *end = '\0';
+        p = end + 1;
+    }
+
+    if (as->lines == NULL || (as->rom = calloc(ASSEMBLER_MAX_BANKS, BANK_SIZE)) == NULL)
+    {
+        printf("Out of memory.\n");
+        goto done;
+    }
+
+    runPass(as, 1);
+    if (as->errors)
+    {
+        // Pass 1 keeps quiet about errors, run pass 2 for the messages
+        runPass(as, 2);
+        goto done;
+    }
+
+    runPass(as, 2);
+    if (as->errors)
+        goto done;
+
+    romSize = 2 * BANK_SIZE;
+    while (romSize < as->end)
+        romSize *= 2;
+
+    writeHeader(as, as->rom, romSize);
+
+    *rom = realloc(as->rom, romSize);
+    *size = romSize;
+    as->rom = NULL;
+    result = 1;
+
+done:
+    if (as->reported)
+        printf("%s: %d error%s\n", sourceName, as->reported, as->reported == 1 ? "" : "s");
+    free(as->rom);
+    free(as->lines);
+    free(copy);
+    free(as);
+    return result;
+}
@@ -0,0 +1,327 @@
+/*
+    NAME: TMC
+    INIT DATE: 19/10/2026
+    LAST EDIT DATE: 19/10/2026
+    DESC:
+        Breakpoint & watchpoint bitmaps. See 'include/breakpoint.h'.
+*/
+
+#include "../include/breakpoint.h"
+#include "../include/condition.h"
+#include "../include/registers.h"
+#include "../include/memory.h"
+#include "../include/main.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+unsigned char debugActive = 1; // debugModeEnable starts on
+unsigned short watchHitAddress;
+unsigned char watchHitType;
+
+unsigned char breakpointMap[0x10000 / 8];
+unsigned char *bankBreakpointMaps[BREAKPOINT_BANKS];
+unsigned char readWatchMap[0x10000 / 8];
+unsigned char writeWatchMap[0x10000 / 8];
+
+static unsigned int breakpointCount;
+static unsigned int watchpointCount;
+
+// Looked up only once a breakpoint's bit is hit, so a short list is plenty
+struct breakpointCondition
+{
+    unsigned short bank; // 0 outside the switchable bank
+    unsigned short address;
+    struct condition condition;
+};
+
+static struct breakpointCondition conditions[MAX_BREAKPOINT_CONDITIONS];
+static unsigned int conditionCount;
+
+static int isBanked(unsigned short address)
+{
+    return address >= 0x4000 && address <= 0x7FFF;
+}
+
+static struct breakpointCondition *findCondition(unsigned short bank, unsigned short address)
+{
+    unsigned int i;
+
+    if (!isBanked(address))
+        bank = 0;
+
+    for (i = 0; i < conditionCount; i++)
+    {
+        if (conditions[i].address == address && conditions[i].bank == bank)
+            return &conditions[i];
+    }
+
+    return NULL;
+}
+
+static void removeCondition(unsigned short bank, unsigned short address)
+{
+    struct breakpointCondition *condition = findCondition(bank, address);
+
+    if (condition != NULL)
+        *condition = conditions[--conditionCount];
+}
+
+/*
+    setBreakpoint
+    ---
+    Break before the instruction at 'address' runs. 'bank' is only used for the switchable ROM bank
+    (0x4000-0x7FFF). Returns 1 on success.
+*/
+int setBreakpoint(unsigned short bank, unsigned short address)
+{
+    unsigned char *map = breakpointMap;
+
+    if (isBanked(address))
+    {
+        if (bank >= BREAKPOINT_BANKS)
+        {
+            printf("ROM bank %u is out of range for a breakpoint.\n", bank);
+            return 0;
+        }
+
+        if (bankBreakpointMaps[bank] == NULL)
+        {
+            bankBreakpointMaps[bank] = calloc(BREAKPOINT_BANK_BYTES, 1);
+            if (bankBreakpointMaps[bank] == NULL)
+            {
+                printf("Failed to allocate breakpoints for ROM bank %u.\n", bank);
+                return 0;
+            }
+        }
+
+        map = bankBreakpointMaps[bank];
+        address -= 0x4000;
+    }
+
+    if (!BITMAP_TEST(map, address))
+    {
+        BITMAP_SET(map, address);
+        breakpointCount++;
+    }
+
+    removeCondition(bank, map == breakpointMap ? address : address + 0x4000);
+    updateDebugActive();
+    return 1;
+}
+
+/*
+    setConditionalBreakpoint
+    ---
+    Like setBreakpoint, but only break when 'expression' is true. Returns 0 (and sets nothing) if the
+    expression doesn't compile.
+*/
+int setConditionalBreakpoint(unsigned short bank, unsigned short address, const char *expression)
+{
+    struct condition condition;
+    struct breakpointCondition *slot;
+
+    if (!compileCondition(expression, &condition))
+        return 0;
+
+    if (findCondition(bank, address) == NULL && conditionCount == MAX_BREAKPOINT_CONDITIONS)
+    {
+        printf("Too many conditional breakpoints (max %d).\n", MAX_BREAKPOINT_CONDITIONS);
+        return 0;
+    }
+
+    // Drops any old condition on this address
+    if (!setBreakpoint(bank, address))
+        return 0;
+
+    slot = &conditions[conditionCount++];
+    slot->bank = isBanked(address) ? bank : 0;
+    slot->address = address;
+    slot->condition = condition;
+    return 1;
+}
+
+void clearBreakpoint(unsigned short bank, unsigned short address)
+{
+    unsigned char *map = breakpointMap;
+
+    if (isBanked(address))
+    {
+        if (bank >= BREAKPOINT_BANKS || bankBreakpointMaps[bank] == NULL)
+            return;
+
+        map = bankBreakpointMaps[bank];
+        address -= 0x4000;
+    }
+
+    if (BITMAP_TEST(map, address))
+    {
+        BITMAP_CLEAR(map, address);
+        breakpointCount--;
+    }
+
+    removeCondition(bank, map == breakpointMap ? address : address + 0x4000);
+    updateDebugActive();
+}
+
+/*
+    setWatchpoint
+    ---
+    Break when 'address' is read and/or written ('type' is WATCH_READ, WATCH_WRITE or both). Watchpoints
+    see every access through readByte/writeByte, whichever bank is mapped in.
+*/
+int setWatchpoint(unsigned short address, unsigned char type)
+{
+    if ((type & WATCH_READ) && !BITMAP_TEST(readWatchMap, address))
+    {
+        BITMAP_SET(readWatchMap, address);
+        watchpointCount++;
+    }
+
+    if ((type & WATCH_WRITE) && !BITMAP_TEST(writeWatchMap, address))
+    {
+        BITMAP_SET(writeWatchMap, address);
+        watchpointCount++;
+    }
+
+    updateDebugActive();
+    return 1;
+}
+
+void clearWatchpoint(unsigned short address, unsigned char type)
+{
+    if ((type & WATCH_READ) && BITMAP_TEST(readWatchMap, address))
+    {
+        BITMAP_CLEAR(readWatchMap, address);
+        watchpointCount--;
+    }
+
+    if ((type & WATCH_WRITE) && BITMAP_TEST(writeWatchMap, address))
+    {
+        BITMAP_CLEAR(writeWatchMap, address);
+        watchpointCount--;
+    }
+
+    updateDebugActive();
+}
+
+void clearAllBreakpoints(void)
+{
+    int i;
+
+    memset(breakpointMap, 0, sizeof(breakpointMap));
+    memset(readWatchMap, 0, sizeof(readWatchMap));
+    memset(writeWatchMap, 0, sizeof(writeWatchMap));
+
+    for (i = 0; i < BREAKPOINT_BANKS; i++)
+    {
+        free(bankBreakpointMaps[i]);
+        bankBreakpointMaps[i] = NULL;
+    }
+
+    breakpointCount = 0;
+    watchpointCount = 0;
+    conditionCount = 0;
+    updateDebugActive();
+}
+
+/*
+    checkBreakpoint
+    ---
+    Returns non-zero if there is a breakpoint on 'address' in whatever is mapped there right now. Only
+    called while debugActive is set.
+*/
+int checkBreakpoint(unsigned short address)
+{
+    const unsigned char *map = breakpointMap;
+    unsigned short offset = address;
+    const struct breakpointCondition *condition;
+
+    if (isBanked(address))
+    {
+        map = bankBreakpointMaps[romBank];
+        if (map == NULL)
+            return 0;
+
+        offset -= 0x4000;
+    }
+
+    if (!BITMAP_TEST(map, offset))
+        return 0;
+
+    if (conditionCount)
+    {
+        condition = findCondition(romBank, address);
+        if (condition != NULL && !runCondition(&condition->condition))
+            return 0;
+    }
+
+    printf("Breakpoint hit at %02X:%04X.\n", romBank, address);
+    return 1;
+}
+
+/*
+    watchpointHit
+    ---
+    Called by the memory bus when a watched address is accessed. The debug window opens before the next
+    instruction.
+*/
+void watchpointHit(unsigned short address, unsigned char type)
+{
+    // Already stopped on every instruction (this is also how the debug window's own reads get ignored)
+    if (debugModeEnable)
+        return;
+
+    printf("Watchpoint hit: %s 0x%04X (instruction before PC 0x%04X).\n", type == WATCH_READ ? "read" : "write", address, registers.pc);
+    watchHitAddress = address;
+    watchHitType = type;
+    debugModeEnable = 1;
+}
+
+/*
+    updateDebugActive
+    ---
+    Work out whether the CPU & memory bus need to look at any of this. Call after changing any
+    breakpoint, watchpoint or debugModeEnable.
+*/
+void updateDebugActive(void)
+{
+    debugActive = debugModeEnable || breakpointCount || watchpointCount;
+}
+
+/*
+    parseBreakpoint
+    ---
+    Read "address" or "bank:address" (either in hex, with or without 0x). Addresses in the switchable
+    bank default to bank 1. Returns 1 on success.
+*/
+int parseBreakpoint(const char *text, unsigned short *bank, unsigned short *address)
+{
+    const char *colon = strchr(text, ':');
+    char *end;
+    unsigned long value;
+
+    *bank = 1;
+    if (colon != NULL)
+    {
+        value = strtoul(text, &end, 16);
+        if (end != colon || value >= BREAKPOINT_BANKS)
+        {
+            printf("Invalid breakpoint bank in \"%s\".\n", text);
+            return 0;
+        }
+
+        *bank = (unsigned short)value;
+        text = colon + 1;
+    }
+
+    value = strtoul(text, &end, 16);
+    if (end == text || *end != '\0' || value > 0xFFFF)
+    {
+        printf("Invalid breakpoint address \"%s\".\n", text);
+        return 0;
+    }
+
+    *address = (unsigned short)value;
+    return 1;
+}
@@ -0,0 +1,363 @@
+/*
+    NAME: TMC
+    INIT DATE: 19/10/2026
+    LAST EDIT DATE: 19/10/2026
+    DESC:
+        Video & audio capture. See 'include/capture.h'.
+
+        Buffers go round in a circle: the core takes one from 'freeFrames', fills it and puts it in
+        'fullFrames'; the writer thread encodes it and puts it back in 'freeFrames'. Both are the usual
+        single producer / single consumer rings, the semaphores are only there so neither side has to
+        spin while the other catches up.
+*/
+
+#include "../include/capture.h"
+#include "../include/apu.h"
+#include "../include/pacing.h"
+#include <SDL2/SDL.h>
+#include <stdlib.h>
+#include <string.h>
+
+#ifdef _WIN32
+#include <fcntl.h>
+#include <io.h>
+#else
+#include <signal.h>
+#include <unistd.h>
+#endif
+
+struct capture capture;
+
+static SDL_Thread *writerThread;
+static SDL_sem *framesReady; // Posted for every frame put in 'fullFrames', and once to stop
+static SDL_sem *framesFreed; // Posted for every frame put back in 'freeFrames'
+static atomic_int stopping;
+
+// Audio made since the last frame was captured, filled by the APU as it flushes samples
+static short pendingAudio[CAPTURE_AUDIO_SAMPLES * 2];
+static unsigned int pendingSamples;
+
+// Only touched by the writer thread. With a scaler the frame is scaled into 'scaled' before encoding
+static struct scaler scaler;
+static unsigned int *scaled;
+static int width, height;
+static unsigned char *y4mFrame;
+static size_t y4mSize;
+
+/*
+    openOutput
+    ---
+    Open a capture output. "-" is stdout, in which case stdout itself is pointed at stderr so the
+    emulator's printfs don't end up in the stream.
+*/
+static FILE *openOutput(const char *name)
+{
+    FILE *f;
+    int fd;
+
+    if (strcmp(name, "-"))
+    {
+        f = fopen(name, "wb");
+        if (f == NULL)
+            printf("Failed to open capture output \"%s\".\n", name);
+        return f;
+    }
+
+    fflush(stdout);
+#ifdef _WIN32
+    fd = _dup(_fileno(stdout));
+    _dup2(_fileno(stderr), _fileno(stdout));
+    _setmode(fd, _O_BINARY);
+    f = _fdopen(fd, "wb");
+#else
+    fd = dup(fileno(stdout));
+    dup2(fileno(stderr), fileno(stdout));
+    f = fdopen(fd, "wb");
+#endif
+
+    if (f == NULL)
+        printf("Failed to capture to stdout.\n");
+    return f;
+}
+
+/*
+    encodeY4M
+    ---
+    ARGB -> Y'CbCr (BT.601, full range), with chroma averaged over each 2x2 block of pixels.
+*/
+static void encodeY4M(const unsigned int *pixels)
+{
+    int chromaWidth = width / 2, chromaHeight = height / 2;
+    unsigned char *luma = y4mFrame + 6;
+    unsigned char *cb = luma + width * height;
+    unsigned char *cr = cb + chromaWidth * chromaHeight;
+    int x, y;
+
+    memcpy(y4mFrame, "FRAME\n", 6);
+
+    for (y = 0; y < height; y++)
+    {
+        for (x = 0; x < width; x++)
+        {
+            unsigned int pixel = pixels[y * width + x];
+            int r = (pixel >> 16) & 0xFF, g = (pixel >> 8) & 0xFF, b = pixel & 0xFF;
+            luma[y * width + x] = (77 * r + 150 * g + 29 * b + 128) >> 8;
+        }
+    }
+
+    for (y = 0; y < chromaHeight; y++)
+    {
+        for (x = 0; x < chromaWidth; x++)
+        {
+            const unsigned int *p = pixels + y * 2 * width + x * 2;
+            unsigned int quad[4] = {p[0], p[1], p[width], p[width + 1]};
+            int r = 0, g = 0, b = 0, i;
+
+            for (i = 0; i < 4; i++)
+            {
+                r += (quad[i] >> 16) & 0xFF;
+                g += (quad[i] >> 8) & 0xFF;
+                b += quad[i] & 0xFF;
+            }
+
+            // Sums of 4 pixels, so shift by 2 more
+            cb[y * chromaWidth + x] = 128 + ((-43 * r - 85 * g + 128 * b + 512) >> 10);
+            cr[y * chromaWidth + x] = 128 + ((128 * r - 107 * g - 21 * b + 512) >> 10);
+        }
+    }
+}
+
+static void writeFrame(struct captureFrame *frame)
+{
+    if (atomic_load(&capture.failed))
+        return;
+
+    if (capture.video != NULL)
+    {
+        if (scaled != NULL)
+        {
+            scaleFrame(&scaler, frame->pixels, scaled, width);
+            encodeY4M(scaled);
+        }
+        else
+        {
+            encodeY4M(frame->pixels);
+        }
+        if (fwrite(y4mFrame, y4mSize, 1, capture.video) != 1)
+            atomic_store(&capture.failed, 1);
+    }
+
+    if (capture.audio != NULL && frame->audioSamples)
+    {
+        if (fwrite(frame->audio, sizeof(short) * 2, frame->audioSamples, capture.audio) != frame->audioSamples)
+            atomic_store(&capture.failed, 1);
+    }
+}
+
+/*
+    captureWriter
+    ---
+    Writer thread. Runs until told to stop, and writes out every frame still queued before it does.
+*/
+static int captureWriter(void *data)
+{
+    unsigned char index;
+
+    for (;;)
+    {
+        int stop;
+
+        SDL_SemWait(framesReady);
+
+        // Read before emptying the queue, so a frame queued just before stopping is still written
+        stop = atomic_load(&stopping);
+
+        while (ringbufferRead(&capture.fullFrames, &index, 1))
+        {
+            writeFrame(&capture.pool[index]);
+            ringbufferWrite(&capture.freeFrames, &index, 1);
+            SDL_SemPost(framesFreed);
+        }
+
+        if (stop)
+            return 0;
+    }
+}
+
+/*
+    startCapture
+    ---
+    Open the outputs (either name can be NULL), set up the frame pool and start the writer thread.
+    Video is scaled with 'scalerMode' first (SCALER_NONE for the plain 160x144). Returns 1 on success.
+*/
+int startCapture(const char *videoName, const char *audioName, enum captureMode mode, enum scalerMode scalerMode)
+{
+    unsigned char index;
+    char header[128];
+
+    if (videoName != NULL && audioName != NULL && !strcmp(videoName, "-") && !strcmp(audioName, "-"))
+    {
+        printf("Video & audio can't both be captured to stdout.\n");
+        return 0;
+    }
+
+    capture.pool = malloc(sizeof(struct captureFrame) * CAPTURE_POOL_FRAMES);
+    if (capture.pool == NULL ||
+        !ringbufferInit(&capture.freeFrames, 1, CAPTURE_POOL_FRAMES) ||
+        !ringbufferInit(&capture.fullFrames, 1, CAPTURE_POOL_FRAMES))
+    {
+        printf("Failed to allocate the capture buffers.\n");
+        return 0;
+    }
+    for (index = 0; index < CAPTURE_POOL_FRAMES; index++)
+        ringbufferWrite(&capture.freeFrames, &index, 1);
+
+    if (!initScaler(&scaler, scalerMode))
+    {
+        printf("Failed to allocate the capture buffers.\n");
+        return 0;
+    }
+    width = SCREEN_WIDTH * scaler.factor;
+    height = SCREEN_HEIGHT * scaler.factor;
+    y4mSize = 6 + width * height + (width / 2) * (height / 2) * 2;
+    y4mFrame = malloc(y4mSize);
+    if (scalerMode != SCALER_NONE)
+        scaled = malloc(width * height * sizeof(scaled[0]));
+    if (y4mFrame == NULL || (scalerMode != SCALER_NONE && scaled == NULL))
+    {
+        printf("Failed to allocate the capture buffers.\n");
+        return 0;
+    }
+
+    if (videoName != NULL && (capture.video = openOutput(videoName)) == NULL)
+        return 0;
+    if (audioName != NULL && (capture.audio = openOutput(audioName)) == NULL)
+        return 0;
+
+#ifndef _WIN32
+    // A reader that goes away should stop the capture, not kill the emulator
+    signal(SIGPIPE, SIG_IGN);
+#endif
+
+    if (capture.video != NULL)
+    {
+        // ~59.73fps, the exact rate of the LCD
+        sprintf(header, "YUV4MPEG2 W%d H%d F%d:%d Ip A1:1 C420jpeg\n", width, height, APU_CLOCK_RATE, FRAME_TICKS);
+        fputs(header, capture.video);
+    }
+
+    framesReady = SDL_CreateSemaphore(0);
+    framesFreed = SDL_CreateSemaphore(0);
+    atomic_store(&stopping, 0);
+    writerThread = SDL_CreateThread(captureWriter, "capture", NULL);
+    if (writerThread == NULL)
+    {
+        printf("Failed to start the capture thread: %s\n", SDL_GetError());
+        return 0;
+    }
+
+    capture.mode = mode;
+    capture.enabled = 1;
+    return 1;
+}
+
+/*
+    captureAudio
+    ---
+    Emulation thread. Keep samples the APU has just made until the frame they belong to is captured.
+*/
+void captureAudio(const short *samples, size_t count)
+{
+    if (capture.audio == NULL)
+        return;
+
+    if (count > CAPTURE_AUDIO_SAMPLES - pendingSamples)
+        count = CAPTURE_AUDIO_SAMPLES - pendingSamples;
+
+    memcpy(pendingAudio + pendingSamples * 2, samples, count * sizeof(short) * 2);
+    pendingSamples += count;
+}
+
+/*
+    captureFrame
+    ---
+    Emulation thread, once per frame after the audio for it has been flushed. Copies the frame into a
+    free buffer and queues it for the writer.
+*/
+void captureFrame(const unsigned int *pixels)
+{
+    unsigned char index;
+    struct captureFrame *frame;
+
+    if (!ringbufferRead(&capture.freeFrames, &index, 1))
+    {
+        int found = 0;
+
+        if (capture.mode == CAPTURE_WAIT)
+        {
+            Uint32 start = SDL_GetTicks();
+            Uint32 waited;
+
+            // Old posts can wake this up with nothing free yet, so keep going until the time is up
+            while (!found && (waited = SDL_GetTicks() - start) < CAPTURE_WAIT_MS)
+            {
+                SDL_SemWaitTimeout(framesFreed, CAPTURE_WAIT_MS - waited);
+                found = ringbufferRead(&capture.freeFrames, &index, 1);
+            }
+        }
+
+        if (!found)
+        {
+            capture.dropped++;
+            pendingSamples = 0;
+            return;
+        }
+    }
+
+    frame = &capture.pool[index];
+    if (capture.video != NULL)
+        memcpy(frame->pixels, pixels, sizeof(frame->pixels));
+    memcpy(frame->audio, pendingAudio, pendingSamples * sizeof(short) * 2);
+    frame->audioSamples = pendingSamples;
+    pendingSamples = 0;
+
+    ringbufferWrite(&capture.fullFrames, &index, 1);
+    SDL_SemPost(framesReady);
+    capture.frames++;
+}
+
+/*
+    stopCapture
+    ---
+    Let the writer finish what's queued, then close everything.
+*/
+void stopCapture(void)
+{
+    if (!capture.enabled)
+        return;
+
+    capture.enabled = 0;
+    atomic_store(&stopping, 1);
+    SDL_SemPost(framesReady);
+    SDL_WaitThread(writerThread, NULL);
+
+    if (capture.video != NULL)
+        fclose(capture.video);
+    if (capture.audio != NULL)
+        fclose(capture.audio);
+
+    printf("Captured %lu frames, dropped %lu%s.\n", capture.frames, capture.dropped,
+           atomic_load(&capture.failed) ? " (the output stopped accepting data)" : "");
+
+    SDL_DestroySemaphore(framesReady);
+    SDL_DestroySemaphore(framesFreed);
+    ringbufferFree(&capture.freeFrames);
+    ringbufferFree(&capture.fullFrames);
+    free(capture.pool);
+    capture.pool = NULL;
+    free(y4mFrame);
+    y4mFrame = NULL;
+    free(scaled);
+    scaled = NULL;
+    freeScaler(&scaler);
+}
@@ -0,0 +1,250 @@
+/*
+    NAME: TMC
+    INIT DATE: 19/10/2026
+    LAST EDIT DATE: 19/10/2026
+    DESC:
+        Game Boy Color registers, banking, double speed & HDMA. See 'include/cgb.h'.
+*/
+
+#include "../include/cgb.h"
+#include "../include/memory.h"
+#include "../include/gpu.h"
+#include "../include/cpu.h"
+#include "../include/palette.h"
+#include "../include/rom.h"
+#include <stdio.h>
+#include <string.h>
+
+struct cgb cgb;
+
+/*
+    selectModel
+    ---
+    CGB mode if the loaded ROM supports it. A CGB only ROM gets it even with --dmg ('dmg'), it
+    wouldn't run otherwise.
+*/
+void selectModel(unsigned char dmg)
+{
+    cgb.enabled = (cartCgb & ROM_CGB_ENHANCED) && (!dmg || (cartCgb & ROM_CGB_ONLY) == ROM_CGB_ONLY);
+    printf("Running as a %s.\n", cgb.enabled ? "CGB" : "DMG");
+}
+
+void cgbReset(void)
+{
+    cgb.doubleSpeed = 0;
+    cgb.speedArmed = 0;
+    cgb.vbk = 0;
+    cgb.svbk = 1;
+
+    // The boot ROM leaves every colour white
+    cgb.paletteIndex[0] = 0;
+    cgb.paletteIndex[1] = 0;
+    memset(cgb.paletteRam, 0xFF, sizeof(cgb.paletteRam));
+
+    cgb.hdmaSource = 0;
+    cgb.hdmaDestination = 0;
+    cgb.hdmaBlocks = 0;
+    cgb.hdmaActive = 0;
+
+    mapCgbBanks();
+}
+
+/*
+    mapCgbBanks
+    ---
+    Point 'vramBank' and 'wramBank' at the banks VBK and SVBK select. Also needed after loading a
+    state. A DMG always has VRAM bank 0 and WRAM bank 1, which is what 'cgbReset' leaves them as.
+*/
+void mapCgbBanks(void)
+{
+    vramBank = vram + cgb.vbk * 0x2000;
+    wramBank = wram + cgb.svbk * 0x1000;
+}
+
+/*
+    hdmaSource
+    ---
+    Where a 16 byte HDMA block at 'address' comes from. Blocks start on a 16 byte boundary, so one
+    never crosses from one memory area into another. VRAM & 0xE000 - 0xFFFF aren't valid sources and
+    read as 0xFF.
+*/
+static const unsigned char *hdmaSource(unsigned short address)
+{
+    static const unsigned char open[CGB_HDMA_BLOCK] = {0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF,
+                                                       0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF};
+
+    if (address <= 0x3FFF)
+        return cart + address;
+    if (address <= 0x7FFF)
+        return cart + romBank * 0x4000 + (address - 0x4000);
+    if (address >= 0xA000 && address <= 0xBFFF)
+        return sram + (address - 0xA000);
+    if (address >= 0xC000 && address <= 0xCFFF)
+        return wram + (address - 0xC000);
+    if (address >= 0xD000 && address <= 0xDFFF)
+        return wramBank + (address - 0xD000);
+
+    return open;
+}
+
+// Copy the next HDMA block into the VRAM bank VBK selects
+static void hdmaBlock(void)
+{
+    unsigned short offset = (unsigned short)(vramBank - vram) + cgb.hdmaDestination;
+    int row;
+
+    memcpy(vram + offset, hdmaSource(cgb.hdmaSource), CGB_HDMA_BLOCK);
+
+    // 8 tile rows, unless it went into the tile maps
+    if (cgb.hdmaDestination < 0x1800)
+    {
+        for (row = 0; row < CGB_HDMA_BLOCK; row += 2)
+            updateTile(offset + row);
+    }
+
+    cgb.hdmaSource += CGB_HDMA_BLOCK;
+    cgb.hdmaDestination = (cgb.hdmaDestination + CGB_HDMA_BLOCK) & 0x1FF0;
+}
+
+// Write a colour palette data register, BCPD or OCPD
+static void writePaletteData(int sprites, unsigned char value)
+{
+    unsigned char index = cgb.paletteIndex[sprites] & 0x3F;
+
+    cgb.paletteRam[sprites][index] = value;
+    writeColourPalette(sprites, index >> 1);
+
+    if (cgb.paletteIndex[sprites] & CGB_PALETTE_AUTOINCREMENT)
+        cgb.paletteIndex[sprites] = CGB_PALETTE_AUTOINCREMENT | ((index + 1) & 0x3F);
+}
+
+/*
+    readCgb
+    ---
+    The CGB only registers, only called in CGB mode (see CGB_REGISTER).
+*/
+unsigned char readCgb(unsigned short address)
+{
+    switch (address)
+    {
+    case 0xFF4D:
+        return 0x7E | (cgb.doubleSpeed << 7) | cgb.speedArmed;
+    case 0xFF4F:
+        return 0xFE | cgb.vbk;
+    case 0xFF55:
+        // Bit 7 is set when no HBLANK DMA is running, the rest is the blocks left minus 1 (so 0xFF when done)
+        return (cgb.hdmaActive ? 0x00 : 0x80) | ((cgb.hdmaBlocks - 1) & 0x7F);
+    case 0xFF68:
+    case 0xFF6A:
+        return cgb.paletteIndex[(address - 0xFF68) >> 1] | 0x40;
+    case 0xFF69:
+    case 0xFF6B:
+    {
+        int sprites = (address - 0xFF68) >> 1;
+        return cgb.paletteRam[sprites][cgb.paletteIndex[sprites] & 0x3F];
+    }
+    case 0xFF70:
+        return 0xF8 | cgb.svbk;
+    }
+
+    return 0xFF; // HDMA1 - HDMA4 are write only
+}
+
+void writeCgb(unsigned short address, unsigned char value)
+{
+    switch (address)
+    {
+    case 0xFF4D:
+        cgb.speedArmed = value & CGB_KEY1_ARMED;
+        break;
+
+    case 0xFF4F:
+        cgb.vbk = value & 1;
+        mapCgbBanks();
+        break;
+
+    case 0xFF51:
+        cgb.hdmaSource = (cgb.hdmaSource & 0x00FF) | (value << 8);
+        break;
+    case 0xFF52:
+        cgb.hdmaSource = (cgb.hdmaSource & 0xFF00) | (value & 0xF0);
+        break;
+    case 0xFF53:
+        cgb.hdmaDestination = (cgb.hdmaDestination & 0x00FF) | ((value & 0x1F) << 8);
+        break;
+    case 0xFF54:
+        cgb.hdmaDestination = (cgb.hdmaDestination & 0xFF00) | (value & 0xF0);
+        break;
+
+    case 0xFF55:
+        // Writing bit 7 clear while an HBLANK DMA runs stops it
+        if (cgb.hdmaActive && !(value & CGB_HDMA_HBLANK))
+        {
+            cgb.hdmaActive = 0;
+            break;
+        }
+
+        cgb.hdmaBlocks = (value & 0x7F) + 1;
+
+        if (value & CGB_HDMA_HBLANK)
+        {
+            cgb.hdmaActive = 1;
+        }
+        else
+        {
+            // General purpose: all of it now, with the CPU held up until it's done
+            ticks += cgb.hdmaBlocks * CGB_HDMA_BLOCK_TICKS;
+            while (cgb.hdmaBlocks)
+            {
+                hdmaBlock();
+                cgb.hdmaBlocks--;
+            }
+        }
+        break;
+
+    case 0xFF68:
+    case 0xFF6A:
+        cgb.paletteIndex[(address - 0xFF68) >> 1] = value & 0xBF;
+        break;
+    case 0xFF69:
+    case 0xFF6B:
+        writePaletteData((address - 0xFF68) >> 1, value);
+        break;
+
+    case 0xFF70:
+        cgb.svbk = (value & 7) ? (value & 7) : 1; // Bank 0 can't be put at 0xD000
+        mapCgbBanks();
+        break;
+    }
+}
+
+/*
+    cgbSpeedSwitch
+    ---
+    STOP was run. Switch speed and return 1 if KEY1 was armed for it. The pause while the clock
+    settles isn't emulated.
+*/
+int cgbSpeedSwitch(void)
+{
+    if (!cgb.enabled || !cgb.speedArmed)
+        return 0;
+
+    cgb.doubleSpeed ^= 1;
+    cgb.speedArmed = 0;
+    return 1;
+}
+
+/*
+    cgbHblank
+    ---
+    HBLANK has started on a visible line. Move the next block of an HBLANK DMA, which holds the CPU
+    up just like a general purpose block.
+*/
+void cgbHblank(void)
+{
+    hdmaBlock();
+    ticks += CGB_HDMA_BLOCK_TICKS;
+
+    if (--cgb.hdmaBlocks == 0)
+        cgb.hdmaActive = 0;
+}
@@ -0,0 +1,523 @@
+/*
+    NAME: TMC
+    INIT DATE: 19/10/2026
+    LAST EDIT DATE: 19/10/2026
+    DESC:
+        Breakpoint condition compiler & VM. See 'include/condition.h'.
+
+        The compiler is a plain recursive descent parser that writes bytecode as it goes. The binary
+        operators share one function, driven by a precedence table. && and || jump over their right
+        hand side when the left hand side already decides the result.
+*/
+
+#include "../include/condition.h"
+#include "../include/registers.h"
+#include "../include/memory.h"
+#include "../include/cpu.h"
+#include "../include/gpu.h"
+#include <ctype.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+enum conditionOp
+{
+    OP_END,
+    OP_CONST,    // 4 byte little endian value follows
+    OP_VARIABLE, // 1 byte variable id follows
+    OP_READ,     // Replace the address on top of the stack with the byte at that address
+    OP_NOT,
+    OP_BITNOT,
+    OP_NEGATE,
+    OP_MUL,
+    OP_DIV,
+    OP_MOD,
+    OP_ADD,
+    OP_SUB,
+    OP_SHL,
+    OP_SHR,
+    OP_LT,
+    OP_LE,
+    OP_GT,
+    OP_GE,
+    OP_EQ,
+    OP_NE,
+    OP_AND,
+    OP_XOR,
+    OP_OR,
+    OP_JUMP_FALSE, // 2 byte target follows. If the top is 0 jump (leaving the 0), otherwise pop it.
+    OP_JUMP_TRUE,  // 2 byte target follows. If the top isn't 0 jump (leaving a 1), otherwise pop it.
+    OP_BOOL,       // Top becomes 0 or 1
+};
+
+enum conditionVariable
+{
+    VAR_A,
+    VAR_F,
+    VAR_B,
+    VAR_C,
+    VAR_D,
+    VAR_E,
+    VAR_H,
+    VAR_L,
+    VAR_AF,
+    VAR_BC,
+    VAR_DE,
+    VAR_HL,
+    VAR_SP,
+    VAR_PC,
+    VAR_LY,
+    VAR_LCDC,
+    VAR_SCX,
+    VAR_SCY,
+    VAR_MODE,
+    VAR_STAT,
+    VAR_LYC,
+    VAR_WX,
+    VAR_WY,
+    VAR_TICKS,
+    VAR_BANK,
+};
+
+static const struct
+{
+    const char *name;
+    unsigned char id;
+} variables[] = {
+    {"A", VAR_A}, {"F", VAR_F}, {"B", VAR_B}, {"C", VAR_C}, {"D", VAR_D}, {"E", VAR_E}, {"H", VAR_H}, {"L", VAR_L},
+    {"AF", VAR_AF}, {"BC", VAR_BC}, {"DE", VAR_DE}, {"HL", VAR_HL}, {"SP", VAR_SP}, {"PC", VAR_PC},
+    {"LY", VAR_LY}, {"LCDC", VAR_LCDC}, {"SCX", VAR_SCX}, {"SCY", VAR_SCY}, {"MODE", VAR_MODE},
+    {"STAT", VAR_STAT}, {"LYC", VAR_LYC}, {"WX", VAR_WX}, {"WY", VAR_WY},
+    {"TICKS", VAR_TICKS}, {"BANK", VAR_BANK},
+};
+
+struct compiler
+{
+    const char *text;
+    const char *position;
+    struct condition *condition;
+    int depth;  // Current VM stack depth
+    int failed; // Only the first error is reported
+};
+
+/*
+    COMPILER
+*/
+
+static void compileError(struct compiler *compiler, const char *message)
+{
+    if (compiler->failed)
+        return;
+
+    printf("Condition error at column %d of \"%s\": %s\n", (int)(compiler->position - compiler->text) + 1, compiler->text, message);
+    compiler->failed = 1;
+}
+
+static void emit(struct compiler *compiler, unsigned char byte)
+{
+    if (compiler->condition->length >= CONDITION_MAX_CODE)
+    {
+        compileError(compiler, "condition is too long");
+        return;
+    }
+
+    compiler->condition->code[compiler->condition->length++] = byte;
+}
+
+// Account for a value being pushed (or popped, with a negative 'change')
+static void stackChange(struct compiler *compiler, int change)
+{
+    compiler->depth += change;
+    if (compiler->depth > CONDITION_STACK)
+        compileError(compiler, "condition is nested too deeply");
+}
+
+static void emitConstant(struct compiler *compiler, unsigned int value)
+{
+    emit(compiler, OP_CONST);
+    emit(compiler, value & 0xFF);
+    emit(compiler, (value >> 8) & 0xFF);
+    emit(compiler, (value >> 16) & 0xFF);
+    emit(compiler, (value >> 24) & 0xFF);
+    stackChange(compiler, 1);
+}
+
+// Binary operators take two values and leave one
+static void emitBinary(struct compiler *compiler, unsigned char op)
+{
+    emit(compiler, op);
+    stackChange(compiler, -1);
+}
+
+static void skipSpaces(struct compiler *compiler)
+{
+    while (isspace((unsigned char)*compiler->position))
+        compiler->position++;
+}
+
+// Consume 'token' if it is next. Single character tokens won't match the start of a longer one.
+static int accept(struct compiler *compiler, const char *token)
+{
+    size_t length = strlen(token);
+
+    skipSpaces(compiler);
+    if (strncmp(compiler->position, token, length))
+        return 0;
+
+    // Don't mistake '<' for '<<' or '<=', '&' for '&&' etc.
+    if (length == 1)
+    {
+        char next = compiler->position[1];
+
+        if ((token[0] == '<' || token[0] == '>') && (next == token[0] || next == '='))
+            return 0;
+        if ((token[0] == '&' || token[0] == '|') && next == token[0])
+            return 0;
+        if (token[0] == '!' && next == '=')
+            return 0;
+    }
+
+    compiler->position += length;
+    return 1;
+}
+
+static void compileOr(struct compiler *compiler);
+
+static void compilePrimary(struct compiler *compiler)
+{
+    char name[8];
+    char *end;
+    int length = 0;
+    int i;
+
+    skipSpaces(compiler);
+
+    if (accept(compiler, "("))
+    {
+        compileOr(compiler);
+        if (!accept(compiler, ")"))
+            compileError(compiler, "expected ')'");
+        return;
+    }
+
+    if (accept(compiler, "["))
+    {
+        compileOr(compiler);
+        if (!accept(compiler, "]"))
+            compileError(compiler, "expected ']'");
+        emit(compiler, OP_READ);
+        return;
+    }
+
+    // Numbers: decimal, 0x.. or $..
+    if (*compiler->position == '$')
+    {
+        emitConstant(compiler, strtoul(compiler->position + 1, &end, 16));
+        if (end == compiler->position + 1)
+            compileError(compiler, "expected a hex number after '$'");
+        compiler->position = end;
+        return;
+    }
+
+    if (isdigit((unsigned char)*compiler->position))
+    {
+        if (compiler->position[0] == '0' && (compiler->position[1] == 'x' || compiler->position[1] == 'X'))
+            emitConstant(compiler, strtoul(compiler->position + 2, &end, 16));
+        else
+            emitConstant(compiler, strtoul(compiler->position, &end, 10));
+        compiler->position = end;
+        return;
+    }
+
+    // Register or machine variable
+    while (isalnum((unsigned char)compiler->position[length]))
+    {
+        if (length < (int)sizeof(name) - 1)
+            name[length] = toupper((unsigned char)compiler->position[length]);
+        length++;
+    }
+    name[length < (int)sizeof(name) ? length : (int)sizeof(name) - 1] = '\0';
+
+    if (length == 0)
+    {
+        compileError(compiler, "expected a number, register, '(' or '['");
+        return;
+    }
+
+    for (i = 0; i < (int)(sizeof(variables) / sizeof(variables[0])); i++)
+    {
+        if (length < (int)sizeof(name) && !strcmp(name, variables[i].name))
+        {
+            emit(compiler, OP_VARIABLE);
+            emit(compiler, variables[i].id);
+            stackChange(compiler, 1);
+            compiler->position += length;
+            return;
+        }
+    }
+
+    compileError(compiler, "unknown name");
+}
+
+static void compileUnary(struct compiler *compiler)
+{
+    if (accept(compiler, "!"))
+    {
+        compileUnary(compiler);
+        emit(compiler, OP_NOT);
+    }
+    else if (accept(compiler, "~"))
+    {
+        compileUnary(compiler);
+        emit(compiler, OP_BITNOT);
+    }
+    else if (accept(compiler, "-"))
+    {
+        compileUnary(compiler);
+        emit(compiler, OP_NEGATE);
+    }
+    else
+        compilePrimary(compiler);
+}
+
+// Binary operators from loosest to tightest binding. Longer tokens come first so '<=' isn't read as '<'.
+#define BINARY_LEVELS 8
+static const struct
+{
+    const char *token;
+    unsigned char op;
+} binaryOperators[BINARY_LEVELS][5] = {
+    {{"|", OP_OR}},
+    {{"^", OP_XOR}},
+    {{"&", OP_AND}},
+    {{"==", OP_EQ}, {"!=", OP_NE}},
+    {{"<=", OP_LE}, {">=", OP_GE}, {"<", OP_LT}, {">", OP_GT}},
+    {{"<<", OP_SHL}, {">>", OP_SHR}},
+    {{"+", OP_ADD}, {"-", OP_SUB}},
+    {{"*", OP_MUL}, {"/", OP_DIV}, {"%", OP_MOD}},
+};
+
+static void compileBinary(struct compiler *compiler, int level)
+{
+    int i;
+
+    if (level == BINARY_LEVELS)
+    {
+        compileUnary(compiler);
+        return;
+    }
+
+    compileBinary(compiler, level + 1);
+    while (!compiler->failed)
+    {
+        for (i = 0; binaryOperators[level][i].token != NULL; i++)
+        {
+            if (accept(compiler, binaryOperators[level][i].token))
+                break;
+        }
+
+        if (binaryOperators[level][i].token == NULL)
+            break;
+
+        compileBinary(compiler, level + 1);
+        emitBinary(compiler, binaryOperators[level][i].op);
+    }
+}
+
+static void compileBitwise(struct compiler *compiler)
+{
+    compileBinary(compiler, 0);
+}
+
+/*
+    compileLogical
+    ---
+    Shared by && and ||. Emits the jump with a placeholder target, then patches it once the right hand
+    side's length is known.
+*/
+static void compileLogical(struct compiler *compiler, const char *token, unsigned char jump, void (*operand)(struct compiler *))
+{
+    unsigned short patch;
+    unsigned short target;
+
+    operand(compiler);
+    while (!compiler->failed && accept(compiler, token))
+    {
+        emit(compiler, jump);
+        patch = compiler->condition->length;
+        emit(compiler, 0);
+        emit(compiler, 0);
+        stackChange(compiler, -1); // Popped when not jumping, the right hand side replaces it
+
+        operand(compiler);
+        emit(compiler, OP_BOOL);
+
+        target = compiler->condition->length;
+        if (!compiler->failed)
+        {
+            compiler->condition->code[patch] = target & 0xFF;
+            compiler->condition->code[patch + 1] = target >> 8;
+        }
+    }
+}
+
+static void compileAnd(struct compiler *compiler)
+{
+    compileLogical(compiler, "&&", OP_JUMP_FALSE, compileBitwise);
+}
+
+static void compileOr(struct compiler *compiler)
+{
+    compileLogical(compiler, "||", OP_JUMP_TRUE, compileAnd);
+}
+
+/*
+    compileCondition
+    ---
+    Compile 'text' into 'condition'. Prints what went wrong and returns 0 if it isn't a valid condition.
+*/
+int compileCondition(const char *text, struct condition *condition)
+{
+    struct compiler compiler = {text, text, condition, 0, 0};
+
+    condition->length = 0;
+    compileOr(&compiler);
+
+    skipSpaces(&compiler);
+    if (*compiler.position != '\0')
+        compileError(&compiler, "unexpected character");
+
+    emit(&compiler, OP_END);
+    return !compiler.failed;
+}
+
+/*
+    VM
+*/
+
+static unsigned int readVariable(unsigned char id)
+{
+    switch (id)
+    {
+    case VAR_A: return registers.a;
+    case VAR_F: return registers.f;
+    case VAR_B: return registers.b;
+    case VAR_C: return registers.c;
+    case VAR_D: return registers.d;
+    case VAR_E: return registers.e;
+    case VAR_H: return registers.h;
+    case VAR_L: return registers.l;
+    case VAR_AF: return registers.af;
+    case VAR_BC: return registers.bc;
+    case VAR_DE: return registers.de;
+    case VAR_HL: return registers.hl;
+    case VAR_SP: return registers.sp;
+    case VAR_PC: return registers.pc;
+    case VAR_LY: return gpu.scanline;
+    case VAR_LCDC: return gpu.control;
+    case VAR_SCX: return gpu.scrollX;
+    case VAR_SCY: return gpu.scrollY;
+    case VAR_MODE: return gpu.mode;
+    case VAR_STAT: return readStatus();
+    case VAR_LYC: return gpu.lyCompare;
+    case VAR_WX: return gpu.windowX;
+    case VAR_WY: return gpu.windowY;
+    case VAR_TICKS: return (unsigned int)ticks;
+    case VAR_BANK: return romBank;
+    }
+
+    return 0;
+}
+
+/*
+    runCondition
+    ---
+    Evaluate a compiled condition against the machine as it is now. Non-zero means the breakpoint
+    should fire. Division by zero gives 0 rather than crashing the emulator.
+*/
+unsigned int runCondition(const struct condition *condition)
+{
+    unsigned int stack[CONDITION_STACK];
+    unsigned int *top = stack - 1;
+    const unsigned char *code = condition->code;
+    const unsigned char *ip = code;
+    unsigned int right;
+
+    for (;;)
+    {
+        switch (*ip++)
+        {
+        case OP_END:
+            return *top;
+
+        case OP_CONST:
+            *++top = ip[0] | (ip[1] << 8) | (ip[2] << 16) | ((unsigned int)ip[3] << 24);
+            ip += 4;
+            break;
+
+        case OP_VARIABLE:
+            *++top = readVariable(*ip++);
+            break;
+
+        case OP_READ:
+            *top = peekByte((unsigned short)*top);
+            break;
+
+        case OP_NOT: *top = !*top; break;
+        case OP_BITNOT: *top = ~*top; break;
+        case OP_NEGATE: *top = -*top; break;
+        case OP_BOOL: *top = *top != 0; break;
+
+        case OP_DIV:
+            right = *top--;
+            *top = right ? *top / right : 0;
+            break;
+
+        case OP_MOD:
+            right = *top--;
+            *top = right ? *top % right : 0;
+            break;
+
+        case OP_MUL: right = *top--; *top *= right; break;
+        case OP_ADD: right = *top--; *top += right; break;
+        case OP_SUB: right = *top--; *top -= right; break;
+        case OP_SHL: right = *top--; *top = right < 32 ? *top << right : 0; break;
+        case OP_SHR: right = *top--; *top = right < 32 ? *top >> right : 0; break;
+        case OP_LT: right = *top--; *top = *top < right; break;
+        case OP_LE: right = *top--; *top = *top <= right; break;
+        case OP_GT: right = *top--; *top = *top > right; break;
+        case OP_GE: right = *top--; *top = *top >= right; break;
+        case OP_EQ: right = *top--; *top = *top == right; break;
+        case OP_NE: right = *top--; *top = *top != right; break;
+        case OP_AND: right = *top--; *top &= right; break;
+        case OP_XOR: right = *top--; *top ^= right; break;
+        case OP_OR: right = *top--; *top |= right; break;
+
+        case OP_JUMP_FALSE:
+            if (*top == 0)
+                ip = code + (ip[0] | (ip[1] << 8));
+            else
+            {
+                top--;
+                ip += 2;
+            }
+            break;
+
+        case OP_JUMP_TRUE:
+            if (*top != 0)
+            {
+                *top = 1;
+                ip = code + (ip[0] | (ip[1] << 8));
+            }
+            else
+            {
+                top--;
+                ip += 2;
+            }
+            break;
+
+        default:
+            return 0;
+        }
+    }
+}
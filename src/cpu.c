@@ -11,6 +11,9 @@
 
 		The instruction struct & the time lookup were originally taken from the open-source
 		Cinoop emulator.
+
+		The instructions themselves, and stepping through them, are in 'include/cpucore.inc', which is
+		compiled once for each accuracy tier at the bottom of this file.
 */
 
 #include "../include/cpu.h"
@@ -21,6 +24,16 @@
 #include "../include/interupts.h"
 #include "../include/keys.h"
 #include "../include/gpu.h"
+#include "../include/apu.h"
+#include "../include/trace.h"
+#include "../include/breakpoint.h"
+#include "../include/gdbstub.h"
+#include "../include/serial.h"
+#include "../include/testrom.h"
+#include "../include/palette.h"
+#include "../include/cgb.h"
+#include "../include/ppu.h"
+#include "../include/cputest.h"
 #include <stdlib.h>
 #include <stdio.h>
 #include <string.h>
@@ -29,262 +42,9 @@ struct registers registers;
 unsigned int lastOpperand;
 
 const struct instruction instructions[256] = {
-	{"NOP", 0, nop},							// 0x00
-	{"LD BC, 0x%04X", 2, ld_bc_nn},				// 0x01
-	{"LD (BC), A", 0, ld_bcp_a},				// 0x02
-	{"INC BC", 0, undefined},					// 0x03
-	{"INC B", 0, undefined},					// 0x04
-	{"DEC B", 0, dec_b},						// 0x05
-	{"LD B, 0x%02X", 1, ld_b_n},				// 0x06
-	{"RLCA", 0, undefined},						// 0x07
-	{"LD (0x%04X), SP", 2, undefined},			// 0x08
-	{"ADD HL, BC", 0, undefined},				// 0x09
-	{"LD A, (BC)", 0, undefined},				// 0x0a
-	{"DEC BC", 0, dec_bc},						// 0x0b
-	{"INC C", 0, inc_c},						// 0x0c
-	{"DEC C", 0, dec_c},						// 0x0d
-	{"LD C, 0x%02X", 1, ld_c_n},				// 0x0e
-	{"RRCA", 0, undefined},						// 0x0f
-	{"STOP", 1, undefined},						// 0x10
-	{"LD DE, 0x%04X", 2, ld_de_nn},				// 0x11
-	{"LD (DE), A", 0, undefined},				// 0x12
-	{"INC DE", 0, undefined},					// 0x13
-	{"INC D", 0, undefined},					// 0x14
-	{"DEC D", 0, undefined},					// 0x15
-	{"LD D, 0x%02X", 1, undefined},				// 0x16
-	{"RLA", 0, undefined},						// 0x17
-	{"JR 0x%02X", 1, undefined},				// 0x18
-	{"ADD HL, DE", 0, undefined},				// 0x19
-	{"LD A, (DE)", 0, undefined},				// 0x1a
-	{"DEC DE", 0, undefined},					// 0x1b
-	{"INC E", 0, undefined},					// 0x1c
-	{"DEC E", 0, undefined},					// 0x1d
-	{"LD E, 0x%02X", 1, undefined},				// 0x1e
-	{"RRA", 0, undefined},						// 0x1f
-	{"JR NZ, 0x%02X", 1, jr_nz_n},				// 0x20
-	{"LD HL, 0x%04X", 2, ld_hl_nn},				// 0x21
-	{"LDI (HL), A", 0, undefined},				// 0x22
-	{"INC HL", 0, undefined},					// 0x23
-	{"INC H", 0, undefined},					// 0x24
-	{"DEC H", 0, undefined},					// 0x25
-	{"LD H, 0x%02X", 1, undefined},				// 0x26
-	{"DAA", 0, undefined},						// 0x27
-	{"JR Z, 0x%02X", 1, undefined},				// 0x28
-	{"ADD HL, HL", 0, undefined},				// 0x29
-	{"LDI A, (HL)", 0, ldi_a_hlp},				// 0x2a
-	{"DEC HL", 0, undefined},					// 0x2b
-	{"INC L", 0, undefined},					// 0x2c
-	{"DEC L", 0, undefined},					// 0x2d
-	{"LD L, 0x%02X", 1, undefined},				// 0x2e
-	{"CPL", 0, undefined},						// 0x2f
-	{"JR NC, 0x%02X", 1, undefined},			// 0x30
-	{"LD SP, 0x%04X", 2, ld_sp_nn},				// 0x31
-	{"LDD (HL), A", 0, ldd_hlp_a},				// 0x32
-	{"INC SP", 0, undefined},					// 0x33
-	{"INC (HL)", 0, undefined},					// 0x34
-	{"DEC (HL)", 0, undefined},					// 0x35
-	{"LD (HL), 0x%02X", 1, ld_hlp_n},			// 0x36
-	{"SCF", 0, undefined},						// 0x37
-	{"JR C, 0x%02X", 1, undefined},				// 0x38
-	{"ADD HL, SP", 0, undefined},				// 0x39
-	{"LDD A, (HL)", 0, undefined},				// 0x3a
-	{"DEC SP", 0, undefined},					// 0x3b
-	{"INC A", 0, undefined},					// 0x3c
-	{"DEC A", 0, undefined},					// 0x3d
-	{"LD A, 0x%02X", 1, ld_a_n},				// 0x3e
-	{"CCF", 0, undefined},						// 0x3f
-	{"LD B, B", 0, undefined},					// 0x40
-	{"LD B, C", 0, undefined},					// 0x41
-	{"LD B, D", 0, undefined},					// 0x42
-	{"LD B, E", 0, undefined},					// 0x43
-	{"LD B, H", 0, undefined},					// 0x44
-	{"LD B, L", 0, undefined},					// 0x45
-	{"LD B, (HL)", 0, undefined},				// 0x46
-	{"LD B, A", 0, ld_b_a},						// 0x47
-	{"LD C, B", 0, undefined},					// 0x48
-	{"LD C, C", 0, undefined},					// 0x49
-	{"LD C, D", 0, undefined},					// 0x4a
-	{"LD C, E", 0, undefined},					// 0x4b
-	{"LD C, H", 0, undefined},					// 0x4c
-	{"LD C, L", 0, undefined},					// 0x4d
-	{"LD C, (HL)", 0, undefined},				// 0x4e
-	{"LD C, A", 0, undefined},					// 0x4f
-	{"LD D, B", 0, undefined},					// 0x50
-	{"LD D, C", 0, undefined},					// 0x51
-	{"LD D, D", 0, undefined},					// 0x52
-	{"LD D, E", 0, undefined},					// 0x53
-	{"LD D, H", 0, undefined},					// 0x54
-	{"LD D, L", 0, undefined},					// 0x55
-	{"LD D, (HL)", 0, undefined},				// 0x56
-	{"LD D, A", 0, undefined},					// 0x57
-	{"LD E, B", 0, undefined},					// 0x58
-	{"LD E, C", 0, undefined},					// 0x59
-	{"LD E, D", 0, undefined},					// 0x5a
-	{"LD E, E", 0, undefined},					// 0x5b
-	{"LD E, H", 0, undefined},					// 0x5c
-	{"LD E, L", 0, undefined},					// 0x5d
-	{"LD E, (HL)", 0, undefined},				// 0x5e
-	{"LD E, A", 0, undefined},					// 0x5f
-	{"LD H, B", 0, undefined},					// 0x60
-	{"LD H, C", 0, undefined},					// 0x61
-	{"LD H, D", 0, undefined},					// 0x62
-	{"LD H, E", 0, undefined},					// 0x63
-	{"LD H, H", 0, undefined},					// 0x64
-	{"LD H, L", 0, undefined},					// 0x65
-	{"LD H, (HL)", 0, undefined},				// 0x66
-	{"LD H, A", 0, undefined},					// 0x67
-	{"LD L, B", 0, undefined},					// 0x68
-	{"LD L, C", 0, undefined},					// 0x69
-	{"LD L, D", 0, undefined},					// 0x6a
-	{"LD L, E", 0, undefined},					// 0x6b
-	{"LD L, H", 0, undefined},					// 0x6c
-	{"LD L, L", 0, undefined},					// 0x6d
-	{"LD L, (HL)", 0, undefined},				// 0x6e
-	{"LD L, A", 0, undefined},					// 0x6f
-	{"LD (HL), B", 0, undefined},				// 0x70
-	{"LD (HL), C", 0, undefined},				// 0x71
-	{"LD (HL), D", 0, undefined},				// 0x72
-	{"LD (HL), E", 0, undefined},				// 0x73
-	{"LD (HL), H", 0, undefined},				// 0x74
-	{"LD (HL), L", 0, undefined},				// 0x75
-	{"HALT", 0, undefined},						// 0x76
-	{"LD (HL), A", 0, undefined},				// 0x77
-	{"LD A, B", 0, ld_a_b},						// 0x78
-	{"LD A, C", 0, undefined},					// 0x79
-	{"LD A, D", 0, undefined},					// 0x7a
-	{"LD A, E", 0, undefined},					// 0x7b
-	{"LD A, H", 0, undefined},					// 0x7c
-	{"LD A, L", 0, undefined},					// 0x7d
-	{"LD A, (HL)", 0, undefined},				// 0x7e
-	{"LD A, A", 0, undefined},					// 0x7f
-	{"ADD A, B", 0, undefined},					// 0x80
-	{"ADD A, C", 0, undefined},					// 0x81
-	{"ADD A, D", 0, undefined},					// 0x82
-	{"ADD A, E", 0, undefined},					// 0x83
-	{"ADD A, H", 0, undefined},					// 0x84
-	{"ADD A, L", 0, undefined},					// 0x85
-	{"ADD A, (HL)", 0, undefined},				// 0x86
-	{"ADD A", 0, undefined},					// 0x87
-	{"ADC B", 0, undefined},					// 0x88
-	{"ADC C", 0, undefined},					// 0x89
-	{"ADC D", 0, undefined},					// 0x8a
-	{"ADC E", 0, undefined},					// 0x8b
-	{"ADC H", 0, undefined},					// 0x8c
-	{"ADC L", 0, undefined},					// 0x8d
-	{"ADC (HL)", 0, undefined},					// 0x8e
-	{"ADC A", 0, undefined},					// 0x8f
-	{"SUB B", 0, undefined},					// 0x90
-	{"SUB C", 0, undefined},					// 0x91
-	{"SUB D", 0, undefined},					// 0x92
-	{"SUB E", 0, undefined},					// 0x93
-	{"SUB H", 0, undefined},					// 0x94
-	{"SUB L", 0, undefined},					// 0x95
-	{"SUB (HL)", 0, undefined},					// 0x96
-	{"SUB A", 0, undefined},					// 0x97
-	{"SBC B", 0, undefined},					// 0x98
-	{"SBC C", 0, undefined},					// 0x99
-	{"SBC D", 0, undefined},					// 0x9a
-	{"SBC E", 0, undefined},					// 0x9b
-	{"SBC H", 0, undefined},					// 0x9c
-	{"SBC L", 0, undefined},					// 0x9d
-	{"SBC (HL)", 0, undefined},					// 0x9e
-	{"SBC A", 0, undefined},					// 0x9f
-	{"AND B", 0, undefined},					// 0xa0
-	{"AND C", 0, undefined},					// 0xa1
-	{"AND D", 0, undefined},					// 0xa2
-	{"AND E", 0, and_e},						// 0xa3
-	{"AND H", 0, undefined},					// 0xa4
-	{"AND L", 0, undefined},					// 0xa5
-	{"AND (HL)", 0, undefined},					// 0xa6
-	{"AND A", 0, undefined},					// 0xa7
-	{"XOR B", 0, undefined},					// 0xa8
-	{"XOR C", 0, undefined},					// 0xa9
-	{"XOR D", 0, undefined},					// 0xaa
-	{"XOR E", 0, undefined},					// 0xab
-	{"XOR H", 0, undefined},					// 0xac
-	{"XOR L", 0, undefined},					// 0xad
-	{"XOR (HL)", 0, undefined},					// 0xae
-	{"XOR A", 0, xor_a},						// 0xaf
-	{"OR B", 0, undefined},						// 0xb0
-	{"OR C", 0, or_c},							// 0xb1
-	{"OR D", 0, undefined},						// 0xb2
-	{"OR E", 0, undefined},						// 0xb3
-	{"OR H", 0, undefined},						// 0xb4
-	{"OR L", 0, undefined},						// 0xb5
-	{"OR (HL)", 0, undefined},					// 0xb6
-	{"OR A", 0, undefined},						// 0xb7
-	{"CP B", 0, undefined},						// 0xb8
-	{"CP C", 0, undefined},						// 0xb9
-	{"CP D", 0, undefined},						// 0xba
-	{"CP E", 0, undefined},						// 0xbb
-	{"CP H", 0, undefined},						// 0xbc
-	{"CP L", 0, undefined},						// 0xbd
-	{"CP (HL)", 0, undefined},					// 0xbe
-	{"CP A", 0, undefined},						// 0xbf
-	{"RET NZ", 0, undefined},					// 0xc0
-	{"POP BC", 0, undefined},					// 0xc1
-	{"JP NZ, 0x%04X", 2, undefined},			// 0xc2
-	{"JP 0x%04X", 2, jp_nn},					// 0xc3
-	{"CALL NZ, 0x%04X", 2, undefined},			// 0xc4
-	{"PUSH BC", 0, undefined},					// 0xc5
-	{"ADD A, 0x%02X", 1, undefined},			// 0xc6
-	{"RST 0x00", 0, undefined},					// 0xc7
-	{"RET Z", 0, undefined},					// 0xc8
-	{"RET", 0, ret},							// 0xc9
-	{"JP Z, 0x%04X", 2, undefined},				// 0xca
-	{"CB %02X", 1, undefined},					// 0xcb
-	{"CALL Z, 0x%04X", 2, undefined},			// 0xcc
-	{"CALL 0x%04X", 2, call_nn},				// 0xcd
-	{"ADC 0x%02X", 1, undefined},				// 0xce
-	{"RST 0x08", 0, undefined},					// 0xcf
-	{"RET NC", 0, undefined},					// 0xd0
-	{"POP DE", 0, undefined},					// 0xd1
-	{"JP NC, 0x%04X", 2, undefined},			// 0xd2
-	{"UNKNOWN", 0, undefined},					// 0xd3
-	{"CALL NC, 0x%04X", 2, undefined},			// 0xd4
-	{"PUSH DE", 0, undefined},					// 0xd5
-	{"SUB 0x%02X", 1, undefined},				// 0xd6
-	{"RST 0x10", 0, undefined},					// 0xd7
-	{"RET C", 0, undefined},					// 0xd8
-	{"RETI", 0, undefined},						// 0xd9
-	{"JP C, 0x%04X", 2, undefined},				// 0xda
-	{"UNKNOWN", 0, undefined},					// 0xdb
-	{"CALL C, 0x%04X", 2, undefined},			// 0xdc
-	{"UNKNOWN", 0, undefined},					// 0xdd
-	{"SBC 0x%02X", 1, undefined},				// 0xde
-	{"RST 0x18", 0, rst_18},					// 0xdf
-	{"LD (0xFF00 + 0x%02X), A", 1, ld_ff_n_ap}, // 0xe0
-	{"POP HL", 0, undefined},					// 0xe1
-	{"LD (0xFF00 + C), A", 0, ld_ff_c_a},		// 0xe2
-	{"UNKNOWN", 0, undefined},					// 0xe3
-	{"UNKNOWN", 0, undefined},					// 0xe4
-	{"PUSH HL", 0, undefined},					// 0xe5
-	{"AND 0x%02X", 1, undefined},				// 0xe6
-	{"RST 0x20", 0, undefined},					// 0xe7
-	{"ADD SP,0x%02X", 1, undefined},			// 0xe8
-	{"JP HL", 0, undefined},					// 0xe9
-	{"LD (0x%04X), A", 2, ld_nnp_a},			// 0xea
-	{"UNKNOWN", 0, undefined},					// 0xeb
-	{"UNKNOWN", 0, undefined},					// 0xec
-	{"UNKNOWN", 0, undefined},					// 0xed
-	{"XOR 0x%02X", 1, undefined},				// 0xee
-	{"RST 0x28", 0, undefined},					// 0xef
-	{"LD A, (0xFF00 + 0x%02X)", 1, ld_ff_ap_n}, // 0xf0
-	{"POP AF", 0, undefined},					// 0xf1
-	{"LD A, (0xFF00 + C)", 0, undefined},		// 0xf2
-	{"DI", 0, di},								// 0xf3
-	{"UNKNOWN", 0, undefined},					// 0xf4
-	{"PUSH AF", 0, undefined},					// 0xf5
-	{"OR 0x%02X", 1, undefined},				// 0xf6
-	{"RST 0x30", 0, undefined},					// 0xf7
-	{"LD HL, SP+0x%02X", 1, undefined},			// 0xf8
-	{"LD SP, HL", 0, undefined},				// 0xf9
-	{"LD A, (0x%04X)", 2, undefined},			// 0xfa
-	{"EI", 0, undefined},						// 0xfb
-	{"UNKNOWN", 0, undefined},					// 0xfc
-	{"UNKNOWN", 0, undefined},					// 0xfd
-	{"CP 0x%02X", 1, cp_n},						// 0xfe
-	{"RST 0x38", 0, rst_38},					// 0xff
+#define INSTRUCTION(opcode, disassembly, operandLength, execute) {disassembly, operandLength},
+#include "../include/instructions.inc"
+#undef INSTRUCTION
 };
 
 // This is a database of how many ticks each instruction should take.
@@ -340,6 +100,19 @@ void reset(void)
 	registers.de = 0x00D8;
 	registers.hl = 0x014D;
 
+	// The CGB boot ROM leaves different values. Games check for A = 0x11 to know they're on a CGB.
+	if (cgb.enabled)
+	{
+		registers.a = 0x11;
+		registers.f = 0x80;
+		registers.bc = 0x0000;
+		registers.de = 0xFF56;
+		registers.hl = 0x000D;
+	}
+
+	// Initialise the CGB banks, palettes, speed & HDMA (before the palettes are rebuilt below)
+	cgbReset();
+
 	// Initialise the interrupts
 	interrupt.master = 1;
 	interrupt.enable = 0;
@@ -354,18 +127,40 @@ void reset(void)
 	keys.left = 1;
 	keys.up = 1;
 	keys.down = 1;
+	updateJoypad();
 
 	// Initialise the GPU
 	gpu.control = 0;
+	gpu.status = 0;
 	gpu.scrollX = 0;
 	gpu.scrollY = 0;
 	gpu.scanline = 0;
+	gpu.lyCompare = 0;
+	gpu.windowX = 0;
+	gpu.windowY = 0;
+	gpu.windowLine = 0;
+	gpu.backgroundPalette = 0xFC;
+	gpu.spritePalette[0] = 0xFF;
+	gpu.spritePalette[1] = 0xFF;
 	gpu.tick = 0;
+	gpu.mode = GPU_MODE_HBLANK;
+	gpu.lastTicks = 0;
+	rebuildPalettes(); // From the BGP/OBP0/OBP1 values just set
+	invalidateBackground();
+
+	// Initialise the cart
+	romBank = 1;
+
+	// Initialise the serial port
+	serialReset();
 
 	// Initialise ticks and stopped variable
 	ticks = 0;
 	stopped = 0;
 
+	// Initialise the APU (before the sound registers are written below)
+	apuReset();
+
 	/*
 		INITIAL BYTE WRITES:
 			[$FF05] = $00 ; TIMA
@@ -435,93 +230,11 @@ void reset(void)
 	writeByte(0xFF4B, 0x00);
 	writeByte(0xFFFF, 0x00);
 
-	printf("Finished reset!\n\n"); // DEBUG
-}
-
-void stepCPU()
-{
-	unsigned char instruction;
-	unsigned short operand = 0;
-	lastOpperand = 0; // DEBUG VALUE used for correctly moving pc back if unknown opcode encountered
-
-	// Check stopped
-	if (stopped)
-	{
-		// Do nothing
-		return;
-	}
-
-	//BREAKPOINT DEBUG
-	if(registers.pc == 0x21B || registers.pc == 0x219)
-	{
-		debugModeEnable = 1;
-	}
-
-	// Debug stuff
-	if (debugModeEnable)
-	{
-		// Show pop-up of current execution
-
-		showRealtimeData();
-	}
-
-	// Get instruction & increment pc
-	// printf("Program Counter is currently at: 0x%x.\n", registers.pc);
-	instruction = readByte(registers.pc++);
-	// printf("Reading instruction 0x%02x...\n", instruction);
-
-	// Get the opperand of the function (if any).
-	// printf("Operand Length of: %u\n", instructions[instruction].operandLength);
-	if (instructions[instruction].operandLength == 1)
-	{
-		operand = (unsigned short)readByte(registers.pc);
-		// printf("Found opperand of: 0x%x\n", operand);
-		lastOpperand = 1;
-		// printf("Incrementing pc...\n");
-	}
-	if (instructions[instruction].operandLength == 2)
-	{
-		operand = readShort(registers.pc);
-		// printf("Found opperand of: 0x%x\n", operand);
-		lastOpperand = 2;
-		// printf("Incrementing pc...\n");
-	}
-
-	// Increment pc by the length of the opperand length (only occurs if there is an opperand)
-	registers.pc += instructions[instruction].operandLength;
-
-	// Select opperation to execute! (taken directly from Cinoop for now.)
-	// Each case dereferences a pointer to a function which is stored in the 'instructions' array.
-
-	switch (instructions[instruction].operandLength)
-	{
-	case 0:
-		// printf("Executing 0x%.02x, '%s'.\n", instruction, instructions[instruction].disassembly);
-		((void (*)(void))instructions[instruction].execute)();
-		break;
-
-	case 1:
-		// printf("Executing 0x%.02x, '%s'. Opperand is: 0x%02x.\n", instruction, instructions[instruction].disassembly, operand);
-		((void (*)(unsigned char))instructions[instruction].execute)((unsigned char)operand);
-		break;
-
-	case 2:
-		// printf("Executing 0x%.02x, '%s'. Opperand is: 0x%02x.\n", instruction, instructions[instruction].disassembly, operand);
-		((void (*)(unsigned short))instructions[instruction].execute)(operand);
-		break;
-	}
+	// Writing NR14 above triggers channel 1, but the boot ROM's beep has long faded out by the time the
+	// cartridge starts.
+	apu.square[0].volume = 0;
 
-	// Add the total amount of ticks this instruction would have taken to the total ticks
-	ticks += instructionTicks[instruction];
-
-	// printf("Finished CPU cycle!\n\n");
-
-	// VERY DEBUG, MUST DELETE AFTER THIS BREAKPOINT IS REACHED. Cinoop did this so I wanna track when I hit it too >:)
-	if (registers.pc == 0x2817)
-	{
-		printf("You've hit the point where vram starts to be accessed :O Stopping emulation so you can celebrate!");
-		quit();
-	}
+	printf("Finished reset!\n\n"); // DEBUG
 }
 
 void undefined(void)
@@ -719,473 +432,119 @@ static void cp(unsigned char value)
 }
 
 /*===========================================
-	INSTRUCTIONS
+	CORES
 	------
-	All instructions that can be executed.
+	The two accuracy tiers (and the test core), all built from the one core in 'include/cpucore.inc'.
+
+	fast	Memory is read & written as the instruction runs, and the time it took is added once it's
+			done. The PPU & serial port catch up after every instruction (see runFrame).
+	cycle	Every bus access first moves time on by an M-cycle and catches the PPU & serial port up to
+			it, so they see each read & write at the point in the instruction it really happens. Time
+			the instruction spends without touching the bus is added at the end.
+	flat	Not a tier, only for the single step CPU tests (cputest.c). The bus is 64KB of plain RAM with
+			every access logged, and an opcode that isn't implemented is noted rather than quitting.
 ============================================*/
 
-/*
-	0x0X
-	INSTRUCTIONS
-*/
+// Time a conditional instruction took, taken or not. Counted by CORE_FINISH like the rest of its time,
+// so on the cycle core the bus accesses already made come off it.
+static unsigned char branchTicks;
 
-/*
-	NOP - 0x00
-	---
-	Does nothing. Skips the cycle.
-*/
-void nop(void)
-{
-}
+#define CORE(name) name##_fast
+#define BUS_READ(address) readByte(address)
+#define BUS_WRITE(address, value) writeByte(address, value)
+#define CORE_START()
+#define CORE_FINISH(instructionTicks) (ticks += CPU_TICKS(instructionTicks))
+#define CORE_UNDEFINED() undefined()
+#include "../include/cpucore.inc"
+#undef CORE
+#undef BUS_READ
+#undef BUS_WRITE
+#undef CORE_START
+#undef CORE_FINISH
+#undef CORE_UNDEFINED
 
-/*
-	LD BC NN - 0x01
-	---
-	Load into the 16-bit value BC the 16-bit value of NN.
-*/
-void ld_bc_nn(unsigned short value)
-{
-	registers.bc = value;
-}
+static unsigned long cycleTicks; // What this instruction's bus accesses have added to 'ticks' so far
 
-/*
-	LD BCP A - 0x02
-	---
-	Load into the address specified by the 16-bit register BC, the value stored at the 8-bit register
-	A.
-*/
-void ld_bcp_a(void)
+// An M-cycle passes before each access
+static void busCycle(void)
 {
-	writeByte(registers.bc, registers.a);
-}
-
-/*
-	DEC B - 0x05
-	---
-	Decrement the value held in register B.
+	ticks += CPU_TICKS(CPU_MCYCLE_TICKS);
+	cycleTicks += CPU_TICKS(CPU_MCYCLE_TICKS);
 
-	Must set flags:
-		- Subtract
-		- Zero (if applicable)
-		- Half Carry (if applicable)
-*/
-void dec_b(void)
-{
-	registers.b = dec(registers.b);
+	ppu->step();
+	if (serialPort.transferring)
+		stepSerial();
 }
 
-/*
-	LD B N - 0x06
-	---
-	Load value of N into register B.
-*/
-void ld_b_n(unsigned char value)
+static unsigned char busReadCycle(unsigned short address)
 {
-	registers.b = value;
+	busCycle();
+	return readByte(address);
 }
 
-/*
-	DEC BC - 0x0B
-	---
-	Decrease the value of the 16-bit register BC by 1.
-	Don't need to check flags (apparently?).
-*/
-void dec_bc(void)
+static void busWriteCycle(unsigned short address, unsigned char value)
 {
-	registers.bc--;
+	busCycle();
+	writeByte(address, value);
 }
 
-/*
-	INC C - 0x0C
-	---
-	Increment C by 1.
-	Clear negative flag.
-	Set half-carry & zero flag if necessary.
-*/
-void inc_c(void)
+// Whatever the instruction takes past its bus accesses
+static void finishCycle(unsigned char instructionTicks)
 {
-	registers.c = inc(registers.c);
+	if (cycleTicks < CPU_TICKS(instructionTicks))
+		ticks += CPU_TICKS(instructionTicks) - cycleTicks;
 }
 
-/*
-	DEC C - 0x0D
-	---
-	Decrement the value held in register C.
-
-	Must set flags:
-		- Subtract
-		- Zero (if applicable)
-		- Half Carry (if applicable)
-*/
-void dec_c(void)
-{
-	registers.c = dec(registers.c);
-}
+#define CORE(name) name##_cycle
+#define BUS_READ(address) busReadCycle(address)
+#define BUS_WRITE(address, value) busWriteCycle(address, value)
+#define CORE_START() (cycleTicks = 0)
+#define CORE_FINISH(instructionTicks) finishCycle(instructionTicks)
+#define CORE_UNDEFINED() undefined()
+#include "../include/cpucore.inc"
+#undef CORE
+#undef BUS_READ
+#undef BUS_WRITE
+#undef CORE_START
+#undef CORE_FINISH
+#undef CORE_UNDEFINED
 
-/*
-	LD C N - 0x0E
-	---
-	Load value of N into register C.
-*/
-void ld_c_n(unsigned char value)
-{
-	registers.c = value;
-}
+#define CORE(name) name##_flat
+#define BUS_READ(address) flatRead(address)
+#define BUS_WRITE(address, value) flatWrite(address, value)
+#define CORE_START() (flatBus.logLength = 0)
+#define CORE_FINISH(instructionTicks) (ticks += CPU_TICKS(instructionTicks))
+#define CORE_UNDEFINED() flatUndefined()
+#include "../include/cpucore.inc"
+#undef CORE
+#undef BUS_READ
+#undef BUS_WRITE
+#undef CORE_START
+#undef CORE_FINISH
+#undef CORE_UNDEFINED
 
-/*
-	LD DE NN - 0x11
-	---
-	Load into the 16-bit register DE the value of NN.
-*/
-void ld_de_nn(unsigned short value)
-{
-	registers.de = value;
-}
+const struct cpuCore fastCore = {"fast", step_fast};
+const struct cpuCore cycleCore = {"cycle", step_cycle};
+const struct cpuCore flatCore = {"flat", step_flat};
 
-/*
-	0x2X
-	INSTRUCTIONS
-*/
+const struct cpuCore *cpu = &fastCore;
 
 /*
-	JR NZ N - 0x20
+	selectCpuCore
 	---
-	If ZERO FLAG is NOT set, add N to current PC.
-	Effectively, jump forward or back by N if ZERO FLAG is NOT set.
+	--core <name>. Returns 0 if there's no such core.
 */
-void jr_nz_n(unsigned char value)
+int selectCpuCore(const char *name)
 {
-	if (!FLAGS_ISZERO)
-	{
-		registers.pc += (signed char)value; // Jump based on a signed char, as a jump can be both
-											// forward or backwards.
-		ticks += 12;
-	}
+	if (!strcmp(name, fastCore.name))
+		cpu = &fastCore;
+	else if (!strcmp(name, cycleCore.name))
+		cpu = &cycleCore;
 	else
 	{
-		ticks += 8;
+		printf("Unknown CPU core \"%s\" (fast, cycle).\n", name);
+		return 0;
 	}
-}
-
-/*
-	LD Hl NN - 0x21
-	---
-	Load the value of NN into the register HF
-*/
-void ld_hl_nn(unsigned short value)
-{
-	registers.hl = value;
-}
-
-/*
-	LDI A (HL + ) - 0x2a
-	---
-	Load into the 8-bit register A, the value at the memory location specified by the value in the
-	16-bit register HL.
-	HL is incremeneted by 1 after this memory lead.
-*/
-void ldi_a_hlp(void)
-{
-	registers.a = readByte(registers.hl);
-	registers.hl++;
-}
-
-/*
-	LD SP NN - 0x31
-	---
-	Load 16-bit value NN into 16-bit register SP.
-*/
-void ld_sp_nn(unsigned short value)
-{
-	registers.sp = value;
-}
-
-/*
-	LDD HL- A - 0x32
-	---
-	Load data from the 8-bit A register to the absolute address specified by the 16-bit register HL.
-	The value of HL is decremented after the memory write.
-*/
-void ldd_hlp_a(void)
-{
-	writeByte(registers.hl, registers.a);
-	registers.hl--;
-}
 
-/*
-	LD HL N - 0x36
-	---
-	Load the 8-bit data N into the memory address speicfied by the 16-bit register HL.
-*/
-void ld_hlp_n(unsigned char value)
-{
-	writeByte(registers.hl, value);
-}
-
-/*
-	LD A N - 0x3e
-	---
-	Load the 8-bit data N into the 8-bit register A.
-*/
-void ld_a_n(unsigned char value)
-{
-	registers.a = value;
+	return 1;
 }
-
-/*
-	0x4X
-	INSTRUCTIONS
-*/
-
-/*
-	LD B A - 0x47
-	---
-	Load the data from the 8-bit register A into the 8-bit register B.
-*/
-void ld_b_a(void)
-{
-	registers.b = registers.a;
-}
-
-/*
-	0x7X
-	INSTRUCTIONS
-*/
-
-/*
-	LD A B 0x78
-	---
-	Load the the value of 8-bit register B into the 8-bit register A.
-*/
-void ld_a_b(void)
-{
-	registers.a = registers.b;
-}
-
-/*
-	0xAX
-	INSTRUCTIONS
-*/
-
-/*
-	AND E - 0xA3
-	---
-	Perform bitwise AND between 8-bit registers A and E, storing the results in 8-bit register A.
-*/
-void and_e(void)
-{
-	and(registers.e);
-}
-
-/*
-	XOR A - 0xAF
-	---
-	Calculates the result of an exclusive-or between the contents of register A
-	and register A, storing the results back into register A.
-
-	This should always result in clearing the contents of register A.
-*/
-void xor_a(void)
-{
-	xor(registers.a);
-}
-
-/*
-	0xBX
-	INSTRUCTIONS
-*/
-
-/*
-	OR C - 0xB1
-	---
-	Perform a bitwise OR opperation between 8-bit registers A and C.
-	Store the results in 8-bit register A.
-	Check zero flag & clear all other flags
-*/
-void or_c(void)
-{
-	or(registers.c);
-}
-
-/*
-	0xCX
-	INSTRUCTIONS
-*/
-
-/*
-	JP NN - 0xC3
-	---
-	Jumps to the point in code specified by the opperand.
-*/
-void jp_nn(unsigned short operand)
-{
-	// printf("Jumping to 0x%.4x\n", operand);
-	registers.pc = operand;
-}
-
-/*
-	RET - 0xC9
-	---
-	Generally used to return from a function.
-	Read the last short value on the stack and assign it to the register.pc variable (program counter);
-*/
-void ret(void)
-{
-	registers.pc = readShortFromStack();
-}
-
-/*
-	CALL NN - 0xCD
-	---
-	Set registers.pc (program counter) to 16-bit value NN.
-	Store the original pc value on the stack before updating to new one!
-*/
-void call_nn(unsigned short value)
-{
-	writeShortToStack(registers.pc);
-	registers.pc = value;
-}
-
-/*
-	RST 18 - 0xDF
-	---
-	Restart / implied call function.
-
-	Unconditional function call to the absolute fixed address defined by the opcode (0x0018).
-	Will store the current PC on the stack before setting the PC to 0x0018.
-	This is so that it can be returned to later if neccesary.
-*/
-void rst_18(void)
-{
-	writeShortToStack(registers.pc);
-	registers.pc = 0x0018;
-}
-
-/*
-	LD FF N AP - 0xE0
-	---
-	Load to the memory location 0xFFXX the value of the 8-bit register A.
-	XX represents the 8-bit value N, which can have a value from 0x00 to 0xFF.
-	Therefore, the range that can be loaded to is 0xFF00 - 0xFFFF.
-*/
-void ld_ff_n_ap(unsigned char value)
-{
-	writeByte((0xFF00 + value), registers.a);
-}
-
-/*
-	LD FF C A - 0xE2
-	---
-	Load the data from the 8-bit register A into the memory location specified by 0xFF00 plus the 8-bit
-	register C.
-*/
-void ld_ff_c_a(void)
-{
-	writeByte(0xFF + registers.c, registers.a);
-}
-
-/*
-	LD NNP A - 0xEA
-	---
-	Load the data in the 8-bit register A to the memory location specified by NN.
-*/
-void ld_nnp_a(unsigned short value)
-{
-	writeByte(value, registers.a);
-}
-
-/*
-	0xFX
-	INSTRUCTIONS
-*/
-
-/*
-	LD FF AP N - 0xF0
-	---
-	Load to the 8-bit register A the value stored at the 16-bit memory location defined as
-	0xFF00 + N, with N being an 8-bit value.
-*/
-void ld_ff_ap_n(unsigned char value)
-{
-	registers.a = readByte(0xFF00 + value);
-}
-
-/*
-	DI - 0xF3
-	---
-	Disable master interrupt flag.
-*/
-void di(void)
-{
-	interrupt.master = 0;
-}
-
-/*
-	CP N - 0xFE
-	---
-	Updates flags based on the result of what A minus N would be.
-	Does not update the A register.
-*/
-void cp_n(unsigned char value)
-{
-	// unsigned char result = registers.a - value;
-
-	// // Is a subtraction so always set negative flag
-	// FLAGS_SET(FLAGS_NEGATIVE);
-
-	// // Set zero if result would be zero
-	// if (result == 0)
-	// {
-	// 	FLAGS_SET(FLAGS_ZERO);
-	// }
-	// else
-	// {
-	// 	FLAGS_CLEAR(FLAGS_ZERO);
-	// }
-
-	// // If the value is larger than what's at register A, set carry flag
-	// if (value > registers.a)
-	// {
-	// 	FLAGS_SET(FLAGS_CARRY);
-	// }
-	// else
-	// {
-	// 	FLAGS_CLEAR(FLAGS_CARRY);
-	// }
-
-	// // Same as above but just for the least sig bits
-	// if ((value & 0x0f) > (registers.a & 0x0f))
-	// {
-	// 	FLAGS_SET(FLAGS_HALFCARRY);
-	// }
-	// else
-	// {
-	// 	FLAGS_CLEAR(FLAGS_HALFCARRY);
-	// }
-	FLAGS_SET(FLAGS_NEGATIVE);
-	
-	if(registers.a == value) FLAGS_SET(FLAGS_ZERO);
-	else FLAGS_CLEAR(FLAGS_ZERO);
-	
-	if(value > registers.a) FLAGS_SET(FLAGS_CARRY);
-	else FLAGS_CLEAR(FLAGS_CARRY);
-	
-	if((value & 0x0f) > (registers.a & 0x0f)) FLAGS_SET(FLAGS_HALFCARRY);
-	else FLAGS_CLEAR(FLAGS_HALFCARRY);
-}
-
-/*
-	RST 38 - 0xFF
-	---
-	Restart / implied call function.
-
-	Unconditional function call to the absolute fixed address defined by the opcode (0x0038).
-	Will store the current PC on the stack before setting the PC to 0x0038.
-	This is so that it can be returned to later if neccesary.
-*/
-
-void rst_38(void)
-{
-	writeShortToStack(registers.pc);
-	registers.pc = 0x0038;
-}
\ No newline at end of file
@@ -0,0 +1,655 @@
+/*
+    NAME: TMC
+    INIT DATE: 19/10/2026
+    LAST EDIT DATE: 19/10/2026
+    DESC:
+        Single step CPU tests & the flat bus they run on. See 'include/cputest.h'.
+*/
+
+#include "../include/cputest.h"
+#include "../include/cpu.h"
+#include "../include/registers.h"
+#include "../include/interupts.h"
+#include "../include/main.h"
+#include "../include/breakpoint.h"
+#include "../include/memory.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+struct flatBus flatBus;
+
+struct cpuTestState
+{
+    unsigned short pc;
+    unsigned short sp;
+    unsigned char a, f, b, c, d, e, h, l;
+    unsigned char ime;
+    struct busAccess ram[CPU_TEST_MAX_RAM]; // 'write' unused
+    unsigned int ramCount;
+};
+
+struct cpuTestVector
+{
+    char name[32];
+    struct cpuTestState initial;
+    struct cpuTestState final;
+    struct busAccess accesses[CPU_TEST_MAX_ACCESSES]; // Just the cycles that use the bus
+    unsigned int accessCount;
+    unsigned int cycleCount; // Every M-cycle, including the ones that don't
+};
+
+// Where the parser is in the file. 'failed' is set on anything unexpected and stops everything.
+struct json
+{
+    const char *at;
+    const char *end;
+    int failed;
+};
+
+unsigned char flatRead(unsigned short address)
+{
+    unsigned char value = flatBus.memory[address];
+
+    if (flatBus.logLength < CPU_TEST_MAX_ACCESSES)
+        flatBus.log[flatBus.logLength++] = (struct busAccess){address, value, 0};
+
+    return value;
+}
+
+void flatWrite(unsigned short address, unsigned char value)
+{
+    flatBus.memory[address] = value;
+
+    if (flatBus.logLength < CPU_TEST_MAX_ACCESSES)
+        flatBus.log[flatBus.logLength++] = (struct busAccess){address, value, 1};
+}
+
+void flatUndefined(void)
+{
+    flatBus.undefined = 1;
+}
+
+/*===========================================
+    PARSER
+    ------
+    Just enough JSON for the test files. Strings have no escapes that matter (names only), and
+    numbers are whole and never negative.
+============================================*/
+
+static void skipSpace(struct json *json)
+{
+    while (json->at < json->end && (*json->at == ' ' || *json->at == '\n' || *json->at == '\r' || *json->at == '\t'))
+        json->at++;
+}
+
+// Take 'c' if it's next
+static int accept(struct json *json, char c)
+{
+    skipSpace(json);
+    if (json->at < json->end && *json->at == c)
+    {
+        json->at++;
+        return 1;
+    }
+
+    return 0;
+}
+
+static void expect(struct json *json, char c)
+{
+    if (!accept(json, c))
+        json->failed = 1;
+}
+
+// A number, or -1 for null
+static long readNumber(struct json *json)
+{
+    long value = 0;
+    const char *start;
+
+    skipSpace(json);
+    if (json->end - json->at >= 4 && !memcmp(json->at, "null", 4))
+    {
+        json->at += 4;
+        return -1;
+    }
+
+    start = json->at;
+    while (json->at < json->end && *json->at >= '0' && *json->at <= '9')
+        value = value * 10 + (*json->at++ - '0');
+
+    if (json->at == start)
+        json->failed = 1;
+
+    return value;
+}
+
+// A string, cut short to fit 'size'
+static void readString(struct json *json, char *out, size_t size)
+{
+    size_t length = 0;
+
+    expect(json, '"');
+    while (!json->failed && json->at < json->end && *json->at != '"')
+    {
+        if (*json->at == '\\' && json->at + 1 < json->end)
+            json->at++;
+        if (length + 1 < size)
+            out[length++] = *json->at;
+        json->at++;
+    }
+    if (size)
+        out[length] = '\0';
+
+    expect(json, '"');
+}
+
+// Step over a value that isn't needed
+static void skipValue(struct json *json)
+{
+    int depth = 0;
+
+    skipSpace(json);
+    if (json->at < json->end && *json->at == '"')
+    {
+        readString(json, NULL, 0);
+        return;
+    }
+
+    // An array or object ends at its matching bracket, anything else at what follows it
+    while (json->at < json->end)
+    {
+        switch (*json->at)
+        {
+        case '"':
+            readString(json, NULL, 0);
+            continue;
+        case '[':
+        case '{':
+            depth++;
+            break;
+        case ']':
+        case '}':
+            if (depth-- == 0)
+                return;
+            if (depth == 0)
+            {
+                json->at++;
+                return;
+            }
+            break;
+        case ',':
+            if (depth == 0)
+                return;
+            break;
+        }
+        json->at++;
+    }
+
+    json->failed = 1;
+}
+
+// The next key of an object, with its ':'. Returns 0 at the end of the object.
+static int readKey(struct json *json, char *key, size_t size, int first)
+{
+    if (accept(json, '}'))
+        return 0;
+    if (!first)
+        expect(json, ',');
+
+    readString(json, key, size);
+    expect(json, ':');
+    return !json->failed;
+}
+
+static void readRam(struct json *json, struct cpuTestState *state)
+{
+    state->ramCount = 0;
+
+    expect(json, '[');
+    if (accept(json, ']'))
+        return;
+
+    do
+    {
+        long address, value;
+
+        expect(json, '[');
+        address = readNumber(json);
+        expect(json, ',');
+        value = readNumber(json);
+        expect(json, ']');
+
+        if (state->ramCount >= CPU_TEST_MAX_RAM || address < 0 || value < 0)
+        {
+            json->failed = 1;
+            return;
+        }
+        state->ram[state->ramCount++] = (struct busAccess){(unsigned short)address, (unsigned char)value, 0};
+    } while (!json->failed && accept(json, ','));
+
+    expect(json, ']');
+}
+
+static void readState(struct json *json, struct cpuTestState *state)
+{
+    char key[8];
+    int first = 1;
+
+    memset(state, 0, sizeof(*state));
+    expect(json, '{');
+
+    while (!json->failed && readKey(json, key, sizeof(key), first))
+    {
+        first = 0;
+
+        if (!strcmp(key, "ram"))
+            readRam(json, state);
+        else if (!strcmp(key, "pc"))
+            state->pc = (unsigned short)readNumber(json);
+        else if (!strcmp(key, "sp"))
+            state->sp = (unsigned short)readNumber(json);
+        else if (!strcmp(key, "ime"))
+            state->ime = (unsigned char)readNumber(json);
+        else if (key[0] != '\0' && key[1] == '\0' && strchr("afbcdehl", key[0]) != NULL)
+        {
+            unsigned char *registers8[] = {&state->a, &state->f, &state->b, &state->c, &state->d, &state->e, &state->h, &state->l};
+            *registers8[strchr("afbcdehl", key[0]) - "afbcdehl"] = (unsigned char)readNumber(json);
+        }
+        else
+            skipValue(json); // "ie", "ei", ...
+    }
+}
+
+static void readCycles(struct json *json, struct cpuTestVector *vector)
+{
+    vector->accessCount = 0;
+    vector->cycleCount = 0;
+
+    expect(json, '[');
+    if (accept(json, ']'))
+        return;
+
+    do
+    {
+        long address, value;
+        char kind[8] = "";
+
+        vector->cycleCount++;
+        if (accept(json, '['))
+        {
+            address = readNumber(json);
+            expect(json, ',');
+            value = readNumber(json);
+            expect(json, ',');
+            readString(json, kind, sizeof(kind));
+            expect(json, ']');
+
+            // "r-m" is a read, "-wm" a write, "---" a cycle with nothing on the bus
+            if (kind[0] == 'r' || kind[1] == 'w')
+            {
+                if (vector->accessCount >= CPU_TEST_MAX_ACCESSES || address < 0 || value < 0)
+                {
+                    json->failed = 1;
+                    return;
+                }
+                vector->accesses[vector->accessCount++] = (struct busAccess){(unsigned short)address, (unsigned char)value, kind[1] == 'w'};
+            }
+        }
+        else
+            readNumber(json); // null
+    } while (!json->failed && accept(json, ','));
+
+    expect(json, ']');
+}
+
+// The next vector in the array. Returns 0 at the end of it.
+static int readVector(struct json *json, struct cpuTestVector *vector, int first)
+{
+    char key[16];
+    int firstKey = 1;
+
+    if (accept(json, ']'))
+        return 0;
+    if (!first)
+        expect(json, ',');
+
+    vector->name[0] = '\0';
+    expect(json, '{');
+
+    while (!json->failed && readKey(json, key, sizeof(key), firstKey))
+    {
+        firstKey = 0;
+
+        if (!strcmp(key, "name"))
+            readString(json, vector->name, sizeof(vector->name));
+        else if (!strcmp(key, "initial"))
+            readState(json, &vector->initial);
+        else if (!strcmp(key, "final"))
+            readState(json, &vector->final);
+        else if (!strcmp(key, "cycles"))
+            readCycles(json, vector);
+        else
+            skipValue(json);
+    }
+
+    return !json->failed;
+}
+
+/*===========================================
+    RUNNING
+============================================*/
+
+// "read 1234=56", "write 1234=56" or "none"
+static void describeAccess(const struct busAccess *access, char *text)
+{
+    if (access == NULL)
+        strcpy(text, "none");
+    else
+        sprintf(text, "%s %04X=%02X", access->write ? "write" : "read", access->address, access->value);
+}
+
+/*
+    runVector
+    ---
+    Run one vector on the flat core. Returns 1 if it passed, otherwise describes the first difference
+    in 'failure'.
+*/
+static int runVector(const struct cpuTestVector *vector, char *failure, size_t size)
+{
+    const struct cpuTestState *expected = &vector->final;
+    unsigned int i;
+
+    registers.pc = vector->initial.pc;
+    registers.sp = vector->initial.sp;
+    registers.a = vector->initial.a;
+    registers.f = vector->initial.f;
+    registers.b = vector->initial.b;
+    registers.c = vector->initial.c;
+    registers.d = vector->initial.d;
+    registers.e = vector->initial.e;
+    registers.h = vector->initial.h;
+    registers.l = vector->initial.l;
+    interrupt.master = vector->initial.ime;
+    for (i = 0; i < vector->initial.ramCount; i++)
+        flatBus.memory[vector->initial.ram[i].address] = vector->initial.ram[i].value;
+
+    ticks = 0;
+    flatBus.undefined = 0;
+    flatCore.step();
+
+    if (flatBus.undefined)
+    {
+        snprintf(failure, size, "not implemented");
+        return 0;
+    }
+
+#define CHECK_REGISTER(name, field, format)                                                                             \
+    if (registers.field != expected->field)                                                                             \
+    {                                                                                                                   \
+        snprintf(failure, size, name " is " format ", should be " format, registers.field, expected->field); \
+        return 0;                                                                                                       \
+    }
+    CHECK_REGISTER("PC", pc, "%04X")
+    CHECK_REGISTER("SP", sp, "%04X")
+    CHECK_REGISTER("A", a, "%02X")
+    CHECK_REGISTER("F", f, "%02X")
+    CHECK_REGISTER("B", b, "%02X")
+    CHECK_REGISTER("C", c, "%02X")
+    CHECK_REGISTER("D", d, "%02X")
+    CHECK_REGISTER("E", e, "%02X")
+    CHECK_REGISTER("H", h, "%02X")
+    CHECK_REGISTER("L", l, "%02X")
+#undef CHECK_REGISTER
+
+    if (interrupt.master != expected->ime)
+    {
+        snprintf(failure, size, "IME is %d, should be %d", interrupt.master, expected->ime);
+        return 0;
+    }
+
+    for (i = 0; i < expected->ramCount; i++)
+    {
+        if (flatBus.memory[expected->ram[i].address] != expected->ram[i].value)
+        {
+            snprintf(failure, size, "(%04X) is %02X, should be %02X", expected->ram[i].address,
+                     flatBus.memory[expected->ram[i].address], expected->ram[i].value);
+            return 0;
+        }
+    }
+
+    for (i = 0; i < vector->accessCount || i < flatBus.logLength; i++)
+    {
+        const struct busAccess *made = i < flatBus.logLength ? &flatBus.log[i] : NULL;
+        const struct busAccess *wanted = i < vector->accessCount ? &vector->accesses[i] : NULL;
+        char madeText[16], wantedText[16];
+
+        if (made != NULL && wanted != NULL && made->address == wanted->address && made->value == wanted->value && made->write == wanted->write)
+            continue;
+
+        describeAccess(made, madeText);
+        describeAccess(wanted, wantedText);
+        snprintf(failure, size, "bus access %u is %s, should be %s", i + 1, madeText, wantedText);
+        return 0;
+    }
+
+    if (ticks != vector->cycleCount * CPU_MCYCLE_TICKS)
+    {
+        snprintf(failure, size, "took %lu M-cycles, should be %u", ticks / CPU_MCYCLE_TICKS, vector->cycleCount);
+        return 0;
+    }
+
+    return 1;
+}
+
+// Put every byte the vector touched back to 0, ready for the next one
+static void clearVector(const struct cpuTestVector *vector)
+{
+    unsigned int i;
+
+    for (i = 0; i < vector->initial.ramCount; i++)
+        flatBus.memory[vector->initial.ram[i].address] = 0;
+    for (i = 0; i < flatBus.logLength; i++)
+        flatBus.memory[flatBus.log[i].address] = 0;
+}
+
+static char *readFile(const char *fileName, size_t *length)
+{
+    FILE *f = fopen(fileName, "rb");
+    char *data;
+
+    if (f == NULL)
+        return NULL;
+
+    fseek(f, 0, SEEK_END);
+    *length = ftell(f);
+    rewind(f);
+
+    data = malloc(*length + 1);
+    if (data != NULL && fread(data, 1, *length, f) != *length)
+    {
+        free(data);
+        data = NULL;
+    }
+
+    fclose(f);
+    return data;
+}
+
+/*
+    runCpuTests
+    ---
+    Run every vector in 'fileName' and print a summary. The result file is optional (NULL for none).
+    Returns 1 if every vector passed.
+*/
+int runCpuTests(const char *fileName, const char *resultName)
+{
+    static struct cpuTestVector vector;
+    char reports[CPU_TEST_MAX_REPORTS][128];
+    char failure[96];
+    unsigned int count = 0, passed = 0, missing = 0, reportCount = 0;
+    unsigned long long totalTicks = 0;
+    unsigned int i;
+    size_t length;
+    char *data = readFile(fileName, &length);
+    struct json json;
+    clock_t start = clock();
+    const char *verdict;
+    FILE *f;
+
+    if (data == NULL)
+    {
+        printf("Failed to read CPU test file \"%s\".\n", fileName);
+        return 0;
+    }
+
+    // The debug window would be opened on the first instruction otherwise
+    debugModeEnable = 0;
+    debugActive = 0;
+
+    json.at = data;
+    json.end = data + length;
+    json.failed = 0;
+
+    expect(&json, '[');
+    while (!json.failed && readVector(&json, &vector, count == 0))
+    {
+        flatBus.logLength = 0; // In case the core doesn't get as far as a fetch
+        if (runVector(&vector, failure, sizeof(failure)))
+            passed++;
+        else
+        {
+            // One "not implemented" says it for the whole file
+            if (reportCount < CPU_TEST_MAX_REPORTS && !(flatBus.undefined && missing))
+                snprintf(reports[reportCount++], sizeof(reports[0]), "%s: %s", vector.name, failure);
+            if (flatBus.undefined)
+                missing++;
+        }
+
+        totalTicks += ticks;
+        clearVector(&vector);
+        count++;
+    }
+
+    free(data);
+
+    if (json.failed)
+        printf("%s: can't be read past vector %u.\n", fileName, count + 1);
+
+    verdict = json.failed || !count ? "ERROR" : passed == count ? "PASSED" : "FAILED";
+    printf("%s %s: %u/%u passed (%u not implemented) in %.2fs\n", verdict, fileName, passed, count, missing,
+           (double)(clock() - start) / CLOCKS_PER_SEC);
+    for (i = 0; i < reportCount; i++)
+        printf("    %s\n", reports[i]);
+
+    if (resultName != NULL && (f = fopen(resultName, "w")) != NULL)
+    {
+        fprintf(f, "%s\n", verdict);
+        fprintf(f, "cycles: %llu\n", totalTicks);
+        fprintf(f, "details:\n%u/%u passed (%u not implemented)\n", passed, count, missing);
+        for (i = 0; i < reportCount; i++)
+            fprintf(f, "%s\n", reports[i]);
+        fclose(f);
+    }
+
+    return !strcmp(verdict, "PASSED");
+}
+
+/*===========================================
+    CORE TIMING
+    ------
+    The fast core adds an instruction's time once it has run, the cycle core as it goes (an M-cycle
+    per bus access, the rest at the end). Both have to come to the same total, or a ROM runs at a
+    different speed depending on --core. Each case here runs one instruction from WRAM on both.
+============================================*/
+
+#define CORE_TEST_ADDRESS 0xC000
+
+struct coreTimingCase
+{
+    const char *name;
+    unsigned char code[3];
+    unsigned char flags; // F before it runs
+};
+
+static const struct coreTimingCase coreTimingCases[] = {
+    {"NOP", {0x00}, 0},
+    {"LD BC, nn", {0x01, 0x34, 0x12}, 0},
+    {"JR NZ taken", {0x20, 0x05}, 0},
+    {"JR NZ not taken", {0x20, 0x05}, FLAGS_ZERO},
+    {"JP nn", {0xc3, 0x00, 0xC1}, 0},
+};
+
+// Run the case on 'core', giving the ticks it took and where it left PC
+static void runCoreTimingCase(const struct cpuCore *core, const struct coreTimingCase *test, unsigned long *took, unsigned short *pc)
+{
+    unsigned int i;
+
+    for (i = 0; i < sizeof(test->code); i++)
+        writeByte(CORE_TEST_ADDRESS + i, test->code[i]);
+
+    registers.pc = CORE_TEST_ADDRESS;
+    registers.f = test->flags;
+
+    ticks = 0;
+    core->step();
+
+    *took = ticks;
+    *pc = registers.pc;
+}
+
+/*
+    runCoreTimingTests
+    ---
+    --coretest. Check the fast & cycle cores take the same time for each case, and end up at the same
+    PC. The result file is optional (NULL for none). Returns 1 if every case matched.
+*/
+int runCoreTimingTests(const char *resultName)
+{
+    char reports[sizeof(coreTimingCases) / sizeof(coreTimingCases[0])][96];
+    unsigned int count = sizeof(coreTimingCases) / sizeof(coreTimingCases[0]);
+    unsigned int passed = 0, reportCount = 0;
+    unsigned long long totalTicks = 0;
+    unsigned int i;
+    const char *verdict;
+    FILE *f;
+
+    debugModeEnable = 0;
+    debugActive = 0;
+    reset();
+
+    for (i = 0; i < count; i++)
+    {
+        unsigned long fastTicks, cycleTicks;
+        unsigned short fastPc, cyclePc;
+
+        runCoreTimingCase(&fastCore, &coreTimingCases[i], &fastTicks, &fastPc);
+        runCoreTimingCase(&cycleCore, &coreTimingCases[i], &cycleTicks, &cyclePc);
+        totalTicks += fastTicks;
+
+        if (fastTicks == cycleTicks && fastPc == cyclePc)
+            passed++;
+        else
+            snprintf(reports[reportCount++], sizeof(reports[0]), "%s: fast took %lu ticks to %04X, cycle %lu to %04X",
+                     coreTimingCases[i].name, fastTicks, fastPc, cycleTicks, cyclePc);
+    }
+
+    verdict = passed == count ? "PASSED" : "FAILED";
+    printf("%s core timing: %u/%u matched\n", verdict, passed, count);
+    for (i = 0; i < reportCount; i++)
+        printf("    %s\n", reports[i]);
+
+    if (resultName != NULL && (f = fopen(resultName, "w")) != NULL)
+    {
+        fprintf(f, "%s\n", verdict);
+        fprintf(f, "cycles: %llu\n", totalTicks);
+        fprintf(f, "details:\n%u/%u matched\n", passed, count);
+        for (i = 0; i < reportCount; i++)
+            fprintf(f, "%s\n", reports[i]);
+        fclose(f);
+    }
+
+    return passed == count;
+}
@@ -7,6 +7,7 @@
 #include "../include/interupts.h"
 #include "../include/keys.h"
 #include "../include/gpu.h"
+#include "../include/breakpoint.h"
 
 // code taken from Cinoop for debug purposes
 void printRegisters(void)
@@ -34,11 +35,11 @@ void showRealtimeData(void)
 	char temp[1024] = "";
 
 	// Get the last executed instruction (taken straight from cinoop)
-	unsigned char instruction = readByte(registers.pc);
+	unsigned char instruction = peekByte(registers.pc);
 	unsigned short operand = 0;
 
 	if (instructions[instruction].operandLength == 1)
-		operand = (unsigned short)readByte(registers.pc + 1);
+		operand = (unsigned short)peekByte(registers.pc + 1);
 	if (instructions[instruction].operandLength == 2)
 		operand = readShort(registers.pc + 1);
 
@@ -66,15 +67,18 @@ void showRealtimeData(void)
 	debugMessageP += sprintf(debugMessageP, "IF: 0x%02x\n", interrupt.flags);
 
 	debugMessageP += sprintf(debugMessageP, "\nKEYS: 0x%02x\n", keys.c);
-	debugMessageP += sprintf(debugMessageP, "\nKEYS MEM: 0x%02x\n", readByte(0xFF00));
+	debugMessageP += sprintf(debugMessageP, "\nKEYS MEM: 0x%02x\n", peekByte(0xFF00));
 
 	debugMessageP += sprintf(debugMessageP, "\nGPU control (0xFF40): 0x%02x\n", gpu.control);
 	debugMessageP += sprintf(debugMessageP, "GPU scrollX (0xFF43): 0x%02x\n", gpu.scrollX);
 	debugMessageP += sprintf(debugMessageP, "GPU scrollY (0xFF42): 0x%02x\n", gpu.scrollY);
 	debugMessageP += sprintf(debugMessageP, "GPU Scanline (0xFF44): 0x%02x\n", gpu.scanline);
+	debugMessageP += sprintf(debugMessageP, "GPU status (0xFF41): 0x%02x\n", readStatus());
+	debugMessageP += sprintf(debugMessageP, "GPU LYC (0xFF45): 0x%02x\n", gpu.lyCompare);
+	debugMessageP += sprintf(debugMessageP, "GPU window (0xFF4B, 0xFF4A): %d, %d (line %d)\n", gpu.windowX, gpu.windowY, gpu.windowLine);
 	debugMessageP += sprintf(debugMessageP, "GPU tick: 0x%02x\n", gpu.tick);
 
-	debugMessageP += sprintf(debugMessageP, "\n0xFF41: 0x%02x\n", readByte(0xFF41));
+	debugMessageP += sprintf(debugMessageP, "\n0xFF41: 0x%02x\n", peekByte(0xFF41));
 
 	debugMessageP += sprintf(debugMessageP, "\nTicks: 0x%02x\n", ticks);
 
@@ -103,6 +107,7 @@ void showRealtimeData(void)
 		if (buttonId == (1))
 		{
 			debugModeEnable = 0;
+			updateDebugActive();
 			printf("Stopping debug.\n");
 		}
 		else
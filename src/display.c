@@ -2,9 +2,101 @@
 #include <windows.h>
 #include <gl/gl.h>
 #include <SDL2/SDL.h>
+#include "../include/display.h"
+#include "../include/main.h"
+#include "../include/triplebuffer.h"
+#include "../include/scaler.h"
 
+static SDL_Window *window;
+static SDL_Renderer *renderer;
+static SDL_Texture *texture; // Streaming texture finished frames are copied into
+static struct scaler scaler; // With --scaler, frames are scaled into the texture on the CPU
 
-void drawFramebuffer(void)
+// Frames are handed from the emulation thread to the presentation thread through a triple buffer
+static unsigned int frameBuffers[3][SCREEN_WIDTH * SCREEN_HEIGHT];
+static struct triplebuffer frames = {{frameBuffers[0], frameBuffers[1], frameBuffers[2]}, 1, 0, 2};
+
+unsigned int *framebuffer = frameBuffers[0];
+
+/*
+    initDisplay
+    ---
+    Open the window (size defined by constants and scaling factor) and create the renderer & texture
+    used to show frames. Returns 1 on success.
+*/
+int initDisplay(const char *title)
+{
+    window = SDL_CreateWindow(title, SDL_WINDOWPOS_UNDEFINED, SDL_WINDOWPOS_UNDEFINED, SCREEN_WIDTH * SCALING_FACTOR, SCREEN_HEIGHT * SCALING_FACTOR, SDL_WINDOW_SHOWN);
+    if (window == NULL)
+    {
+        printf("Failed to create window: %s\n", SDL_GetError());
+        return 0;
+    }
+
+    // Vsync only ever blocks the presentation thread, emulation runs on its own
+    renderer = SDL_CreateRenderer(window, -1, SDL_RENDERER_ACCELERATED | SDL_RENDERER_PRESENTVSYNC);
+    if (!initScaler(&scaler, scalerMode))
+    {
+        printf("Failed to set up the scaler.\n");
+        return 0;
+    }
+    if (scalerMode != SCALER_NONE)
+        printf("Scaler: %s x%d (%s)\n", scaler.name, scaler.factor, scaler.kernel);
+
+    texture = SDL_CreateTexture(renderer, SDL_PIXELFORMAT_ARGB8888, SDL_TEXTUREACCESS_STREAMING, SCREEN_WIDTH * scaler.factor, SCREEN_HEIGHT * scaler.factor);
+
+    return 1;
+}
+
+/*
+    publishFrame
+    ---
+    Emulation thread. The GPU has finished drawing a frame, hand it over and start drawing the next one
+    into a different buffer.
+*/
+void publishFrame(void)
+{
+    framebuffer = triplebufferPublish(&frames);
+}
+
+/*
+    presentFrame
+    ---
+    Presentation thread. If a new frame has been published, show it and return 1. Returns 0 (without
+    touching the window) when there is nothing new.
+*/
+int presentFrame(void)
+{
+    void *pixels;
+    int pitch;
+
+    if (!triplebufferAcquire(&frames))
+        return 0;
+
+    // Scale straight into the texture's memory rather than into a buffer that then gets copied
+    if (scaler.mode != SCALER_NONE)
+    {
+        if (SDL_LockTexture(texture, NULL, &pixels, &pitch) == 0)
+        {
+            scaleFrame(&scaler, triplebufferFront(&frames), pixels, pitch / sizeof(framebuffer[0]));
+            SDL_UnlockTexture(texture);
+        }
+    }
+    else
+    {
+        SDL_UpdateTexture(texture, NULL, triplebufferFront(&frames), SCREEN_WIDTH * sizeof(framebuffer[0]));
+    }
+    SDL_RenderClear(renderer);
+    SDL_RenderCopy(renderer, texture, NULL, NULL);
+    SDL_RenderPresent(renderer);
+
+    return 1;
+}
+
+void closeDisplay(void)
 {
-    printf("drawFrame called but is not implemented.\n");
-}
\ No newline at end of file
+    SDL_DestroyTexture(texture);
+    freeScaler(&scaler);
+    SDL_DestroyRenderer(renderer);
+    SDL_DestroyWindow(window);
+}
@@ -0,0 +1,390 @@
+/*
+    NAME: TMC
+    INIT DATE: 19/10/2026
+    LAST EDIT DATE: 19/10/2026
+    DESC:
+        Frame hashing & dumps. See 'include/framehash.h'.
+
+        The hash is XXH64 (xxhash.c), which runs at several GB/s: a frame is only 90KB. PNGs are
+        written without compression (zlib "stored" blocks) so no zlib is needed, a frame is still
+        under 70KB.
+*/
+
+#include "../include/framehash.h"
+#include "../include/main.h"
+#include "../include/machine.h"
+#include <stdlib.h>
+#include <string.h>
+
+struct frameHash frameHash = {.mismatch = -1};
+
+static unsigned int crcTable[256];
+
+static unsigned int crc32(unsigned int crc, const unsigned char *data, size_t length)
+{
+    size_t i;
+
+    if (crcTable[1] == 0)
+    {
+        for (i = 0; i < 256; i++)
+        {
+            unsigned int c = (unsigned int)i;
+            int k;
+            for (k = 0; k < 8; k++)
+                c = c & 1 ? 0xEDB88320 ^ (c >> 1) : c >> 1;
+            crcTable[i] = c;
+        }
+    }
+
+    crc = ~crc;
+    for (i = 0; i < length; i++)
+        crc = crcTable[(crc ^ data[i]) & 0xFF] ^ (crc >> 8);
+    return ~crc;
+}
+
+static void put32(unsigned char *p, unsigned int value)
+{
+    p[0] = value >> 24;
+    p[1] = value >> 16;
+    p[2] = value >> 8;
+    p[3] = value;
+}
+
+static void writeChunk(FILE *f, const char *type, const unsigned char *data, size_t length)
+{
+    unsigned char word[4];
+    unsigned int crc;
+
+    put32(word, (unsigned int)length);
+    fwrite(word, 4, 1, f);
+    fwrite(type, 4, 1, f);
+    fwrite(data, 1, length, f);
+
+    crc = crc32(crc32(0, (const unsigned char *)type, 4), data, length);
+    put32(word, crc);
+    fwrite(word, 4, 1, f);
+}
+
+/*
+    writePNG
+    ---
+    Save 32-bit ARGB pixels as an 8-bit RGB PNG. Returns 1 on success.
+*/
+int writePNG(const char *fileName, const unsigned int *pixels, int width, int height)
+{
+    static const unsigned char signature[8] = {0x89, 'P', 'N', 'G', '\r', '\n', 0x1A, '\n'};
+    size_t rawLength = (size_t)height * (1 + width * 3);
+    size_t blocks = (rawLength + 0xFFFE) / 0xFFFF;
+    unsigned char *raw = malloc(rawLength);
+    unsigned char *zlib = malloc(2 + rawLength + blocks * 5 + 4);
+    unsigned char header[13];
+    unsigned int adlerA = 1, adlerB = 0;
+    size_t i, length = 0;
+    FILE *f;
+    int x, y;
+
+    if (raw == NULL || zlib == NULL)
+    {
+        free(raw);
+        free(zlib);
+        return 0;
+    }
+
+    // Scanlines, each with filter type 0 (none)
+    for (y = 0; y < height; y++)
+    {
+        unsigned char *row = raw + (size_t)y * (1 + width * 3);
+        row[0] = 0;
+        for (x = 0; x < width; x++)
+        {
+            unsigned int pixel = pixels[y * width + x];
+            row[1 + x * 3] = pixel >> 16;
+            row[2 + x * 3] = pixel >> 8;
+            row[3 + x * 3] = pixel;
+        }
+    }
+
+    // zlib stream of stored (uncompressed) deflate blocks
+    zlib[length++] = 0x78;
+    zlib[length++] = 0x01;
+    for (i = 0; i < rawLength; i += 0xFFFF)
+    {
+        size_t blockLength = rawLength - i < 0xFFFF ? rawLength - i : 0xFFFF;
+
+        zlib[length++] = i + blockLength == rawLength; // BFINAL, BTYPE 00
+        zlib[length++] = blockLength & 0xFF;
+        zlib[length++] = blockLength >> 8;
+        zlib[length++] = ~blockLength & 0xFF;
+        zlib[length++] = (~blockLength >> 8) & 0xFF;
+        memcpy(zlib + length, raw + i, blockLength);
+        length += blockLength;
+    }
+    for (i = 0; i < rawLength; i++)
+    {
+        adlerA = (adlerA + raw[i]) % 65521;
+        adlerB = (adlerB + adlerA) % 65521;
+    }
+    put32(zlib + length, (adlerB << 16) | adlerA);
+    length += 4;
+
+    put32(header, width);
+    put32(header + 4, height);
+    header[8] = 8;  // Bit depth
+    header[9] = 2;  // Truecolour
+    header[10] = 0; // Deflate
+    header[11] = 0; // Adaptive filtering
+    header[12] = 0; // Not interlaced
+
+    f = fopen(fileName, "wb");
+    if (f != NULL)
+    {
+        fwrite(signature, sizeof(signature), 1, f);
+        writeChunk(f, "IHDR", header, sizeof(header));
+        writeChunk(f, "IDAT", zlib, length);
+        writeChunk(f, "IEND", NULL, 0);
+        fclose(f);
+    }
+    else
+        printf("Failed to open \"%s\".\n", fileName);
+
+    free(raw);
+    free(zlib);
+    return f != NULL;
+}
+
+/*
+    startHashLog
+    ---
+    Write the hash of every frame to 'fileName'. The log can be used as a golden list later.
+*/
+int startHashLog(const char *fileName)
+{
+    frameHash.log = fopen(fileName, "w");
+    if (frameHash.log == NULL)
+    {
+        printf("Failed to open hash log \"%s\".\n", fileName);
+        return 0;
+    }
+
+    frameHash.enabled = 1;
+    return 1;
+}
+
+/*
+    loadGolden
+    ---
+    Read a hash log from a known good run. Frames missing from it aren't checked.
+*/
+int loadGolden(const char *fileName)
+{
+    FILE *f = fopen(fileName, "r");
+    unsigned long frame;
+    unsigned long long hash;
+    unsigned long capacity = 0;
+    char line[128];
+
+    if (f == NULL)
+    {
+        printf("Failed to open golden hash list \"%s\".\n", fileName);
+        return 0;
+    }
+
+    while (fgets(line, sizeof(line), f))
+    {
+        if (sscanf(line, "%lu %llx", &frame, &hash) != 2)
+            continue;
+
+        if (frame >= capacity)
+        {
+            unsigned long newCapacity = capacity ? capacity : 4096;
+            while (newCapacity <= frame)
+                newCapacity *= 2;
+
+            frameHash.golden = realloc(frameHash.golden, newCapacity * sizeof(frameHash.golden[0]));
+            frameHash.goldenKnown = realloc(frameHash.goldenKnown, newCapacity);
+            if (frameHash.golden == NULL || frameHash.goldenKnown == NULL)
+            {
+                printf("Out of memory reading \"%s\".\n", fileName);
+                fclose(f);
+                return 0;
+            }
+            memset(frameHash.goldenKnown + capacity, 0, newCapacity - capacity);
+            capacity = newCapacity;
+        }
+
+        frameHash.golden[frame] = hash;
+        frameHash.goldenEntries += !frameHash.goldenKnown[frame];
+        frameHash.goldenKnown[frame] = 1;
+        if (frame + 1 > frameHash.goldenCount)
+            frameHash.goldenCount = frame + 1;
+    }
+
+    fclose(f);
+
+    if (frameHash.goldenCount == 0)
+    {
+        printf("No hashes in \"%s\".\n", fileName);
+        return 0;
+    }
+
+    printf("Loaded %lu golden frame hashes.\n", frameHash.goldenEntries);
+    frameHash.enabled = 1;
+    return 1;
+}
+
+/*
+    setFrameDumps
+    ---
+    Parse a list of frames to dump, like "60,120,300-310".
+*/
+int setFrameDumps(const char *list)
+{
+    char *end;
+
+    while (*list != '\0')
+    {
+        struct frameRange *range = &frameHash.dumps[frameHash.dumpCount];
+
+        if (frameHash.dumpCount == FRAME_DUMP_RANGES)
+        {
+            printf("Too many frame dump ranges (at most %d).\n", FRAME_DUMP_RANGES);
+            return 0;
+        }
+
+        range->first = strtoul(list, &end, 10);
+        range->last = range->first;
+        if (end == list)
+        {
+            printf("Bad frame list \"%s\".\n", list);
+            return 0;
+        }
+        if (*end == '-')
+        {
+            list = end + 1;
+            range->last = strtoul(list, &end, 10);
+            if (end == list || range->last < range->first)
+            {
+                printf("Bad frame range in \"%s\".\n", list);
+                return 0;
+            }
+        }
+
+        frameHash.dumpCount++;
+        list = *end == ',' ? end + 1 : end;
+        if (*end != ',' && *end != '\0')
+        {
+            printf("Bad frame list \"%s\".\n", end);
+            return 0;
+        }
+    }
+
+    frameHash.enabled = 1;
+    return 1;
+}
+
+static void dumpFrame(const char *prefix, const unsigned int *pixels)
+{
+    char name[64];
+    FILE *f;
+
+    if (!frameHash.dumpRaw)
+    {
+        sprintf(name, "%s_%lu.png", prefix, frameHash.frame);
+        writePNG(name, pixels, SCREEN_WIDTH, SCREEN_HEIGHT);
+        return;
+    }
+
+    sprintf(name, "%s_%lu.raw", prefix, frameHash.frame);
+    f = fopen(name, "wb");
+    if (f == NULL)
+    {
+        printf("Failed to open \"%s\".\n", name);
+        return;
+    }
+    fwrite(pixels, sizeof(pixels[0]), SCREEN_WIDTH * SCREEN_HEIGHT, f);
+    fclose(f);
+}
+
+/*
+    frameHashEndFrame
+    ---
+    Called at VBLANK with the frame the GPU just finished, before it is handed to the display.
+*/
+void frameHashEndFrame(const unsigned int *pixels)
+{
+    unsigned int i;
+
+    frameHash.hash = xxh64(pixels, SCREEN_WIDTH * SCREEN_HEIGHT * sizeof(pixels[0]), 0);
+
+    if (frameHash.log != NULL)
+        fprintf(frameHash.log, "%lu %016llx\n", frameHash.frame, frameHash.hash);
+
+    for (i = 0; i < frameHash.dumpCount; i++)
+    {
+        if (frameHash.frame >= frameHash.dumps[i].first && frameHash.frame <= frameHash.dumps[i].last)
+        {
+            dumpFrame("frame", pixels);
+            break;
+        }
+    }
+
+    if (frameHash.golden != NULL && frameHash.mismatch < 0)
+    {
+        int known = frameHash.frame < frameHash.goldenCount && frameHash.goldenKnown[frameHash.frame];
+
+        if (known && frameHash.golden[frameHash.frame] != frameHash.hash)
+        {
+            printf("Frame %lu differs from the golden list: %016llx, expected %016llx.\n", frameHash.frame,
+                   frameHash.hash, frameHash.golden[frameHash.frame]);
+            frameHash.mismatch = frameHash.frame;
+            dumpFrame("golden", pixels);
+            atomic_store(&emulationRunning, 0);
+        }
+        else
+        {
+            frameHash.goldenMatched += known;
+
+            // Nothing left to compare against
+            if (frameHash.frame + 1 == frameHash.goldenCount)
+                atomic_store(&emulationRunning, 0);
+        }
+    }
+
+    frameHash.frame++;
+}
+
+/*
+    stopFrameHash
+    ---
+    Close the log and report how the golden comparison went. Returns 0 if a golden log was given and
+    a frame didn't match or the run stopped before its last frame, 1 otherwise.
+*/
+int stopFrameHash(void)
+{
+    int passed = 1;
+
+    if (frameHash.log != NULL)
+    {
+        fclose(frameHash.log);
+        frameHash.log = NULL;
+    }
+
+    if (frameHash.golden != NULL)
+    {
+        passed = frameHash.mismatch < 0 && frameHash.frame >= frameHash.goldenCount;
+
+        if (frameHash.mismatch >= 0)
+            printf("Golden: FAILED at frame %ld.\n", frameHash.mismatch);
+        else
+            printf("Golden: %s, %lu of %lu frames matched.\n", frameHash.frame >= frameHash.goldenCount ? "PASSED" : "STOPPED EARLY",
+                   frameHash.goldenMatched, frameHash.goldenEntries);
+
+        free(frameHash.golden);
+        free(frameHash.goldenKnown);
+        frameHash.golden = NULL;
+        frameHash.goldenKnown = NULL;
+    }
+
+    frameHash.enabled = 0;
+    return passed;
+}
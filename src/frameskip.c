@@ -0,0 +1,64 @@
+/*
+    NAME: TMC
+    INIT DATE: 19/10/2026
+    LAST EDIT DATE: 19/10/2026
+    DESC:
+        Decides which emulated frames get rendered. See 'include/frameskip.h'.
+*/
+
+#include "../include/frameskip.h"
+#include <SDL2/SDL.h>
+
+// How often the host display wants a new frame in turbo mode
+#define FRAMESKIP_TURBO_RATE 60
+
+struct frameskip frameskip = {FRAMESKIP_OFF, 1, 0, 1, 0};
+
+/*
+    setFrameskip
+    ---
+    Select the frame skipping mode. 'interval' is only used for FRAMESKIP_FIXED, where 1 frame in
+    every 'interval' is rendered (an interval of 0 or 1 renders every frame).
+*/
+void setFrameskip(enum frameskipMode mode, unsigned int interval)
+{
+    frameskip.mode = mode;
+    frameskip.interval = interval ? interval : 1;
+    frameskip.counter = 0;
+    frameskip.renderFrame = 1; // Always render the first frame after a change
+    frameskip.lastFrame = SDL_GetPerformanceCounter();
+}
+
+/*
+    frameskipEndFrame
+    ---
+    Called once the GPU has finished a frame (entered VBLANK). Works out if the NEXT frame should
+    run the pixel pipeline or not.
+*/
+void frameskipEndFrame(void)
+{
+    unsigned long long now;
+
+    switch (frameskip.mode)
+    {
+    case FRAMESKIP_OFF:
+        frameskip.renderFrame = 1;
+        break;
+
+    case FRAMESKIP_FIXED:
+        frameskip.counter++;
+        frameskip.renderFrame = (frameskip.counter >= frameskip.interval);
+        if (frameskip.renderFrame)
+            frameskip.counter = 0;
+        break;
+
+    case FRAMESKIP_TURBO:
+        // Only render when the host display would actually show a new frame. Checking the clock once
+        // a frame is cheap enough to not matter.
+        now = SDL_GetPerformanceCounter();
+        frameskip.renderFrame = (now - frameskip.lastFrame) >= SDL_GetPerformanceFrequency() / FRAMESKIP_TURBO_RATE;
+        if (frameskip.renderFrame)
+            frameskip.lastFrame = now;
+        break;
+    }
+}
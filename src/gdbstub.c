@@ -0,0 +1,670 @@
+/*
+    NAME: TMC
+    INIT DATE: 19/10/2026
+    LAST EDIT DATE: 19/10/2026
+    DESC:
+        GDB remote serial protocol stub. See 'include/gdbstub.h'.
+
+        Everything here runs on the emulation thread. While the machine runs, the socket is only looked
+        at once a frame (gdbPoll) for a new debugger or a Ctrl-C. While it is stopped, gdbStop sits in
+        a loop answering packets until the debugger continues or single steps.
+*/
+
+#include "../include/gdbstub.h"
+#include "../include/breakpoint.h"
+#include "../include/registers.h"
+#include "../include/memory.h"
+#include "../include/machine.h"
+#include "../include/main.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#ifdef _WIN32
+#include <winsock2.h>
+#include <ws2tcpip.h>
+typedef SOCKET gdbSocket;
+#define closeSocket closesocket
+#else
+#include <sys/socket.h>
+#include <sys/select.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <arpa/inet.h>
+#include <unistd.h>
+typedef int gdbSocket;
+#define INVALID_SOCKET (-1)
+#define closeSocket close
+#endif
+
+#define GDB_WAIT_MS 100 // How often a stopped machine checks whether the emulator is closing
+#define GDB_REGISTERS 13
+
+unsigned char gdbEnabled;
+
+static gdbSocket listenSocket = INVALID_SOCKET;
+static gdbSocket clientSocket = INVALID_SOCKET;
+static unsigned char noAck;   // After QStartNoAckMode, packets aren't acknowledged
+static unsigned char resumed; // The debugger is waiting to hear why the machine stopped
+
+static unsigned char receiveBuffer[GDB_PACKET_SIZE];
+static int receiveLength;
+static int receivePosition;
+
+static const char hexDigits[] = "0123456789abcdef";
+
+/*
+    SOCKETS
+*/
+
+/*
+    startGdbStub
+    ---
+    Listen for a debugger on 127.0.0.1:port. The machine stops before the first instruction until one
+    connects. Returns 1 on success.
+*/
+int startGdbStub(unsigned short port)
+{
+    struct sockaddr_in address;
+    int yes = 1;
+
+#ifdef _WIN32
+    WSADATA wsaData;
+    if (WSAStartup(MAKEWORD(2, 2), &wsaData) != 0)
+    {
+        printf("Failed to start Winsock.\n");
+        return 0;
+    }
+#endif
+
+    listenSocket = socket(AF_INET, SOCK_STREAM, 0);
+    if (listenSocket == INVALID_SOCKET)
+    {
+        printf("Failed to create the GDB socket.\n");
+        return 0;
+    }
+
+    setsockopt(listenSocket, SOL_SOCKET, SO_REUSEADDR, (const char *)&yes, sizeof(yes));
+
+    memset(&address, 0, sizeof(address));
+    address.sin_family = AF_INET;
+    address.sin_addr.s_addr = htonl(INADDR_LOOPBACK); // Never reachable from other machines
+    address.sin_port = htons(port);
+
+    if (bind(listenSocket, (struct sockaddr *)&address, sizeof(address)) != 0 || listen(listenSocket, 1) != 0)
+    {
+        printf("Failed to listen for GDB on port %u.\n", port);
+        closeSocket(listenSocket);
+        listenSocket = INVALID_SOCKET;
+        return 0;
+    }
+
+    printf("Waiting for GDB on 127.0.0.1:%u...\n", port);
+
+    gdbEnabled = 1;
+    debugModeEnable = 1; // Stop before the first instruction
+    updateDebugActive();
+    return 1;
+}
+
+// Wait up to 'ms' for 'socket' to have something to read (or a connection to accept)
+static int waitReadable(gdbSocket socket, int ms)
+{
+    fd_set set;
+    struct timeval timeout;
+
+    FD_ZERO(&set);
+    FD_SET(socket, &set);
+    timeout.tv_sec = ms / 1000;
+    timeout.tv_usec = (ms % 1000) * 1000;
+
+    return select((int)socket + 1, &set, NULL, NULL, &timeout) > 0;
+}
+
+static void acceptClient(void)
+{
+    int yes = 1;
+
+    clientSocket = accept(listenSocket, NULL, NULL);
+    if (clientSocket == INVALID_SOCKET)
+        return;
+
+    // Packets are tiny and every one waits for an answer, so don't let them sit in Nagle's buffer
+    setsockopt(clientSocket, IPPROTO_TCP, TCP_NODELAY, (const char *)&yes, sizeof(yes));
+
+    noAck = 0;
+    resumed = 0;
+    receiveLength = 0;
+    receivePosition = 0;
+    printf("GDB connected.\n");
+}
+
+static void closeClient(void)
+{
+    if (clientSocket != INVALID_SOCKET)
+    {
+        closeSocket(clientSocket);
+        clientSocket = INVALID_SOCKET;
+        printf("GDB disconnected.\n");
+    }
+}
+
+static void sendAll(const char *data, int length)
+{
+    int sent;
+
+    while (length > 0 && clientSocket != INVALID_SOCKET)
+    {
+        sent = send(clientSocket, data, length, 0);
+        if (sent <= 0)
+        {
+            closeClient();
+            return;
+        }
+
+        data += sent;
+        length -= sent;
+    }
+}
+
+/*
+    readChar
+    ---
+    Next byte from the debugger. Blocks (checking every GDB_WAIT_MS that the emulator isn't closing).
+    Returns -1 if the debugger goes away or the emulator is closing.
+*/
+static int readChar(void)
+{
+    while (receivePosition == receiveLength)
+    {
+        if (clientSocket == INVALID_SOCKET || !atomic_load(&emulationRunning))
+            return -1;
+
+        if (!waitReadable(clientSocket, GDB_WAIT_MS))
+            continue;
+
+        receiveLength = recv(clientSocket, (char *)receiveBuffer, sizeof(receiveBuffer), 0);
+        receivePosition = 0;
+        if (receiveLength <= 0)
+        {
+            receiveLength = 0;
+            closeClient();
+            return -1;
+        }
+    }
+
+    return receiveBuffer[receivePosition++];
+}
+
+/*
+    PACKETS
+*/
+
+static int hexValue(char c)
+{
+    if (c >= '0' && c <= '9')
+        return c - '0';
+    if (c >= 'a' && c <= 'f')
+        return c - 'a' + 10;
+    if (c >= 'A' && c <= 'F')
+        return c - 'A' + 10;
+    return -1;
+}
+
+/*
+    readPacket
+    ---
+    Read one "$data#checksum" packet into 'packet' (null terminated) and acknowledge it. A Ctrl-C is
+    returned as a packet of just 0x03. Returns -1 if the debugger goes away.
+*/
+static int readPacket(char *packet)
+{
+    int c;
+    int length;
+    unsigned char sum;
+    int high;
+    int low;
+
+    for (;;)
+    {
+        // Skip acks and anything else until the start of a packet
+        do
+        {
+            c = readChar();
+            if (c < 0)
+                return -1;
+            if (c == 0x03)
+            {
+                packet[0] = 0x03;
+                packet[1] = '\0';
+                return 1;
+            }
+        } while (c != '$');
+
+        length = 0;
+        sum = 0;
+        while ((c = readChar()) != '#')
+        {
+            if (c < 0)
+                return -1;
+            if (length < GDB_PACKET_SIZE - 1)
+                packet[length++] = (char)c;
+            sum += (unsigned char)c;
+        }
+        packet[length] = '\0';
+
+        high = hexValue((char)readChar());
+        low = hexValue((char)readChar());
+
+        if (noAck)
+            return length;
+
+        if (high >= 0 && low >= 0 && ((high << 4) | low) == sum)
+        {
+            sendAll("+", 1);
+            return length;
+        }
+
+        sendAll("-", 1); // Ask for it again
+    }
+}
+
+static void sendPacket(const char *data)
+{
+    static char packet[GDB_PACKET_SIZE + 4];
+    unsigned char sum = 0;
+    int length = 0;
+
+    packet[length++] = '$';
+    while (*data != '\0' && length < GDB_PACKET_SIZE)
+    {
+        sum += (unsigned char)*data;
+        packet[length++] = *data++;
+    }
+    packet[length++] = '#';
+    packet[length++] = hexDigits[sum >> 4];
+    packet[length++] = hexDigits[sum & 0xF];
+
+    // GDB's acks are skipped by readPacket, a lost packet is just sent again by GDB
+    sendAll(packet, length);
+}
+
+// Read up to 'digits' hex digits (0 = as many as there are) from '*text'
+static unsigned long parseHex(const char **text, int digits)
+{
+    unsigned long value = 0;
+    int count = 0;
+    int digit;
+
+    while ((digit = hexValue(**text)) >= 0 && (digits == 0 || count < digits))
+    {
+        value = (value << 4) | digit;
+        (*text)++;
+        count++;
+    }
+
+    return value;
+}
+
+// Registers go over the wire as little endian 16 bit values
+static void writeHex16(char *out, unsigned short value)
+{
+    out[0] = hexDigits[(value >> 4) & 0xF];
+    out[1] = hexDigits[value & 0xF];
+    out[2] = hexDigits[(value >> 12) & 0xF];
+    out[3] = hexDigits[(value >> 8) & 0xF];
+}
+
+static unsigned short parseHex16(const char **text)
+{
+    unsigned short low = (unsigned short)parseHex(text, 2);
+    return low | (unsigned short)(parseHex(text, 2) << 8);
+}
+
+static unsigned short *gdbRegister(int number)
+{
+    switch (number)
+    {
+    case 0: return &registers.af;
+    case 1: return &registers.bc;
+    case 2: return &registers.de;
+    case 3: return &registers.hl;
+    case 4: return &registers.sp;
+    case 5: return &registers.pc;
+    }
+
+    return NULL; // IX, IY, the alternate set & IR don't exist on the Game Boy
+}
+
+static void sendStopReply(void)
+{
+    char reply[32];
+
+    if (watchHitType)
+    {
+        sprintf(reply, "T05%s:%04x;", watchHitType == WATCH_READ ? "rwatch" : "watch", watchHitAddress);
+        watchHitType = 0;
+        sendPacket(reply);
+    }
+    else
+        sendPacket("S05");
+}
+
+/*
+    setGdbBreakpoint
+    ---
+    Z & z packets: "type,address,kind". Types 0 & 1 are breakpoints, 2 = write, 3 = read & 4 = access
+    watchpoints.
+*/
+static void setGdbBreakpoint(const char *packet, int set)
+{
+    const char *text = packet + 1;
+    unsigned long type = parseHex(&text, 1);
+    unsigned long address;
+    unsigned short bank;
+    unsigned char watchType;
+
+    if (*text++ != ',')
+    {
+        sendPacket("E01");
+        return;
+    }
+    address = parseHex(&text, 0);
+
+    if (type <= 1)
+    {
+        bank = address > 0xFFFF ? (unsigned short)(address >> 16) : romBank;
+        if (set)
+        {
+            if (!setBreakpoint(bank, (unsigned short)address))
+            {
+                sendPacket("E02");
+                return;
+            }
+        }
+        else
+            clearBreakpoint(bank, (unsigned short)address);
+
+        sendPacket("OK");
+        return;
+    }
+
+    if (type > 4)
+    {
+        sendPacket(""); // Not supported
+        return;
+    }
+
+    watchType = type == 2 ? WATCH_WRITE : type == 3 ? WATCH_READ : WATCH_READ | WATCH_WRITE;
+    if (set)
+        setWatchpoint((unsigned short)address, watchType);
+    else
+        clearWatchpoint((unsigned short)address, watchType);
+
+    sendPacket("OK");
+}
+
+/*
+    handlePacket
+    ---
+    Answer one packet. Returns 1 when the machine should carry on running (continue, step, detach).
+*/
+static int handlePacket(char *packet)
+{
+    static char reply[GDB_PACKET_SIZE];
+    const char *text = packet + 1;
+    unsigned short *value;
+    unsigned long address;
+    unsigned long length;
+    unsigned long i;
+    int number;
+
+    switch (packet[0])
+    {
+    case '?':
+        sendStopReply();
+        return 0;
+
+    case 'g':
+        for (number = 0; number < GDB_REGISTERS; number++)
+        {
+            value = gdbRegister(number);
+            writeHex16(reply + number * 4, value ? *value : 0);
+        }
+        reply[GDB_REGISTERS * 4] = '\0';
+        sendPacket(reply);
+        return 0;
+
+    case 'G':
+        for (number = 0; number < GDB_REGISTERS && hexValue(*text) >= 0; number++)
+        {
+            unsigned short newValue = parseHex16(&text);
+            value = gdbRegister(number);
+            if (value)
+                *value = newValue;
+        }
+        sendPacket("OK");
+        return 0;
+
+    case 'p':
+        number = (int)parseHex(&text, 0);
+        value = gdbRegister(number);
+        writeHex16(reply, value ? *value : 0);
+        reply[4] = '\0';
+        sendPacket(reply);
+        return 0;
+
+    case 'P':
+        number = (int)parseHex(&text, 0);
+        if (*text++ == '=')
+        {
+            unsigned short newValue = parseHex16(&text);
+            value = gdbRegister(number);
+            if (value)
+                *value = newValue;
+        }
+        sendPacket("OK");
+        return 0;
+
+    case 'm':
+        address = parseHex(&text, 0);
+        text++;
+        length = parseHex(&text, 0);
+        if (length > (GDB_PACKET_SIZE - 1) / 2)
+            length = (GDB_PACKET_SIZE - 1) / 2;
+
+        for (i = 0; i < length; i++)
+        {
+            unsigned char byte = peekByte((unsigned short)(address + i));
+            reply[i * 2] = hexDigits[byte >> 4];
+            reply[i * 2 + 1] = hexDigits[byte & 0xF];
+        }
+        reply[length * 2] = '\0';
+        sendPacket(reply);
+        return 0;
+
+    case 'M':
+        address = parseHex(&text, 0);
+        text++;
+        length = parseHex(&text, 0);
+        if (*text++ != ':')
+        {
+            sendPacket("E01");
+            return 0;
+        }
+
+        for (i = 0; i < length && hexValue(text[0]) >= 0 && hexValue(text[1]) >= 0; i++)
+            pokeByte((unsigned short)(address + i), (unsigned char)parseHex(&text, 2));
+        sendPacket("OK");
+        return 0;
+
+    case 'c':
+    case 's':
+        if (hexValue(*text) >= 0)
+            registers.pc = (unsigned short)parseHex(&text, 0);
+
+        // A step stops again before the next instruction, a continue only at a breakpoint or Ctrl-C
+        debugModeEnable = packet[0] == 's';
+        updateDebugActive();
+        resumed = 1;
+        return 1;
+
+    case 'Z':
+    case 'z':
+        setGdbBreakpoint(packet, packet[0] == 'Z');
+        return 0;
+
+    case 'D':
+        sendPacket("OK");
+        closeClient();
+        debugModeEnable = 0;
+        updateDebugActive();
+        return 1;
+
+    case 'k':
+        closeClient();
+        debugModeEnable = 0;
+        updateDebugActive();
+        atomic_store(&emulationRunning, 0);
+        return 1;
+
+    case 'H':
+        sendPacket("OK"); // There is only one thread
+        return 0;
+
+    case 'q':
+        if (!strncmp(packet, "qSupported", 10))
+            sprintf(reply, "PacketSize=%x;QStartNoAckMode+", GDB_PACKET_SIZE);
+        else if (!strcmp(packet, "qAttached"))
+            strcpy(reply, "1");
+        else if (!strcmp(packet, "qC"))
+            strcpy(reply, "QC1");
+        else
+            reply[0] = '\0';
+        sendPacket(reply);
+        return 0;
+
+    case 'Q':
+        if (!strcmp(packet, "QStartNoAckMode"))
+        {
+            sendPacket("OK");
+            noAck = 1;
+        }
+        else
+            sendPacket("");
+        return 0;
+
+    case 0x03:
+        return 0; // Already stopped
+
+    default:
+        sendPacket(""); // Anything else isn't supported
+        return 0;
+    }
+}
+
+/*
+    gdbPoll
+    ---
+    Called once a frame while the machine runs. Picks up a newly connected debugger, or a Ctrl-C from
+    the current one, and stops the machine before its next instruction.
+*/
+void gdbPoll(void)
+{
+    int length;
+    int i;
+
+    if (clientSocket == INVALID_SOCKET)
+    {
+        if (listenSocket != INVALID_SOCKET && waitReadable(listenSocket, 0))
+        {
+            acceptClient();
+            debugModeEnable = 1;
+            updateDebugActive();
+        }
+        return;
+    }
+
+    if (!waitReadable(clientSocket, 0))
+        return;
+
+    length = recv(clientSocket, (char *)receiveBuffer, sizeof(receiveBuffer), 0);
+    receiveLength = 0;
+    receivePosition = 0;
+    if (length <= 0)
+    {
+        closeClient();
+        return;
+    }
+
+    // Only a Ctrl-C is expected while running, anything else is dropped
+    for (i = 0; i < length; i++)
+    {
+        if (receiveBuffer[i] == 0x03)
+        {
+            debugModeEnable = 1;
+            updateDebugActive();
+        }
+    }
+}
+
+/*
+    gdbStop
+    ---
+    Called by the CPU core's step instead of the debug message box while the stub is enabled. Blocks,
+    answering the debugger, until it says to carry on. With no debugger connected yet this waits for one.
+*/
+void gdbStop(void)
+{
+    char packet[GDB_PACKET_SIZE];
+
+    while (clientSocket == INVALID_SOCKET)
+    {
+        if (!atomic_load(&emulationRunning))
+            return;
+
+        if (waitReadable(listenSocket, GDB_WAIT_MS))
+            acceptClient();
+    }
+
+    // The debugger is waiting for the result of its last step/continue
+    if (resumed)
+    {
+        resumed = 0;
+        sendStopReply();
+    }
+
+    for (;;)
+    {
+        if (readPacket(packet) < 0)
+        {
+            // Debugger gone (or the emulator is closing): let the machine run
+            debugModeEnable = 0;
+            updateDebugActive();
+            return;
+        }
+
+        if (handlePacket(packet))
+            return;
+    }
+}
+
+void closeGdbStub(void)
+{
+    if (!gdbEnabled)
+        return;
+
+    closeClient();
+
+    if (listenSocket != INVALID_SOCKET)
+    {
+        closeSocket(listenSocket);
+        listenSocket = INVALID_SOCKET;
+    }
+
+#ifdef _WIN32
+    WSACleanup();
+#endif
+
+    gdbEnabled = 0;
+}
@@ -2,52 +2,140 @@
 #include "../include/cpu.h"
 #include "../include/interupts.h"
 #include "../include/main.h"
+#include "../include/memory.h"
+#include "../include/display.h"
+#include "../include/frameskip.h"
+#include "../include/palette.h"
+#include "../include/cgb.h"
 #include <stdio.h>
+#include <string.h>
 
 struct gpu gpu;
 
-unsigned char tiles[384][8][8];
+unsigned char tiles[TILE_COUNT][8][8];
+unsigned char packedTiles[TILE_COUNT][8][2];
+unsigned int tileStamps[TILE_COUNT][8];
 
-void stepGPU(void)
+/*
+    The background cache. Each tile map is drawn into its own 256x256 plane of finished pixels (and
+    colour numbers, for sprite priority), one 8 pixel strip (a row of one map cell) at a time, and only
+    when something the strip was drawn from has changed since:
+        - the tile index in the map, after the tile data select bit (LCDC bit 4) is applied
+        - that row of the tile, via the stamp 'updateTile' gives every tile row it decodes
+        - BGP, or on a CGB the cell's attribute byte and the colour palette it picks
+    A scanline is then a check of the strips it crosses and one or two memcpys out of the plane.
+
+    Stamps come from a counter that is never rewound, not even by loading a state, so a stamp only ever
+    matches the tile row it was taken from. 'tileStamps' is in save states, the planes aren't.
+*/
+struct strip
+{
+    unsigned short tile; // 0 - 767, or STRIP_INVALID
+    unsigned char palette; // BGP, or the CGB attribute byte
+    unsigned int stamp;
+    unsigned int colours; // CGB: the stamp of the colour palette it was drawn with
+};
+
+#define STRIP_INVALID 0xFFFF
+
+static unsigned int planes[2][256][256];
+static unsigned char planeColours[2][256][256];
+static struct strip strips[2][256][32];
+static unsigned int nextStamp;
+
+/*
+    setGpuMode
+    ---
+    Move to a new mode, raising LCDSTAT if STAT asks for it.
+*/
+void setGpuMode(enum gpuMode mode)
+{
+    static const unsigned char modeInterrupts[4] = {
+        [GPU_MODE_HBLANK] = GPU_STATUS_HBLANKINT,
+        [GPU_MODE_VBLANK] = GPU_STATUS_VBLANKINT,
+        [GPU_MODE_OAM] = GPU_STATUS_OAMINT,
+    };
+
+    gpu.mode = mode;
+
+    // HBLANK DMA moves a block whenever a visible line's HBLANK starts
+    if (mode == GPU_MODE_HBLANK && cgb.hdmaActive)
+        cgbHblank();
+
+    if ((gpu.status & modeInterrupts[mode]) && (interrupt.enable & INTERRUPTS_LCDSTAT))
+        interrupt.flags |= INTERRUPTS_LCDSTAT;
+}
+
+// LY has changed (or LYC has), raise LCDSTAT if they now match and STAT asks for it
+static void compareLine(void)
 {
-    enum gpuMode
+    if (gpu.scanline == gpu.lyCompare && (gpu.status & GPU_STATUS_COINCIDENCEINT) && (interrupt.enable & INTERRUPTS_LCDSTAT))
+        interrupt.flags |= INTERRUPTS_LCDSTAT;
+}
+
+/*
+    endScanline
+    ---
+    HBLANK is over. Move on to the next line, or into VBLANK after the last one. Shared by the PPU
+    engines (see ppu.h), they only differ in how long mode 3 takes and how its pixels are made.
+*/
+void endScanline(void)
+{
+    hblank();
+
+    if (gpu.scanline == 144)
     {
-        GPU_MODE_HBLANK = 0,
-        GPU_MODE_VBLANK = 1,
-        GPU_MODE_OAM = 2,
-        GPU_MODE_VRAM = 3,
-    } static gpuMode = GPU_MODE_HBLANK;
+        if (interrupt.enable & INTERRUPTS_VBLANK)
+            interrupt.flags |= INTERRUPTS_VBLANK;
 
-    // This variable will always update to be what the CPU ticks were last time this function was called
-    static int lastTicks = 0;
+        // The frame is finished whether or not its pixels were drawn, so the timing above is
+        // the same in every frameskip mode.
+        gpu.frameComplete = 1;
+
+        setGpuMode(GPU_MODE_VBLANK);
+    }
 
+    else
+        setGpuMode(GPU_MODE_OAM);
+}
+
+// One of the 10 VBLANK lines is over
+void endVblankLine(void)
+{
+    gpu.scanline++;
+
+    if (gpu.scanline > 153)
+    {
+        gpu.scanline = 0;
+        gpu.windowLine = 0; // The window starts again from its top line every frame
+        setGpuMode(GPU_MODE_OAM);
+    }
+
+    compareLine();
+}
+
+/*
+    stepGPU
+    ---
+    The fast PPU engine. Mode 3 always takes 172 ticks and the whole line is drawn at the end of it.
+*/
+void stepGPU(void)
+{
     // Update GPU tick to be the difference between the current CPU ticks & the CPU ticks last this was called
-    gpu.tick += ticks - lastTicks;
+    // (gpu.lastTicks always holds what the CPU ticks were last time this function was called)
+    gpu.tick += ticks - gpu.lastTicks;
 
     // Update lastTicks with CPU ticks
-    lastTicks = ticks;
+    gpu.lastTicks = ticks;
 
     // Based on which CPU mode, execute...
-    switch (gpuMode)
+    switch (gpu.mode)
     {
     case GPU_MODE_HBLANK:
         if (gpu.tick >= 204)
         {
-            printf("hblank. gpu.tick: %x \n", gpu.tick);
-            hblank();
-
-            if (gpu.scanline == 144)
-            {
-                if (interrupt.enable & INTERRUPTS_VBLANK)
-                    interrupt.flags |= INTERRUPTS_VBLANK;
+            endScanline();
 
-                gpuMode = GPU_MODE_VBLANK;
-            }
-
-            else
-                gpuMode = GPU_MODE_OAM;
-
-            printf("-204 gpu.tick \n");
             gpu.tick -= 204;
         }
         break;
@@ -55,16 +143,8 @@ void stepGPU(void)
 
         if (gpu.tick >= 456)
         {
-            printf("vblank! gpu.tick: %x \n", gpu.tick);
-            gpu.scanline++;
+            endVblankLine();
 
-            if (gpu.scanline > 153)
-            {
-                gpu.scanline = 0;
-                gpuMode = GPU_MODE_OAM;
-            }
-
-            printf("-456 gpu.tick \n");
             gpu.tick -= 456;
         }
 
@@ -73,11 +153,8 @@ void stepGPU(void)
     case GPU_MODE_OAM:
         if (gpu.tick >= 80)
         {
-            printf("oam! gpu.tick: %x \n", gpu.tick);
-
-            gpuMode = GPU_MODE_VRAM;
+            gpu.mode = GPU_MODE_VRAM; // There's no STAT interrupt for this one
 
-            printf("-80 gpu.tick \n");
             gpu.tick -= 80;
         }
 
@@ -86,14 +163,12 @@ void stepGPU(void)
     case GPU_MODE_VRAM:
         if (gpu.tick >= 172)
         {
-            printf("vram! gpu.tick: %x \n", gpu.tick);
+            setGpuMode(GPU_MODE_HBLANK);
 
-            gpuMode = GPU_MODE_HBLANK;
+            // Skipped frames still go through every mode above, they just don't produce pixels.
+            if (frameskip.renderFrame)
+                renderScanline();
 
-            // printf("renderScanline() would be called here\n");
-            // renderScanline();
-
-            printf("-172 gpu.tick \n");
             gpu.tick -= 172;
         }
 
@@ -104,4 +179,316 @@ void stepGPU(void)
 void hblank(void)
 {
     gpu.scanline++;
-}
\ No newline at end of file
+    compareLine();
+}
+
+/*
+    readStatus
+    ---
+    STAT (0xFF41). Bit 7 always reads as 1.
+*/
+unsigned char readStatus(void)
+{
+    unsigned char status = 0x80 | gpu.status | gpu.mode;
+
+    if (gpu.scanline == gpu.lyCompare)
+        status |= GPU_STATUS_COINCIDENCE;
+
+    return status;
+}
+
+void writeStatus(unsigned char value)
+{
+    gpu.status = value & GPU_STATUS_WRITABLE;
+}
+
+void writeLyCompare(unsigned char value)
+{
+    gpu.lyCompare = value;
+    compareLine();
+}
+
+/*
+    updateTile
+    ---
+    Taken from Cinoop. Whenever tile data in VRAM (0x8000 - 0x97FF, in either bank) is written, decode
+    that row of the tile into the 'tiles' array so the renderer doesn't have to pull the bits apart
+    every scanline. The row is also packed 4 pixels to a byte for 'palettes.backgroundRow'. 'offset' is
+    where in 'vram' the write went, so bank 1 is from 0x2000.
+*/
+void updateTile(unsigned short offset)
+{
+    unsigned short address = offset & 0x3ffe; // Each row of a tile is 2 bytes, so always start from the first of the pair
+
+    unsigned short tile = ((address & 0x1fff) >> 4) + (address >> 13) * 384;
+    unsigned short y = (address >> 1) & 7;
+
+    unsigned char x;
+    unsigned char bitIndex;
+    for (x = 0; x < 8; x++)
+    {
+        bitIndex = 1 << (7 - x);
+
+        tiles[tile][y][x] = ((vram[address] & bitIndex) ? 1 : 0) + ((vram[address + 1] & bitIndex) ? 2 : 0);
+    }
+
+    for (x = 0; x < 2; x++)
+    {
+        unsigned char *row = tiles[tile][y] + x * 4;
+        packedTiles[tile][y][x] = (row[0] << 6) | (row[1] << 4) | (row[2] << 2) | row[3];
+    }
+
+    tileStamps[tile][y] = ++nextStamp;
+}
+
+/*
+    invalidateBackground
+    ---
+    Throw the whole background cache away, for changes that don't show up in the strips (like the
+    palette theme).
+*/
+void invalidateBackground(void)
+{
+    int map, y, cell;
+
+    for (map = 0; map < 2; map++)
+        for (y = 0; y < 256; y++)
+            for (cell = 0; cell < 32; cell++)
+                strips[map][y][cell].tile = STRIP_INVALID;
+}
+
+/*
+    drawColourStrip
+    ---
+    Draw a CGB strip, with its attribute byte's palette, bank & flips. The colour numbers also get the
+    attribute's priority bit, for 'renderSprites'.
+*/
+static void drawColourStrip(unsigned int *pixels, unsigned char *colours, unsigned short tile, int row, unsigned char attribute)
+{
+    const unsigned int *palette = palettes.cgbBackground[attribute & GPU_ATTRIBUTE_PALETTE];
+    const unsigned char *source = tiles[tile][row];
+    int x;
+
+    for (x = 0; x < 8; x++)
+    {
+        unsigned char colour = source[(attribute & GPU_ATTRIBUTE_XFLIP) ? 7 - x : x];
+
+        pixels[x] = palette[colour];
+        colours[x] = colour | (attribute & GPU_ATTRIBUTE_PRIORITY);
+    }
+}
+
+/*
+    updateStrips
+    ---
+    Redraw whichever of 'count' strips of plane line 'y', from cell 'first' on (wrapping), are out of
+    date.
+*/
+static void updateStrips(int map, int y, int first, int count)
+{
+    const unsigned char *cells = vram + (map ? 0x1c00 : 0x1800) + ((y >> 3) << 5);
+    const unsigned char *attributes = cells + 0x2000; // CGB, in VRAM bank 1
+    unsigned char palette = gpu.backgroundPalette;
+    unsigned int colours = 0;
+    int i;
+
+    for (i = 0; i < count; i++)
+    {
+        int cell = (first + i) & 31;
+        unsigned short tile = cells[cell];
+        struct strip *strip = &strips[map][y][cell];
+        int row = y & 7;
+
+        if (!(gpu.control & GPU_CONTROL_TILESET) && tile < 128)
+            tile += 256;
+
+        if (cgb.enabled)
+        {
+            palette = attributes[cell];
+            colours = palettes.cgbBackgroundStamps[palette & GPU_ATTRIBUTE_PALETTE];
+            if (palette & GPU_ATTRIBUTE_BANK)
+                tile += 384;
+            if (palette & GPU_ATTRIBUTE_YFLIP)
+                row = 7 - row;
+        }
+
+        if (strip->tile == tile && strip->stamp == tileStamps[tile][row] && strip->palette == palette && strip->colours == colours)
+            continue;
+
+        if (cgb.enabled)
+        {
+            drawColourStrip(&planes[map][y][cell * 8], &planeColours[map][y][cell * 8], tile, row, palette);
+        }
+        else
+        {
+            memcpy(&planes[map][y][cell * 8], palettes.backgroundRow[packedTiles[tile][row][0]], sizeof(palettes.backgroundRow[0]));
+            memcpy(&planes[map][y][cell * 8 + 4], palettes.backgroundRow[packedTiles[tile][row][1]], sizeof(palettes.backgroundRow[0]));
+            memcpy(&planeColours[map][y][cell * 8], tiles[tile][row], 8);
+        }
+
+        strip->tile = tile;
+        strip->stamp = tileStamps[tile][row];
+        strip->palette = palette;
+        strip->colours = colours;
+    }
+}
+
+/*
+    renderSprites
+    ---
+    Draws the sprites on the current scanline over the background. Like the DMG, only the first 10
+    sprites in OAM that are on the line are drawn, and where they overlap the one with the smaller X
+    (then the earlier one in OAM) wins. On a CGB the earlier one in OAM always wins.
+
+    Sprites with the priority flag, or over a CGB map cell with it, only show over colour 0 of the
+    background or window. 'background' is the line of the background plane's colour numbers with
+    screen X 0 at 'scroll', 'window' the line of the window's from screen X 'windowStart' on.
+*/
+static void renderSprites(unsigned int *line, const unsigned char *background, int scroll, const unsigned char *window, int windowStart)
+{
+    unsigned char height = (gpu.control & GPU_CONTROL_SPRITEVDOUBLE) ? 16 : 8;
+    const unsigned char *visible[10];
+    int count = 0;
+    int i, j;
+
+    for (i = 0; i < 40 && count < 10; i++)
+    {
+        const unsigned char *sprite = oam + i * 4;
+        int top = sprite[0] - 16;
+
+        if (gpu.scanline >= top && gpu.scanline < top + height)
+        {
+            // Keep 'visible' sorted by X, OAM order breaks ties as it's the order they were found in
+            for (j = count++; j > 0 && !cgb.enabled && visible[j - 1][1] > sprite[1]; j--)
+                visible[j] = visible[j - 1];
+            visible[j] = sprite;
+        }
+    }
+
+    // Lowest priority first, so the winners are drawn last
+    while (count--)
+    {
+        const unsigned char *sprite = visible[count];
+        unsigned char flags = sprite[3];
+        const unsigned int *colours = cgb.enabled ? palettes.cgbSprite[flags & GPU_ATTRIBUTE_PALETTE] : palettes.sprite[(flags >> 4) & 1];
+        int row = gpu.scanline - (sprite[0] - 16);
+        unsigned short tile = sprite[2];
+        const unsigned char *pixels;
+
+        if (flags & 0x40) // Y flip
+            row = height - 1 - row;
+        if (height == 16)
+            tile = (tile & 0xFE) + (row >> 3);
+        if (cgb.enabled && (flags & GPU_ATTRIBUTE_BANK))
+            tile += 384;
+        pixels = tiles[tile][row & 7];
+
+        for (i = 0; i < 8; i++)
+        {
+            int x = sprite[1] - 8 + i;
+            unsigned char colour = pixels[(flags & 0x20) ? 7 - i : i]; // X flip
+            unsigned char under;
+
+            if (x < 0 || x >= SCREEN_WIDTH || colour == 0)
+                continue;
+
+            under = x >= windowStart ? window[x - windowStart] : background[(x + scroll) & 255];
+            if ((under & 3) && ((flags & 0x80) || (under & GPU_ATTRIBUTE_PRIORITY)))
+                continue;
+
+            line[x] = colours[colour];
+        }
+    }
+}
+
+/*
+    renderWindow
+    ---
+    Draw the window over the end of the line, if it's on this line. The window is another view of a
+    tile map plane, with no scrolling of its own: its top left is at (WX - 7, WY) on the screen, and it
+    shows the plane from (0, gpu.windowLine). Returns where it starts on the screen, or SCREEN_WIDTH if
+    it isn't on this line.
+*/
+static int renderWindow(unsigned int *line, const unsigned char **colours)
+{
+    int map = (gpu.control & GPU_CONTROL_WINDOWTILEMAP) ? 1 : 0;
+    int start = gpu.windowX - 7;
+    int skip = 0; // Window pixels off the left of the screen
+
+    if (!(gpu.control & GPU_CONTROL_WINDOWENABLE) || gpu.scanline < gpu.windowY || start >= SCREEN_WIDTH)
+        return SCREEN_WIDTH;
+
+    if (start < 0)
+    {
+        skip = -start;
+        start = 0;
+    }
+
+    updateStrips(map, gpu.windowLine, 0, (SCREEN_WIDTH - start + skip + 7) >> 3);
+    memcpy(line + start, &planes[map][gpu.windowLine][skip], (SCREEN_WIDTH - start) * sizeof(line[0]));
+    *colours = &planeColours[map][gpu.windowLine][skip];
+
+    gpu.windowLine++;
+    return start;
+}
+
+/*
+    renderScanline
+    ---
+    Draws the current scanline into the framebuffer. This is the pixel pipeline, so it is the only
+    part of the GPU that is skipped on frames that won't be shown.
+
+    The background & window come out of the cache above, the background wrapping round the right edge
+    of its plane. Turning the background off (LCDC bit 0) turns the window off too. On a CGB that bit
+    only takes away the background & window's priority, so sprites go over all of them.
+*/
+void renderScanline(void)
+{
+    static const unsigned char blank[256];
+    unsigned int *line = framebuffer + gpu.scanline * SCREEN_WIDTH;
+    const unsigned char *colours = blank;
+    const unsigned char *windowColours = blank;
+    int windowStart = SCREEN_WIDTH;
+    int x = 0;
+    int i;
+
+    if ((gpu.control & GPU_CONTROL_BGENABLE) || cgb.enabled)
+    {
+        int map = (gpu.control & GPU_CONTROL_TILEMAP) ? 1 : 0;
+        int y = (gpu.scanline + gpu.scrollY) & 255;
+        int first = 256 - gpu.scrollX; // Pixels before the wrap
+
+        x = gpu.scrollX;
+        colours = planeColours[map][y];
+
+        // 20 cells when lined up with the grid, 21 when not
+        updateStrips(map, y, x >> 3, (x & 7) ? 21 : 20);
+
+        if (first >= SCREEN_WIDTH)
+        {
+            memcpy(line, &planes[map][y][x], SCREEN_WIDTH * sizeof(line[0]));
+        }
+        else
+        {
+            memcpy(line, &planes[map][y][x], first * sizeof(line[0]));
+            memcpy(line + first, planes[map][y], (SCREEN_WIDTH - first) * sizeof(line[0]));
+        }
+
+        windowStart = renderWindow(line, &windowColours);
+
+        if (!(gpu.control & GPU_CONTROL_BGENABLE))
+        {
+            colours = blank;
+            windowColours = blank;
+        }
+    }
+    else
+    {
+        // The background is blank (shade 0, whatever BGP says) and everything counts as colour 0
+        for (i = 0; i < SCREEN_WIDTH; i++)
+            line[i] = palettes.theme->shades[0];
+    }
+
+    if (gpu.control & GPU_CONTROL_SPRITEENABLE)
+        renderSprites(line, colours, x, windowColours, windowStart);
+}
@@ -5,6 +5,7 @@
 #include "../include/registers.h"
 #include "../include/memory.h"
 #include "../include/cpu.h"
+#include "../include/cgb.h"
 
 // for debug include keys.h
 #include "../include/keys.h"
@@ -78,15 +79,13 @@ void interruptStep(void)
 /*
     vblank
     ---
-    This function draws to the screen. It executes ~60 times a second.
+    The VBLANK interrupt handler, at memory location 0x40. It executes ~60 times a second.
+    (The frame itself is drawn by the main loop when the GPU finishes it, see gpu.frameComplete.)
 */
 void vblank(void)
 {
     printf("vblank interrupt running\n");
 
-    // Draw the frame for this section
-    drawFramebuffer();
-
     // Reset the master interupt flag
     interrupt.master = 0;
 
@@ -103,7 +102,7 @@ void vblank(void)
     registers.pc = 0x40;
 
     // Increment the ticks this would take
-    ticks += 12;
+    ticks += CPU_TICKS(12);
 }
 
 /*
@@ -124,7 +123,7 @@ void STATInterrupt(void)
     registers.pc = 0x48;
 
     // Increment the ticks this would take
-    ticks += 12;
+    ticks += CPU_TICKS(12);
 }
 
 /*
@@ -145,7 +144,7 @@ void timer(void)
     registers.pc = 0x50;
 
     // Increment the ticks this would take
-    ticks += 12;
+    ticks += CPU_TICKS(12);
 }
 
 /*
@@ -166,7 +165,7 @@ void serial(void)
     registers.pc = 0x58;
 
     // Increment the ticks this would take
-    ticks += 12;
+    ticks += CPU_TICKS(12);
 }
 
 /*
@@ -187,7 +186,7 @@ void joypad(void)
     registers.pc = 0x60;
 
     // Increment the ticks this would take
-    ticks += 12;
+    ticks += CPU_TICKS(12);
 }
 
 /*
@@ -1,3 +1,153 @@
+/*
+    NAME: TMC
+    INIT DATE: 19/10/2026
+    LAST EDIT DATE: 19/10/2026
+    DESC:
+        Joypad input. Host key presses are mapped to joypad bits through a scancode table, and every
+        possible P1 (0xFF00) value is worked out when a key changes, so reading P1 is a single lookup.
+*/
+
 #include "../include/keys.h"
+#include "../include/main.h"
+#include "../include/memory.h"
+#include "../include/interupts.h"
+#include "../include/breakpoint.h"
+#include "../include/palette.h"
+#include "../include/memstats.h"
+#include <SDL2/SDL.h>
+
+struct keys keys;
+unsigned char joypadTable[4];
+
+// Entries in 'keyMap'. Joypad keys are their bit in 'keys.c' plus one, so 0 can mean 'not mapped'.
+enum keyAction
+{
+    KEY_NONE = 0,
+    KEY_A = 1,
+    KEY_B = 2,
+    KEY_SELECT = 3,
+    KEY_START = 4,
+    KEY_RIGHT = 5,
+    KEY_LEFT = 6,
+    KEY_UP = 7,
+    KEY_DOWN = 8,
+    KEY_DEBUG = 9,   // Not a joypad key, turns debug mode on
+    KEY_PALETTE = 10, // Not a joypad key, next palette theme
+    KEY_MEMSTATS = 11, // Not a joypad key, write out the memory statistics (GBM_MEMSTATS builds only)
+};
+
+static const unsigned char keyMap[SDL_NUM_SCANCODES] = {
+    [SDL_SCANCODE_X] = KEY_A,
+    [SDL_SCANCODE_Z] = KEY_B,
+    [SDL_SCANCODE_BACKSPACE] = KEY_SELECT,
+    [SDL_SCANCODE_RSHIFT] = KEY_SELECT,
+    [SDL_SCANCODE_RETURN] = KEY_START,
+    [SDL_SCANCODE_RIGHT] = KEY_RIGHT,
+    [SDL_SCANCODE_LEFT] = KEY_LEFT,
+    [SDL_SCANCODE_UP] = KEY_UP,
+    [SDL_SCANCODE_DOWN] = KEY_DOWN,
+    [SDL_SCANCODE_SPACE] = KEY_DEBUG,
+    [SDL_SCANCODE_P] = KEY_PALETTE,
+    [SDL_SCANCODE_M] = KEY_MEMSTATS,
+};
+
+/*
+    updateJoypad
+    ---
+    Rebuild 'joypadTable' from 'keys'. P1 bit 5 low selects the buttons, bit 4 low selects the dpad
+    (both low gives both ANDed together). Bits 6 & 7 always read as 1.
+*/
+void updateJoypad(void)
+{
+    unsigned char select;
+    unsigned char lines;
+
+    for (select = 0; select < 4; select++)
+    {
+        lines = 0x0F;
+        if (!(select & 2))
+            lines &= keys.keys1;
+        if (!(select & 1))
+            lines &= keys.keys2;
+
+        joypadTable[select] = 0xC0 | (select << 4) | lines;
+    }
+}
+
+/*
+    keyEvent
+    ---
+    A host key went down or up. Called by the emulation thread once per frame for every queued key.
+    Raises the joypad interrupt if a line that is currently selected goes from high to low.
+*/
+void keyEvent(int scancode, unsigned char pressed)
+{
+    unsigned char action;
+    unsigned char before;
+    unsigned char bit;
+
+    if (scancode < 0 || scancode >= SDL_NUM_SCANCODES)
+        return;
+
+    action = keyMap[scancode];
+    if (action == KEY_NONE)
+        return;
+
+    if (action == KEY_DEBUG)
+    {
+        if (pressed)
+        {
+            debugModeEnable = 1;
+            updateDebugActive();
+        }
+        return;
+    }
+
+    if (action == KEY_PALETTE)
+    {
+        if (pressed)
+            nextPaletteTheme();
+        return;
+    }
+
+    if (action == KEY_MEMSTATS)
+    {
+        if (pressed)
+            MEMSTATS_DUMP();
+        return;
+    }
+
+    before = readJoypad();
+
+    bit = 1 << (action - KEY_A);
+    if (pressed)
+        keys.c &= ~bit;
+    else
+        keys.c |= bit;
+
+    updateJoypad();
+
+    if (before & ~readJoypad() & 0x0F)
+        interrupt.flags |= INTERRUPTS_JOYPAD;
+}
+
+unsigned char readJoypad(void)
+{
+    return joypadTable[(io[0x00] >> 4) & 3];
+}
+
+/*
+    writeJoypad
+    ---
+    Only the select bits can be written. Selecting a line that has a key held also counts as a high to
+    low transition.
+*/
+void writeJoypad(unsigned char value)
+{
+    unsigned char before = readJoypad();
+
+    io[0x00] = value & 0x30;
 
-struct keys keys;
\ No newline at end of file
+    if (before & ~readJoypad() & 0x0F)
+        interrupt.flags |= INTERRUPTS_JOYPAD;
+}
@@ -0,0 +1,216 @@
+/*
+    NAME: TMC
+    INIT DATE: 19/10/2026
+    LAST EDIT DATE: 19/10/2026
+    DESC:
+        Link cable between two machines in one process. See 'include/link.h'.
+*/
+
+#include "../include/link.h"
+#include "../include/main.h"
+#include "../include/cpu.h"
+#include "../include/memory.h"
+#include "../include/gpu.h"
+#include "../include/ppu.h"
+#include "../include/apu.h"
+#include "../include/interupts.h"
+#include "../include/frameskip.h"
+#include "../include/breakpoint.h"
+#include "../include/trace.h"
+#include "../include/testrom.h"
+#include "../include/memstats.h"
+#include <stdio.h>
+#include <string.h>
+
+struct linkCable linkCable;
+
+// Swap the cartridge globals with the ones kept for the other machine
+static void swapCart(void)
+{
+    unsigned char *otherCart = linkCable.cart;
+    enum romType otherType = linkCable.cartType;
+    unsigned short otherBanks = linkCable.romBankCount;
+
+    linkCable.cart = cart;
+    linkCable.cartType = cartType;
+    linkCable.romBankCount = romBankCount;
+
+    cart = otherCart;
+    cartType = otherType;
+    romBankCount = otherBanks;
+}
+
+/*
+    startLink
+    ---
+    Load the second machine's ROM and reset it into 'linkCable.other'. Called once the first machine
+    has been reset, which is left as it was.
+*/
+int startLink(char *fileName, unsigned char dmg)
+{
+    char name[sizeof(gameName)];
+    unsigned char selfCgb = cartCgb;
+
+    memcpy(name, gameName, sizeof(name));
+    saveState(&linkCable.self);
+
+    // loadROM fills in the cartridge globals, so park the first machine's in 'linkCable' meanwhile
+    swapCart();
+    printf("Loading linked file \"%s\"...\n", fileName);
+    if (loadROM(fileName) != 1)
+    {
+        printf("Failed linked rom load!\n");
+        swapCart();
+        memcpy(gameName, name, sizeof(name));
+        return 0;
+    }
+
+    printf("Linked machine: ");
+    selectModel(dmg);
+    MEMSTATS_SUSPEND();
+    reset();
+    MEMSTATS_RESUME();
+
+    // Its capture is always "full", so it never writes into the first machine's test output
+    serialCaptureLength = SERIAL_CAPTURE_SIZE;
+    saveState(&linkCable.other);
+
+    swapCart();
+    cartCgb = selfCgb;
+    memcpy(gameName, name, sizeof(name));
+    loadState(&linkCable.self);
+
+    linkCable.connected = 1;
+    linkCable.lastTicks = ticks;
+    linkCable.syncTicks = ticks + SERIAL_TRANSFER_TICKS;
+    linkCable.otherTarget = linkCable.other.ticks;
+    return 1;
+}
+
+/*
+    runOther
+    ---
+    Swap the second machine in and run it until it has done 'length' more ticks. Nothing it does is
+    drawn, heard, traced, stopped on or counted in the memory statistics, and it always uses the fast
+    PPU engine: it is never drawn, and the accurate engine keeps mid-line state of its own that belongs
+    to the first machine.
+*/
+static void runOther(unsigned long length)
+{
+    unsigned char render = frameskip.renderFrame;
+    unsigned char mute = apu.mute;
+    unsigned char debug = debugActive;
+    unsigned char trace = traceEnabled;
+    unsigned char test = testRom.enabled;
+    const struct ppuEngine *engine = ppu;
+
+    saveState(&linkCable.self);
+    swapCart();
+    loadState(&linkCable.other);
+    linkCable.otherRunning = 1;
+
+    frameskip.renderFrame = 0;
+    apu.mute = 1;
+    debugActive = 0;
+    traceEnabled = 0;
+    testRom.enabled = 0;
+    ppu = &fastEngine;
+    MEMSTATS_SUSPEND();
+
+    linkCable.otherTarget += length;
+    while ((long)(ticks - linkCable.otherTarget) < 0)
+    {
+        cpu->step();
+        ppu->step();
+        interruptStep();
+
+        if (gpu.frameComplete)
+        {
+            gpu.frameComplete = 0;
+            apuEndFrame();
+        }
+    }
+
+    frameskip.renderFrame = render;
+    apu.mute = mute;
+    debugActive = debug;
+    traceEnabled = trace;
+    testRom.enabled = test;
+    ppu = engine;
+    MEMSTATS_RESUME();
+}
+
+// Swap the first machine back in
+static void returnToSelf(void)
+{
+    saveState(&linkCable.other);
+    swapCart();
+    loadState(&linkCable.self);
+    linkCable.otherRunning = 0;
+}
+
+// Whether 'port' clocked its own transfer and it has finished by 'now'
+static int transferDone(const struct serialPort *port, unsigned long now)
+{
+    return port->transferring && (long)(now - port->endTicks) >= 0;
+}
+
+/*
+    finishTransfer
+    ---
+    One side of a finished transfer. 'port' now holds the other side's byte. The side that clocked it
+    always finishes, the other side only if it had a transfer started on the external clock.
+*/
+static void finishTransfer(struct serialPort *port, struct interrupt *flags, int master)
+{
+    if (!master && (port->control & (SERIAL_CONTROL_START | SERIAL_CONTROL_INTERNAL)) != SERIAL_CONTROL_START)
+        return;
+
+    port->control &= ~SERIAL_CONTROL_START;
+    port->transferring = 0;
+    flags->flags |= INTERRUPTS_SERIAL;
+}
+
+/*
+    linkSync
+    ---
+    The first machine has reached 'linkCable.syncTicks'. Catch the second one up, do the byte exchange
+    if a transfer finishes here, and work out where the next quantum ends.
+*/
+void linkSync(void)
+{
+    struct serialPort *self = &linkCable.self.serialPort;
+    unsigned long selfTicks = ticks;
+    unsigned long next = SERIAL_TRANSFER_TICKS;
+    int selfDone;
+    int otherDone;
+
+    // While the second machine runs, the first is in 'linkCable.self'
+    runOther(selfTicks - linkCable.lastTicks);
+
+    selfDone = transferDone(self, linkCable.self.ticks);
+    otherDone = transferDone(&serialPort, ticks);
+
+    if (selfDone || otherDone)
+    {
+        unsigned char byte = self->data;
+
+        self->data = serialPort.data;
+        serialPort.data = byte;
+
+        finishTransfer(self, &linkCable.self.interrupt, selfDone);
+        finishTransfer(&serialPort, &interrupt, otherDone);
+    }
+
+    // The next quantum ends early if the second machine's transfer would finish sooner
+    if (serialPort.transferring && serialPort.endTicks - linkCable.otherTarget < next)
+        next = serialPort.endTicks - linkCable.otherTarget;
+
+    returnToSelf();
+
+    if (serialPort.transferring && serialPort.endTicks - ticks < next)
+        next = serialPort.endTicks - ticks;
+
+    linkCable.lastTicks = ticks;
+    linkCable.syncTicks = ticks + next;
+}
@@ -0,0 +1,177 @@
+/*
+    NAME: TMC
+    INIT DATE: 19/10/2026
+    LAST EDIT DATE: 19/10/2026
+    DESC:
+        Frame loop for the emulation thread. See 'include/machine.h'.
+*/
+
+#include "../include/machine.h"
+#include "../include/main.h"
+#include "../include/cpu.h"
+#include "../include/gpu.h"
+#include "../include/interupts.h"
+#include "../include/display.h"
+#include "../include/frameskip.h"
+#include "../include/apu.h"
+#include "../include/pacing.h"
+#include "../include/keys.h"
+#include "../include/state.h"
+#include "../include/gdbstub.h"
+#include "../include/serial.h"
+#include "../include/testrom.h"
+#include "../include/framehash.h"
+#include "../include/capture.h"
+#include "../include/ppu.h"
+#include "../include/link.h"
+#include "../include/memstats.h"
+#include <stdio.h>
+
+atomic_int emulationRunning = 1;
+struct ringbuffer inputQueue;
+unsigned long frameLimit; // Stop after this many frames (0 = run forever)
+unsigned long long cycleLimit;
+unsigned long long elapsedTicks; // Total ticks run (unlike 'ticks', this never wraps)
+unsigned int runAhead;    // Frames to run ahead of the real machine (0 = off)
+
+static unsigned long frames;
+static unsigned long frameStartTicks;
+static struct savestate runAheadState;
+
+/*
+    runFrame
+    ---
+    Step the machine until the GPU finishes a frame.
+*/
+void runFrame(void)
+{
+    while (!gpu.frameComplete)
+    {
+        cpu->step();
+        ppu->step();
+        if (serialPort.transferring)
+            stepSerial();
+        if (linkCable.connected && (long)(ticks - linkCable.syncTicks) >= 0)
+            linkSync();
+        interruptStep();
+    }
+
+    gpu.frameComplete = 0;
+    ppuEndFrame();
+}
+
+/*
+    handleInput
+    ---
+    Apply every key press/release the presentation thread has queued since the last frame. This is the
+    only place input is looked at, once per emulated frame.
+*/
+static void handleInput(void)
+{
+    struct inputEvent event;
+
+    if (inputQueue.data == NULL)
+        return;
+
+    while (ringbufferRead(&inputQueue, &event, 1))
+        keyEvent(event.scancode, event.pressed);
+}
+
+/*
+    runFrameAhead
+    ---
+    Run-ahead. Games usually take a frame or two to react to input, so after running the real frame
+    (audio only), save the machine, run 'runAhead' more frames with the keys as they are now (video
+    only from the last one, audio thrown away), show that last frame, then rewind to the saved state.
+    The player sees the reaction to their input 'runAhead' frames sooner.
+*/
+static void runFrameAhead(void)
+{
+    unsigned char render = frameskip.renderFrame;
+    unsigned int i;
+
+    frameskip.renderFrame = 0;
+    runFrame();
+    apuEndFrame();
+
+    saveState(&runAheadState);
+
+    apu.mute = 1;
+    MEMSTATS_SUSPEND(); // These frames are rewound, they'd count every access runAhead + 1 times
+    for (i = 1; i <= runAhead; i++)
+    {
+        frameskip.renderFrame = render && i == runAhead;
+        runFrame();
+        apuEndFrame();
+    }
+    MEMSTATS_RESUME();
+    apu.mute = 0;
+
+    if (render)
+        publishFrame();
+
+    loadState(&runAheadState);
+    frameskip.renderFrame = render;
+}
+
+/*
+    endFrame
+    ---
+    Everything that happens once per emulated frame: hash the frame, flush audio, capture both, hand the
+    frame over (only if it was drawn), pick up input, and wait until the next frame is due. With
+    run-ahead the frame has already been handed over and the audio flushed by runFrameAhead.
+*/
+void endFrame(void)
+{
+    // Hashed before it is handed over, while 'framebuffer' is still the finished frame
+    if (frameHash.enabled)
+        frameHashEndFrame(framebuffer);
+
+    if (!runAhead)
+    {
+        apuEndFrame();
+
+        // After the audio is flushed, so the frame goes with the sound made during it
+        if (capture.enabled)
+            captureFrame(framebuffer);
+
+        if (frameskip.renderFrame)
+            publishFrame();
+    }
+
+    frameskipEndFrame();
+    handleInput();
+    if (gdbEnabled)
+        gdbPoll();
+    paceFrame();
+
+    elapsedTicks += ticks - frameStartTicks;
+    frameStartTicks = ticks;
+    if (testRom.enabled)
+        testRomEndFrame();
+
+    if (frameLimit && ++frames >= frameLimit)
+        atomic_store(&emulationRunning, 0);
+    if (cycleLimit && elapsedTicks >= cycleLimit)
+        atomic_store(&emulationRunning, 0);
+}
+
+/*
+    emulationThread
+    ---
+    Entry point of the emulation thread (also called directly when running headless).
+*/
+int emulationThread(void *data)
+{
+    while (atomic_load_explicit(&emulationRunning, memory_order_relaxed))
+    {
+        if (runAhead)
+            runFrameAhead();
+        else
+            runFrame();
+
+        endFrame();
+    }
+
+    return 0;
+}
@@ -16,6 +16,24 @@
 #include "../include/main.h"
 #include "../include/interupts.h"
 #include "../include/gpu.h"
+#include "../include/display.h"
+#include "../include/frameskip.h"
+#include "../include/apu.h"
+#include "../include/pacing.h"
+#include "../include/machine.h"
+#include "../include/trace.h"
+#include "../include/breakpoint.h"
+#include "../include/gdbstub.h"
+#include "../include/testrom.h"
+#include "../include/framehash.h"
+#include "../include/capture.h"
+#include "../include/scaler.h"
+#include "../include/palette.h"
+#include "../include/ppu.h"
+#include "../include/cgb.h"
+#include "../include/link.h"
+#include "../include/cputest.h"
+#include "../include/memstats.h"
 
 char gameName[17];
 unsigned char debugModeEnable = 1;
@@ -23,15 +41,34 @@ unsigned char debugModeEnable = 1;
 // int WinMain(int argc, char *argv[])
 int WINAPI WinMain(HINSTANCE hInstance, HINSTANCE hPrevInstance, LPSTR lpCmdLine, int nCmdShow)
 {
-    // Parse the command line into argc and argv (have to do this now the application is not just on console)
+    // Parse the command line into argc and argv (have to do this now the application is not just on console).
+    // "Quoted arguments" are kept together so breakpoint conditions can have spaces in them.
     int argc = 0;
     char *argv[256]; // Assuming no more than 255 arguments
-    char *token = strtok(lpCmdLine, " ");
+    char *token = lpCmdLine;
 
-    while (token != NULL && argc < 256)
+    while (*token != '\0' && argc < 256)
     {
-        argv[argc++] = token;
-        token = strtok(NULL, " ");
+        while (*token == ' ')
+            token++;
+        if (*token == '\0')
+            break;
+
+        if (*token == '"')
+        {
+            argv[argc++] = ++token;
+            while (*token != '\0' && *token != '"')
+                token++;
+        }
+        else
+        {
+            argv[argc++] = token;
+            while (*token != '\0' && *token != ' ')
+                token++;
+        }
+
+        if (*token != '\0')
+            *token++ = '\0';
     }
 
     // Access argc and argv like in a console program
@@ -40,16 +77,161 @@ int WINAPI WinMain(HINSTANCE hInstance, HINSTANCE hPrevInstance, LPSTR lpCmdLine
         printf("argv[%d]: %s\n", i, argv[i]);
     }
 
+    // Options start with "--", anything else is assumed to be the ROM
+    char *filename = NULL;
+    char *wavName = NULL;
+    char *traceName = NULL;
+    unsigned short gdbPort = 0;
+    char *testName = NULL;
+    char *captureName = NULL;
+    char *captureAudioName = NULL;
+    char *linkName = NULL;
+    char *cpuTestName = NULL;
+    unsigned char coreTest = 0;
+    enum captureMode captureMode = CAPTURE_DROP;
+    enum ppuSelection ppuSelection;
+    unsigned char ppuGiven = 0;
+    unsigned char dmgGiven = 0;  // Run CGB enhanced ROMs as a DMG would
+    unsigned char headless = 0;  // No window, no audio device. For the test farm.
+    unsigned char noSound = 0;
+    unsigned char noPace = 0;     // Run flat out, for benchmarks
+    unsigned short bank;
+    unsigned short address;
+    for (int i = 0; i < argc; i++)
+    {
+        if (!strcmp(argv[i], "--frameskip") && i + 1 < argc)
+            setFrameskip(FRAMESKIP_FIXED, (unsigned int)atoi(argv[++i]));
+        else if (!strcmp(argv[i], "--turbo"))
+            setFrameskip(FRAMESKIP_TURBO, 0);
+        else if (!strcmp(argv[i], "--wav") && i + 1 < argc)
+            wavName = argv[++i];
+        else if (!strcmp(argv[i], "--trace") && i + 1 < argc)
+            traceName = argv[++i];
+        else if (!strcmp(argv[i], "--nosound"))
+            noSound = 1;
+        else if (!strcmp(argv[i], "--nopace"))
+            noPace = 1;
+        else if (!strcmp(argv[i], "--headless"))
+            headless = 1;
+        else if (!strcmp(argv[i], "--runahead") && i + 1 < argc)
+            runAhead = (unsigned int)atoi(argv[++i]);
+        else if (!strcmp(argv[i], "--frames") && i + 1 < argc)
+            frameLimit = strtoul(argv[++i], NULL, 0);
+        else if (!strcmp(argv[i], "--break") && i + 1 < argc)
+        {
+            if (parseBreakpoint(argv[++i], &bank, &address))
+                setBreakpoint(bank, address);
+        }
+        else if (!strcmp(argv[i], "--cycles") && i + 1 < argc)
+            cycleLimit = strtoull(argv[++i], NULL, 0);
+        else if (!strcmp(argv[i], "--test") && i + 1 < argc)
+            testName = argv[++i];
+        else if (!strcmp(argv[i], "--hashlog") && i + 1 < argc)
+        {
+            if (!startHashLog(argv[++i]))
+                return 1;
+        }
+        else if (!strcmp(argv[i], "--golden") && i + 1 < argc)
+        {
+            if (!loadGolden(argv[++i]))
+                return 1;
+        }
+        else if (!strcmp(argv[i], "--dump") && i + 1 < argc)
+        {
+            if (!setFrameDumps(argv[++i]))
+                return 1;
+        }
+        else if (!strcmp(argv[i], "--dumpraw"))
+            frameHash.dumpRaw = 1;
+        else if (!strcmp(argv[i], "--capture") && i + 1 < argc)
+            captureName = argv[++i];
+        else if (!strcmp(argv[i], "--captureaudio") && i + 1 < argc)
+            captureAudioName = argv[++i];
+        else if (!strcmp(argv[i], "--capturemode") && i + 1 < argc)
+            captureMode = !strcmp(argv[++i], "wait") ? CAPTURE_WAIT : CAPTURE_DROP;
+        else if (!strcmp(argv[i], "--ppu") && i + 1 < argc)
+        {
+            if (!parsePpuSelection(argv[++i], &ppuSelection))
+                return 1;
+            ppuGiven = 1;
+        }
+        else if (!strcmp(argv[i], "--core") && i + 1 < argc)
+        {
+            if (!selectCpuCore(argv[++i]))
+                return 1;
+        }
+        else if (!strcmp(argv[i], "--cputest") && i + 1 < argc)
+            cpuTestName = argv[++i];
+        else if (!strcmp(argv[i], "--coretest"))
+            coreTest = 1;
+        else if (!strcmp(argv[i], "--link") && i + 1 < argc)
+            linkName = argv[++i];
+        else if (!strcmp(argv[i], "--dmg"))
+            dmgGiven = 1;
+        else if (!strcmp(argv[i], "--palette") && i + 1 < argc)
+        {
+            if (!setPaletteTheme(argv[++i]))
+                return 1;
+        }
+        else if (!strcmp(argv[i], "--scaler") && i + 1 < argc)
+        {
+            if (!parseScalerMode(argv[++i], &scalerMode))
+                return 1;
+        }
+        else if (!strcmp(argv[i], "--gdb") && i + 1 < argc)
+            gdbPort = (unsigned short)atoi(argv[++i]);
+        else if (!strcmp(argv[i], "--breakif") && i + 2 < argc)
+        {
+            if (parseBreakpoint(argv[i + 1], &bank, &address))
+                setConditionalBreakpoint(bank, address, argv[i + 2]);
+            i += 2;
+        }
+        else if ((!strcmp(argv[i], "--watch") || !strcmp(argv[i], "--watchr") || !strcmp(argv[i], "--watchw")) && i + 1 < argc)
+        {
+            unsigned char type = argv[i][7] == 'r' ? WATCH_READ : argv[i][7] == 'w' ? WATCH_WRITE : WATCH_READ | WATCH_WRITE;
+            if (parseBreakpoint(argv[++i], &bank, &address))
+                setWatchpoint(address, type);
+        }
+        else
+            filename = argv[i];
+    }
+
+    // Frame hashes & captures have to cover every frame, and run-ahead would show frames that get rewound
+    if (frameHash.enabled || captureName != NULL || captureAudioName != NULL)
+    {
+        setFrameskip(FRAMESKIP_OFF, 0);
+        runAhead = 0;
+    }
+
+    // Run-ahead only rewinds the first machine, the linked one would get out of step
+    if (linkName != NULL)
+        runAhead = 0;
+
+    // Run-ahead runs every frame runAhead + 1 times, the trace would log the rewound ones too, and a
+    // test ROM's result could come from a frame that gets rewound
+    if (traceName != NULL || testName != NULL)
+        runAhead = 0;
+
+    // The debug window is a message box, which would wait forever for a click with nobody there
+    if (headless || testName != NULL)
+    {
+        debugModeEnable = 0;
+        updateDebugActive();
+    }
+
+    // Single step CPU tests need no ROM, window or anything else
+    if (cpuTestName != NULL)
+        return runCpuTests(cpuTestName, testName) ? 0 : 1;
+    if (coreTest)
+        return runCoreTimingTests(testName) ? 0 : 1;
+
     // Fail if no path to ROM file is provided
-    if (argc < 1)
+    if (filename == NULL)
     {
-        printf("Usage: ./<emulator_name> <path_to_rom>\n", argv[0]);
+        printf("Usage: ./<emulator_name> [--frameskip <n> | --turbo] [--wav <file>] [--trace <file>] [--nosound] [--nopace] [--headless] [--frames <n>] [--cycles <n>] [--test <result file>] [--runahead <n>] [--break [bank:]<addr>] [--breakif [bank:]<addr> <condition>] [--watch | --watchr | --watchw <addr>] [--gdb <port>] [--hashlog <file>] [--golden <file>] [--dump <frames>] [--dumpraw] [--capture <file | ->] [--captureaudio <file | ->] [--capturemode drop | wait] [--scaler none | nearest | scale2x | scale3x | lcd] [--palette grey | green | pocket | RRGGBB,RRGGBB,RRGGBB,RRGGBB] [--ppu fast | accurate | auto] [--core fast | cycle] [--dmg] [--link <path_to_rom>] <path_to_rom> | --cputest <file.json> [--test <result file>] | --coretest [--test <result file>]\n");
     }
     else
     {
-        // Just assume the filename given is a ROM and get it loading!
-        char *filename = argv[0];
-
         printf("Loading file \"%s\"...\n", filename);
 
         if (loadROM(filename) != 1)
@@ -59,8 +241,16 @@ int WINAPI WinMain(HINSTANCE hInstance, HINSTANCE hPrevInstance, LPSTR lpCmdLine
             return 1;
         }
 
+        selectModel(dmgGiven);
+
+        // The PPU engine from the command line, or the one listed for this ROM
+        if (ppuGiven)
+            selectPpu(ppuSelection);
+        else
+            selectPpuForRom(gameName);
+
         // Rom has loaded properly, open window and start CPU cycle
-        SDL_Init(SDL_INIT_VIDEO);
+        SDL_Init(headless ? 0 : SDL_INIT_VIDEO);
 
         char title[200]; // Buffer to hold window title
 
@@ -68,57 +258,90 @@ int WINAPI WinMain(HINSTANCE hInstance, HINSTANCE hPrevInstance, LPSTR lpCmdLine
         strcpy(title, "GBM - "); // Copy "GBM - " to title
         strcat(title, gameName); // Append gameName to title
 
-        // The window itself! Size defined by constants and scaling factor.
-        SDL_Window *window = SDL_CreateWindow(title, SDL_WINDOWPOS_UNDEFINED, SDL_WINDOWPOS_UNDEFINED, SCREEN_HEIGHT * SCALING_FACTOR, SCREEN_WIDTH * SCALING_FACTOR, SDL_WINDOW_SHOWN);
+        // The window itself!
+        if (!headless && !initDisplay(title))
+        {
+            SDL_Quit();
+            return 1;
+        }
 
-        SDL_Renderer *renderer = SDL_CreateRenderer(window, -1, SDL_RENDERER_ACCELERATED);
+        // Sound. Without a device the APU still runs, the samples just go nowhere (or to the .wav).
+        if (!headless && !noSound)
+            openAudio();
+        if (wavName != NULL)
+            startWav(wavName);
+        if (traceName != NULL)
+            startTrace(traceName);
+        if ((captureName != NULL || captureAudioName != NULL) && !startCapture(captureName, captureAudioName, captureMode, scalerMode))
+        {
+            SDL_Quit();
+            return 1;
+        }
+        if (testName != NULL && !startTestRom(testName))
+        {
+            SDL_Quit();
+            return 1;
+        }
+        if (gdbPort != 0 && !startGdbStub(gdbPort))
+        {
+            SDL_Quit();
+            return 1;
+        }
 
-        SDL_Event e;
-        int quit = 0;
         reset(); // Initialise all values needed to start the system.
-        while (!quit)
+        if (linkName != NULL && !startLink(linkName, dmgGiven))
+        {
+            SDL_Quit();
+            return 1;
+        }
+        initPacing(!headless && !noPace);
+
+        if (headless)
+        {
+            // Nothing to present, so just run the machine on this thread
+            emulationThread(NULL);
+        }
+        else
         {
-            stepCPU();
-            stepGPU();
-            interruptStep();
-            while (SDL_PollEvent(&e))
+            // The core runs on its own thread. This thread only shows finished frames and passes input
+            // back, so a slow vsync or compositor never holds up emulation.
+            SDL_Event e;
+            struct inputEvent event;
+
+            ringbufferInit(&inputQueue, sizeof(struct inputEvent), INPUT_QUEUE_SIZE);
+            SDL_Thread *thread = SDL_CreateThread(emulationThread, "emulation", NULL);
+
+            while (atomic_load(&emulationRunning))
             {
-                switch (e.type)
+                while (SDL_PollEvent(&e))
                 {
-                case SDL_QUIT:
-                    quit = 1;
-                    break;
-                case SDL_KEYDOWN:
-                    handlePress(SDL_GetKeyName(e.key.keysym.sym));
-                    printf("Key Pressed: %s\n", SDL_GetKeyName(e.key.keysym.sym));
-                    break;
-
-                case SDL_KEYUP:
-                    handleUnpress(SDL_GetKeyName(e.key.keysym.sym));
-                    printf("Key Released: %s\n", SDL_GetKeyName(e.key.keysym.sym));
-                    break;
+                    switch (e.type)
+                    {
+                    case SDL_QUIT:
+                        atomic_store(&emulationRunning, 0);
+                        break;
+                    case SDL_KEYDOWN:
+                    case SDL_KEYUP:
+                        if (e.key.repeat)
+                            break;
+                        event.pressed = (e.type == SDL_KEYDOWN);
+                        event.scancode = e.key.keysym.scancode;
+                        ringbufferWrite(&inputQueue, &event, 1); // If the queue is full the key is lost
+                        break;
+                    }
                 }
-                // if (e.type == SDL_QUIT)
-                // {
-                // quit = 1;
-                // }
-            }
 
-            /*
-                This was just some testing, but it seems that inputs get noticed VERY quickly when checked in this way.
-            */
-            // const Uint8 *keyState = SDL_GetKeyboardState(NULL);
-            // if (keyState[SDL_SCANCODE_W])
-            // {
-            //     printf("W key is held down\n");
-            // }
+                // Nothing new to show yet, don't spin
+                if (!presentFrame())
+                    SDL_Delay(1);
+            }
 
-            SDL_RenderClear(renderer);
-            SDL_RenderPresent(renderer);
+            SDL_WaitThread(thread, NULL);
+            ringbufferFree(&inputQueue);
         }
 
-        SDL_DestroyRenderer(renderer);
-        SDL_DestroyWindow(window);
+        if (!headless)
+            closeDisplay();
         SDL_Quit();
     }
 
@@ -126,27 +349,18 @@ int WINAPI WinMain(HINSTANCE hInstance, HINSTANCE hPrevInstance, LPSTR lpCmdLine
     return 0;
 }
 
-void handlePress(const char *keyName)
-{
-    //TO-DO: IMPLEMENT INPUT HANDLING
-    if(!strcmp(keyName, "Space") && !debugModeEnable)
-    {
-        debugModeEnable = 1;
-    }
-    else
-    {
-        printf("Undefined keyboard press: %s\n", keyName);
-    }
-}
-
-void handleUnpress(const char *keyName)
-{
-    //TO-DO: IMPLEMENT INPUT HANDLING
-}
-
 void quit(void)
 {
+    int passed;
+
     printf("Quiting emulator...\n");
+    passed = finishTestRom();
+    passed &= stopFrameHash();
+    stopCapture();
+    MEMSTATS_FINISH();
+    closeAPU();
+    stopTrace();
+    closeGdbStub();
     unloadROM();
-    exit(1);
+    exit(passed ? 0 : 1);
 }
\ No newline at end of file
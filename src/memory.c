@@ -13,6 +13,14 @@
 #include "../include/keys.h"
 #include "../include/interupts.h"
 #include "../include/gpu.h"
+#include "../include/apu.h"
+#include "../include/breakpoint.h"
+#include "../include/rom.h"
+#include "../include/serial.h"
+#include "../include/palette.h"
+#include "../include/ppu.h"
+#include "../include/cgb.h"
+#include "../include/memstats.h"
 #include <stdlib.h>
 
 // A variable that resets the IO to some necessary value when starting or reseting the system.
@@ -34,12 +42,15 @@ const unsigned char ioReset[0x100] = {
     0xD0, 0x7A, 0x00, 0x9E, 0x04, 0x5F, 0x41, 0x2F, 0x1D, 0x77, 0x36, 0x75, 0x81, 0xAA, 0x70, 0x3A,
     0x98, 0xD1, 0x71, 0x02, 0x4D, 0x01, 0xC1, 0xFF, 0x0D, 0x00, 0xD3, 0x05, 0xF9, 0x00, 0x0B, 0x00};
 
+unsigned short romBank = 1;
 unsigned char *cart;        // The cart variable holds the information loaded in from the 'loadROM' method in rom.c
 unsigned char sram[0x2000]; // Switchable RAM
 unsigned char io[0x100];    // Input - Output
-unsigned char vram[0x2000]; // Video RAM
+unsigned char vram[0x4000]; // Video RAM
 unsigned char oam[0x100];   // Sprite Attribute Memory (OAM)
-unsigned char wram[0x2000]; // Working RAM, Internal RAM
+unsigned char wram[0x8000]; // Working RAM, Internal RAM
+unsigned char *vramBank = vram;
+unsigned char *wramBank = wram + 0x1000;
 unsigned char hram[0x80];   // Internal RAM, High RAM. The ram actually in the CPU die, where the wram is seperate.
 
 /*
@@ -71,20 +82,41 @@ unsigned char hram[0x80];   // Internal RAM, High RAM. The ram actually in the C
             * NOTE: b = bit, B = byte
     */
 
+static unsigned char peeking; // Set by peekByte for the length of its read
+static unsigned char poking;  // Set by pokeByte for the length of its write
+
 unsigned char readByte(unsigned short address)
 {
-    // Address @ Cart
-    if (address <= 0x7FFF)
+    // Watchpoints (see breakpoint.c). Only looked at while debugging.
+    if (debugActive && BITMAP_TEST(readWatchMap, address) && !peeking)
+    {
+        watchpointHit(address, WATCH_READ);
+    }
+
+    // Nothing unless built with GBM_MEMSTATS (see memstats.h)
+    if (!peeking)
+    {
+        MEMSTATS_READ(address);
+    }
+
+    // Address @ Cart, bank 0
+    if (address <= 0x3FFF)
     {
         return cart[address];
     }
 
+    // Address @ Cart, switchable bank
+    if (address <= 0x7FFF)
+    {
+        return cart[romBank * 0x4000 + (address - 0x4000)];
+    }
+
     // Address @ VRAM
     if (address >= 0x8000 && address <= 0x9FFF)
     {
-        return vram[address - 0x8000]; // The vram array is 0x2000 in size but the address will be
-                                       // anywhere from 0x8000 to 0x9FFF. MINUS 0x8000 to bring
-                                       // address in range.
+        return vramBank[address - 0x8000]; // A VRAM bank is 0x2000 in size but the address will be
+                                           // anywhere from 0x8000 to 0x9FFF. MINUS 0x8000 to bring
+                                           // address in range.
     }
 
     // Adress @ SRAM
@@ -93,12 +125,18 @@ unsigned char readByte(unsigned short address)
         return sram[address - 0xA000]; // Same reasoning as above
     }
 
-    // Adress @ WRAM
-    if (address >= 0xC000 && address <= 0xDFFF)
+    // Adress @ WRAM, bank 0
+    if (address >= 0xC000 && address <= 0xCFFF)
     {
         return wram[address - 0xC000]; // Same reasoning as above
     }
 
+    // Adress @ WRAM, switchable bank (always bank 1 on a DMG)
+    if (address >= 0xD000 && address <= 0xDFFF)
+    {
+        return wramBank[address - 0xD000];
+    }
+
     // Address @ WRAM (echo)
     /*
         Explanation of what is happening with echo RAM;
@@ -112,10 +150,14 @@ unsigned char readByte(unsigned short address)
         the above check's range. This is because the most significant bit is ignored in WRAM.
         E.g. 0xC123 is read the same as 0xE123.
     */
-    if (address >= 0xE000 && address <= 0xFDFF)
+    if (address >= 0xE000 && address <= 0xEFFF)
     {
         return wram[address - 0xE000];
     }
+    if (address >= 0xF000 && address <= 0xFDFF)
+    {
+        return wramBank[address - 0xF000];
+    }
 
     // Address @ OAM
     /*
@@ -151,29 +193,16 @@ unsigned char readByte(unsigned short address)
     */
     if (address == 0xFF00)
     {
-        // // Check if button interupt is flagged
-        // if (!(io[0x00] & 0x20))
-        // {
-        //     // return 1100 0000 | KEYS.KEYS1 | 0010 0000 = 1110 XXXX where X = KEYS.KEYS2 bits
-        //     return (unsigned char)(0xC0 | keys.keys1 | 0x10);
-        // }
-        // // Check if dpad input flagged
-        // else if (!(io[0x00] & 0x10))
-        // {
-        //     return (unsigned char)(0xc0 | keys.keys2 | 0x20);
-        // }
-        // // 0x30 = 0011 0000, i.e. if neither dpad and action button flags are set
-        // else if (!(io[0x00] & 0x30))
-        // {
-        //     return 0xFF; // If neither bits are set, return 1111 1111
-        // }
-        // else
-        // {
-        //     return 0; // just incase?
-        // }
-
-        // for now, just return '0xff' cause nothing should be pressed!
-        return (unsigned char)0xff;
+        // Every combination of the select bits is worked out when a key changes (see keys.c)
+        return readJoypad();
+    }
+
+    /*
+        Address @ Serial data & control
+    */
+    if (address == 0xFF01 || address == 0xFF02)
+    {
+        return serialRead(address);
     }
 
     /*
@@ -184,6 +213,23 @@ unsigned char readByte(unsigned short address)
         return interrupt.flags;
     }
 
+    /*
+        Address @ Sound registers & wave RAM
+        The APU is caught up to the CPU before anything that can change (see apu.c).
+    */
+    if (address >= 0xFF10 && address <= 0xFF3F)
+    {
+        return peeking ? apuPeek(address) : apuRead(address);
+    }
+
+    /*
+        Address @ CGB registers (VRAM/WRAM banks, colour palettes, double speed, HDMA)
+    */
+    if (cgb.enabled && CGB_REGISTER(address))
+    {
+        return readCgb(address);
+    }
+
     /*
         Address @ Interrupt Enable
     */
@@ -202,7 +248,7 @@ unsigned char readByte(unsigned short address)
     // TAKEN FROM CINOOP CAUSE DIV TIMER IS VERY INVOLVED TO EMULATE PROPERLY
     // Should return a div timer, but a random number works just as well for Tetris
     if (address == 0xff04)
-        return (unsigned char)rand();
+        return peeking ? 0 : (unsigned char)rand();
 
     if (address == 0xff40)
         return gpu.control;
@@ -213,12 +259,43 @@ unsigned char readByte(unsigned short address)
     if (address == 0xff44)
         // return 0x90; // default to 0x90 until I got GPU working    
         return gpu.scanline; // Read only. There is no equivalent in 'writeByte'.
+    if (address == 0xff41)
+        return readStatus();
+    if (address == 0xff45)
+        return gpu.lyCompare;
+    if (address == 0xff47)
+        return gpu.backgroundPalette;
+    if (address == 0xff48 || address == 0xff49)
+        return gpu.spritePalette[address - 0xff48];
+    if (address == 0xff4a)
+        return gpu.windowY;
+    if (address == 0xff4b)
+        return gpu.windowX;
 
     // Shouldn't get here! Attempting to read a memory address outside of valid ranges.
-    printf("ERROR: Attempted to read invalid memory address: %x.\n", address);
+    if (!peeking && !MEMSTATS_INVALID(address, 0))
+        printf("ERROR: Attempted to read invalid memory address: %x.\n", address);
     return 0;
 }
 
+/*
+    peekByte
+    ---
+    What readByte would return, for the trace & debuggers, which look at memory without being part of
+    the emulation. Nothing else a read does happens: no watchpoints, no APU catch up, no statistics,
+    no random DIV (reads 0) and no message for an address with nothing there.
+*/
+unsigned char peekByte(unsigned short address)
+{
+    unsigned char value;
+
+    peeking = 1;
+    value = readByte(address);
+    peeking = 0;
+
+    return value;
+}
+
 void writeByte(unsigned short address, unsigned char value)
 {
     // CINOOP TETRIS PATCH so I can get past the copyright screen maybe?
@@ -235,14 +312,44 @@ void writeByte(unsigned short address, unsigned char value)
 
     // Comments have been abreviated in this function. Please see 'readByte' to understand more of what's happening.
 
+    if (debugActive && BITMAP_TEST(writeWatchMap, address) && !poking)
+    {
+        watchpointHit(address, WATCH_WRITE);
+    }
+
+    if (!poking)
+    {
+        MEMSTATS_WRITE(address);
+    }
+
+    // PPU registers (not LY or DMA) or CGB colours changing during mode 3, which the fast PPU engine can't show
+    if (!poking && gpu.mode == GPU_MODE_VRAM && ((address >= 0xff40 && address <= 0xff4b && address != 0xff44 && address != 0xff46) ||
+                                      (cgb.enabled && (address == 0xff69 || address == 0xff6b))))
+    {
+        ppuMidLineWrite();
+    }
+
+    // Address @ Cart, ROM bank select (MBC1, lower 5 bits. Bank 0 can't be selected.)
+    if (address >= 0x2000 && address <= 0x3FFF && cartType >= ROM_MBC1 && cartType <= ROM_MBC1_RAM_BATT && !poking)
+    {
+        romBank = value & 0x1F;
+        if (romBank == 0)
+            romBank = 1;
+        romBank &= romBankCount - 1;
+    }
+
+    // Address @ Cart, RAM enable & banking mode (not emulated yet). Plain ROMs ignore these writes.
+    else if (address <= 0x7FFF)
+    {
+    }
+
     // Address @ VRAM
-    if (address >= 0x8000 && address <= 0x9FFF)
+    else if (address >= 0x8000 && address <= 0x9FFF)
     {
-        vram[address - 0x8000] = value;
+        vramBank[address - 0x8000] = value;
         if (address <= 0x97ff)
         {
-            printf("Should run 'updateTile' here.\n");
-            // updateTile(address, value);
+            updateTile((unsigned short)(vramBank - vram) + (address - 0x8000));
         }
     }
 
@@ -253,16 +360,24 @@ void writeByte(unsigned short address, unsigned char value)
     }
 
     // Adress @ WRAM
-    else if (address >= 0xC000 && address <= 0xDFFF)
+    else if (address >= 0xC000 && address <= 0xCFFF)
     {
         wram[address - 0xC000] = value;
     }
+    else if (address >= 0xD000 && address <= 0xDFFF)
+    {
+        wramBank[address - 0xD000] = value;
+    }
 
     // Address @ WRAM (echo)
-    else if (address >= 0xE000 && address <= 0xFDFF)
+    else if (address >= 0xE000 && address <= 0xEFFF)
     {
         wram[address - 0xE000] = value;
     }
+    else if (address >= 0xF000 && address <= 0xFDFF)
+    {
+        wramBank[address - 0xF000] = value;
+    }
 
     // Address @ OAM
     else if (address >= 0xFE00 && address <= 0xFEFF)
@@ -274,33 +389,39 @@ void writeByte(unsigned short address, unsigned char value)
     // Individuals
     else if (address == 0xff40)
         gpu.control = value;
+    else if (address == 0xff41)
+        writeStatus(value);
     else if (address == 0xff42)
         gpu.scrollY = value;
     else if (address == 0xff43)
         gpu.scrollX = value;
+    else if (address == 0xff45)
+        writeLyCompare(value);
     else if (address == 0xff46)
         copy(0xfe00, value << 8, 160); // OAM DMA
+    else if (address == 0xff4a)
+        gpu.windowY = value;
+    else if (address == 0xff4b)
+        gpu.windowX = value;
 
-    // Background and sprite palette
-    else if (address == 0xff47)
-    { // write only
-        int i;
-        // for(i = 0; i < 4; i++) backgroundPalette[i] = palette[(value >> (i * 2)) & 3];
-        printf("Background palette being updated\n");
-    }
+    // Background and sprite palettes, turned into host pixels straight away (see palette.c)
+    else if (address >= 0xff47 && address <= 0xff49)
+        writePalette(address, value);
+
+    // Address @ CGB registers
+    else if (cgb.enabled && CGB_REGISTER(address))
+        writeCgb(address, value);
 
-    else if (address == 0xff48)
-    { // write only
-        int i;
-        // for(i = 0; i < 4; i++) spritePalette[0][i] = palette[(value >> (i * 2)) & 3];
-        printf("Sprite palette being updated\n");
+    // Address @ Joypad (only the select bits can be written)
+    else if (address == 0xFF00)
+    {
+        writeJoypad(value);
     }
 
-    else if (address == 0xff49)
-    { // write only
-        int i;
-        // for(i = 0; i < 4; i++) spritePalette[1][i] = palette[(value >> (i * 2)) & 3];
-        printf("Sprite palette being updated\n");
+    // Address @ Serial data & control
+    else if (address == 0xFF01 || address == 0xFF02)
+    {
+        serialWrite(address, value);
     }
 
     // Address @ Interrupt Flags
@@ -310,6 +431,12 @@ void writeByte(unsigned short address, unsigned char value)
         io[address - 0xFF00] = value;
     }
 
+    // Address @ Sound registers & wave RAM
+    else if (address >= 0xFF10 && address <= 0xFF3F)
+    {
+        apuWrite(address, value);
+    }
+
     // Fallback
     else if (address >= 0xFF00 && address <= 0xFF7F)
     {
@@ -329,7 +456,7 @@ void writeByte(unsigned short address, unsigned char value)
     }
 
     // Shouldn't get here! Attempting to read a memory address outside of valid ranges.
-    else
+    else if (!poking && !MEMSTATS_INVALID(address, 1))
     {
         printf("ERROR: Attempted to write invalid memory address: 0x%02x.\n", address);
         printf("Generally I would quit here but I think I read that tetris does this sometimes for no reason...\n");
@@ -337,6 +464,21 @@ void writeByte(unsigned short address, unsigned char value)
     }
 }
 
+/*
+    pokeByte
+    ---
+    writeByte for debuggers, which change memory without being part of the emulation. The value lands
+    where writeByte would put it, but no watchpoints, no statistics, no mid-line PPU write for auto
+    mode, no MBC bank switch for a write to the ROM area (nothing is written there) and no message for
+    an address with nothing there.
+*/
+void pokeByte(unsigned short address, unsigned char value)
+{
+    poking = 1;
+    writeByte(address, value);
+    poking = 0;
+}
+
 unsigned short readShort(unsigned short address)
 {
     unsigned short rShort = readByte(address) | (readByte(address + 1) << 8);
@@ -355,7 +497,7 @@ unsigned short readShort(unsigned short address)
 void writeShort(unsigned short address, unsigned short value)
 {
     writeByte(address, (unsigned char)value & 0x00ff);
-    writeByte(address + 1, (unsigned char)value & 0xff00 >> 8); // shifted to the right by 8 bits
+    writeByte(address + 1, (unsigned char)(value >> 8)); // shifted to the right by 8 bits
 }
 
 /*
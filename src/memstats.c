@@ -0,0 +1,197 @@
+/*
+    NAME: TMC
+    INIT DATE: 19/10/2026
+    LAST EDIT DATE: 19/10/2026
+    DESC:
+        Memory access statistics. See 'include/memstats.h'. Empty unless built with GBM_MEMSTATS.
+*/
+
+#include "../include/memstats.h"
+
+#ifdef GBM_MEMSTATS
+
+#include "../include/framehash.h"
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+
+#define HEATMAP_CELL 16                    // Pixels per page, each way
+#define HEATMAP_PANEL (16 * HEATMAP_CELL)  // One 16 x 16 page grid
+#define HEATMAP_GAP 8
+#define HEATMAP_WIDTH (2 * HEATMAP_PANEL + HEATMAP_GAP)
+#define HEATMAP_UNTOUCHED 0xFF303030
+#define HEATMAP_BACKGROUND 0xFF000000
+
+static const char *regionNames[REGION_COUNT] = {"rom0", "romx", "vram", "sram", "wram", "echo", "oam", "unusable", "io", "hram", "ie"};
+
+// [0] reads, [1] writes
+static unsigned long long regions[REGION_COUNT][2];
+static unsigned long long pages[0x100][2];
+static unsigned long long invalid[0x10000][2];
+
+static unsigned int dumps;
+
+unsigned int memStatsSuspended;
+
+// Which region 'address' is in. Everything below 0xFE00 is whole pages.
+static enum memRegion regionOf(unsigned short address)
+{
+    static const unsigned char lower[16] = {
+        REGION_ROM0, REGION_ROM0, REGION_ROM0, REGION_ROM0, REGION_ROMX, REGION_ROMX, REGION_ROMX, REGION_ROMX,
+        REGION_VRAM, REGION_VRAM, REGION_SRAM, REGION_SRAM, REGION_WRAM, REGION_WRAM, REGION_ECHO, REGION_ECHO};
+
+    if (address < 0xFE00)
+        return (enum memRegion)lower[address >> 12];
+    if (address < 0xFEA0)
+        return REGION_OAM;
+    if (address < 0xFF00)
+        return REGION_UNUSABLE;
+    if (address < 0xFF80)
+        return REGION_IO;
+    if (address < 0xFFFF)
+        return REGION_HRAM;
+    return REGION_IE;
+}
+
+void memStatsAccess(unsigned short address, int write)
+{
+    if (memStatsSuspended)
+        return;
+
+    regions[regionOf(address)][write]++;
+    pages[address >> 8][write]++;
+}
+
+// The real machine makes the same access again, and is counted (and reported) then
+int memStatsInvalid(unsigned short address, int write)
+{
+    if (memStatsSuspended)
+        return 1;
+
+    invalid[address][write]++;
+    return 1;
+}
+
+static int writeCsv(const char *fileName)
+{
+    FILE *f = fopen(fileName, "w");
+    unsigned int i;
+
+    if (f == NULL)
+    {
+        printf("Failed to open \"%s\".\n", fileName);
+        return 0;
+    }
+
+    fprintf(f, "kind,name,reads,writes\n");
+    for (i = 0; i < REGION_COUNT; i++)
+        fprintf(f, "region,%s,%llu,%llu\n", regionNames[i], regions[i][0], regions[i][1]);
+    for (i = 0; i < 0x100; i++)
+        fprintf(f, "page,0x%02X00,%llu,%llu\n", i, pages[i][0], pages[i][1]);
+    for (i = 0; i < 0x10000; i++)
+    {
+        if (invalid[i][0] || invalid[i][1])
+            fprintf(f, "invalid,0x%04X,%llu,%llu\n", i, invalid[i][0], invalid[i][1]);
+    }
+
+    fclose(f);
+    return 1;
+}
+
+// Black - blue - red - yellow - white for 0 - 1
+static unsigned int heat(double t)
+{
+    static const unsigned char ramp[5][3] = {{0, 0, 0}, {0, 0, 255}, {255, 0, 0}, {255, 255, 0}, {255, 255, 255}};
+    double position = t * 4;
+    int index = position >= 4 ? 3 : (int)position;
+    double fraction = position - index;
+    unsigned int colour = 0xFF000000;
+    int channel;
+
+    for (channel = 0; channel < 3; channel++)
+    {
+        double value = ramp[index][channel] + (ramp[index + 1][channel] - ramp[index][channel]) * fraction;
+        colour |= (unsigned int)(value + 0.5) << (16 - 8 * channel);
+    }
+
+    return colour;
+}
+
+static int writeHeatmap(const char *fileName)
+{
+    unsigned int *pixels = malloc(sizeof(unsigned int) * HEATMAP_WIDTH * HEATMAP_PANEL);
+    unsigned long long most = 0;
+    int write, page, x, y, result;
+
+    if (pixels == NULL)
+        return 0;
+
+    // One scale for both panels, so reads & writes can be compared
+    for (page = 0; page < 0x100; page++)
+    {
+        if (pages[page][0] > most)
+            most = pages[page][0];
+        if (pages[page][1] > most)
+            most = pages[page][1];
+    }
+
+    for (y = 0; y < HEATMAP_PANEL; y++)
+    {
+        for (x = 0; x < HEATMAP_WIDTH; x++)
+            pixels[y * HEATMAP_WIDTH + x] = HEATMAP_BACKGROUND;
+    }
+
+    for (write = 0; write < 2; write++)
+    {
+        for (page = 0; page < 0x100; page++)
+        {
+            unsigned long long count = pages[page][write];
+            unsigned int colour = count ? heat(log1p((double)count) / log1p((double)most)) : HEATMAP_UNTOUCHED;
+            int left = write * (HEATMAP_PANEL + HEATMAP_GAP) + (page & 15) * HEATMAP_CELL;
+            int top = (page >> 4) * HEATMAP_CELL;
+
+            // A pixel of background round each cell so the pages can be told apart
+            for (y = 1; y < HEATMAP_CELL; y++)
+            {
+                for (x = 1; x < HEATMAP_CELL; x++)
+                    pixels[(top + y) * HEATMAP_WIDTH + left + x] = colour;
+            }
+        }
+    }
+
+    result = writePNG(fileName, pixels, HEATMAP_WIDTH, HEATMAP_PANEL);
+    free(pixels);
+    return result;
+}
+
+static void writeStats(const char *name)
+{
+    char fileName[64];
+
+    sprintf(fileName, "%s.csv", name);
+    if (!writeCsv(fileName))
+        return;
+    sprintf(fileName, "%s.png", name);
+    if (writeHeatmap(fileName))
+        printf("Memory statistics written to %s.csv & %s.png\n", name, name);
+}
+
+/*
+    dumpMemStats
+    ---
+    On demand (M). The counts carry on from where they are, they aren't reset.
+*/
+void dumpMemStats(void)
+{
+    char name[64];
+
+    sprintf(name, "%s_%u", MEMSTATS_FILE, ++dumps);
+    writeStats(name);
+}
+
+void finishMemStats(void)
+{
+    writeStats(MEMSTATS_FILE);
+}
+
+#endif
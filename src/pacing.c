@@ -0,0 +1,106 @@
+/*
+    NAME: TMC
+    INIT DATE: 19/10/2026
+    LAST EDIT DATE: 19/10/2026
+    DESC:
+        Frame pacing. See 'include/pacing.h'.
+*/
+
+#include "../include/pacing.h"
+#include "../include/apu.h"
+#include "../include/frameskip.h"
+#include <SDL2/SDL.h>
+
+#define PACING_SPIN_MS 2         // SDL_Delay is only trusted to within ~1ms, so spin for the last 2ms
+#define PACING_MAX_BEHIND 4      // Frames we can fall behind before giving up on catching up
+#define AUDIO_TARGET_FILL 2400   // Samples we try to keep queued, 50ms at 48kHz
+#define AUDIO_MAX_RATE_DELTA 0.005 // Dynamic rate control never changes the rate by more than 0.5%
+
+struct pacing pacing;
+
+/*
+    initPacing
+    ---
+    Call once before the first frame. 'enabled' = 0 turns pacing off completely (for benchmarks).
+*/
+void initPacing(unsigned char enabled)
+{
+    unsigned long long frequency = SDL_GetPerformanceFrequency();
+
+    pacing.enabled = enabled;
+    pacing.frameDuration = (unsigned long long)(frequency / FRAME_RATE);
+    pacing.spinTime = frequency * PACING_SPIN_MS / 1000;
+    pacing.nextFrame = SDL_GetPerformanceCounter() + pacing.frameDuration;
+    pacing.rate = 1.0;
+}
+
+/*
+    waitUntil
+    ---
+    Sleep for most of the time until 'target', then spin for the rest.
+*/
+static void waitUntil(unsigned long long target)
+{
+    unsigned long long now = SDL_GetPerformanceCounter();
+
+    if (now + pacing.spinTime < target)
+        SDL_Delay((Uint32)((target - now - pacing.spinTime) * 1000 / SDL_GetPerformanceFrequency()));
+
+    while (SDL_GetPerformanceCounter() < target)
+        ;
+}
+
+/*
+    paceAudio
+    ---
+    Let the audio device set the speed. Waits while the ring holds more than a frame over the target,
+    then adjusts the APU's output rate in proportion to how far from the target the ring is.
+*/
+static void paceAudio(void)
+{
+    size_t frameSamples = (size_t)(AUDIO_SAMPLE_RATE / FRAME_RATE);
+    double error;
+
+    // The callback drains the ring in chunks, so just sleep a millisecond at a time
+    while (ringbufferCount(&audioRing) > AUDIO_TARGET_FILL + frameSamples)
+        SDL_Delay(1);
+
+    // Over target -> produce slightly fewer samples, under target -> slightly more
+    error = ((double)AUDIO_TARGET_FILL - (double)ringbufferCount(&audioRing)) / AUDIO_TARGET_FILL;
+    if (error > 1.0)
+        error = 1.0;
+    else if (error < -1.0)
+        error = -1.0;
+
+    pacing.rate = 1.0 + error * AUDIO_MAX_RATE_DELTA;
+    apuSetRate(pacing.rate);
+}
+
+/*
+    paceFrame
+    ---
+    Called at the end of every frame, after the APU has handed over its samples. Returns once the next
+    frame is due.
+*/
+void paceFrame(void)
+{
+    unsigned long long now;
+
+    // Turbo is meant to run as fast as it can
+    if (!pacing.enabled || frameskip.mode == FRAMESKIP_TURBO)
+        return;
+
+    if (audioIsOpen())
+    {
+        paceAudio();
+        return;
+    }
+
+    waitUntil(pacing.nextFrame);
+    pacing.nextFrame += pacing.frameDuration;
+
+    // If the host stalled (window dragged, debugger...) don't race to catch up, just carry on from now
+    now = SDL_GetPerformanceCounter();
+    if (now > pacing.nextFrame + pacing.frameDuration * PACING_MAX_BEHIND)
+        pacing.nextFrame = now + pacing.frameDuration;
+}
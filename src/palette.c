@@ -0,0 +1,168 @@
+/*
+    NAME: TMC
+    INIT DATE: 19/10/2026
+    LAST EDIT DATE: 19/10/2026
+    DESC:
+        DMG palettes. See 'include/palette.h'.
+*/
+
+#include "../include/palette.h"
+#include "../include/gpu.h"
+#include "../include/cgb.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+// Host pixels are in the streaming texture's format (ARGB8888, see display.c)
+#define HOST_PIXEL(rgb) (0xFF000000 | (rgb))
+
+static const struct paletteTheme themes[] = {
+    {"grey", {HOST_PIXEL(0xFFFFFF), HOST_PIXEL(0xC0C0C0), HOST_PIXEL(0x606060), HOST_PIXEL(0x000000)}},
+    {"green", {HOST_PIXEL(0x9BBC0F), HOST_PIXEL(0x8BAC0F), HOST_PIXEL(0x306230), HOST_PIXEL(0x0F380F)}},
+    {"pocket", {HOST_PIXEL(0xC4CFA1), HOST_PIXEL(0x8B956D), HOST_PIXEL(0x4D533C), HOST_PIXEL(0x1F1F1F)}},
+};
+#define THEME_COUNT (sizeof(themes) / sizeof(themes[0]))
+
+static struct paletteTheme custom = {"custom"};
+
+struct palettes palettes = {.theme = &themes[0]};
+
+static unsigned int nextColourStamp; // Never rewound, like the tile stamps in gpu.c
+
+/*
+    setPaletteTheme
+    ---
+    Use a built in theme by name, or a custom one given as 4 comma separated RRGGBB colours. Returns 0
+    if 'name' is neither.
+*/
+int setPaletteTheme(const char *name)
+{
+    unsigned int i;
+    char *end;
+
+    for (i = 0; i < THEME_COUNT; i++)
+    {
+        if (!strcmp(name, themes[i].name))
+        {
+            palettes.theme = &themes[i];
+            rebuildPalettes();
+            invalidateBackground();
+            return 1;
+        }
+    }
+
+    for (i = 0; i < 4; i++)
+    {
+        unsigned long rgb = strtoul(name, &end, 16);
+
+        if (end - name != 6 || *end != (i < 3 ? ',' : '\0'))
+        {
+            printf("Unknown palette \"%s\" (grey, green, pocket or RRGGBB,RRGGBB,RRGGBB,RRGGBB).\n", name);
+            return 0;
+        }
+
+        custom.shades[i] = HOST_PIXEL(rgb);
+        name = end + 1;
+    }
+
+    palettes.theme = &custom;
+    rebuildPalettes();
+    invalidateBackground();
+    return 1;
+}
+
+// P key. Goes round the built in themes, and the custom one if there is one.
+void nextPaletteTheme(void)
+{
+    unsigned int next = palettes.theme == &custom ? 0 : (unsigned int)(palettes.theme - themes) + 1;
+
+    if (next < THEME_COUNT)
+        palettes.theme = &themes[next];
+    else if (custom.shades[0] != 0 && palettes.theme != &custom)
+        palettes.theme = &custom;
+    else
+        palettes.theme = &themes[0];
+
+    rebuildPalettes();
+    invalidateBackground(); // The cache only notices BGP itself changing
+    printf("Palette: %s\n", palettes.theme->name);
+}
+
+static void buildTable(unsigned int *table, unsigned char value)
+{
+    int i;
+
+    for (i = 0; i < 4; i++)
+        table[i] = palettes.theme->shades[(value >> (i * 2)) & 3];
+}
+
+/*
+    writePalette
+    ---
+    BGP, OBP0 or OBP1 was written. The register itself is kept in 'gpu' so it can be read back and is
+    part of save states.
+*/
+void writePalette(unsigned short address, unsigned char value)
+{
+    if (address == 0xFF47)
+    {
+        int byte;
+
+        gpu.backgroundPalette = value;
+        buildTable(palettes.background, value);
+
+        for (byte = 0; byte < 256; byte++)
+        {
+            palettes.backgroundRow[byte][0] = palettes.background[(byte >> 6) & 3];
+            palettes.backgroundRow[byte][1] = palettes.background[(byte >> 4) & 3];
+            palettes.backgroundRow[byte][2] = palettes.background[(byte >> 2) & 3];
+            palettes.backgroundRow[byte][3] = palettes.background[byte & 3];
+        }
+    }
+    else
+    {
+        gpu.spritePalette[address - 0xFF48] = value;
+        buildTable(palettes.sprite[address - 0xFF48], value);
+    }
+}
+
+/*
+    writeColourPalette
+    ---
+    Colour 'colour' (0 - 31, 4 to a palette) of the CGB background or sprite palettes has changed in
+    'cgb.paletteRam'. RGB555 is widened to 8 bits a channel by repeating the top bits.
+*/
+void writeColourPalette(int sprites, int colour)
+{
+    unsigned int rgb555 = cgb.paletteRam[sprites][colour * 2] | (cgb.paletteRam[sprites][colour * 2 + 1] << 8);
+    unsigned int red = rgb555 & 0x1F;
+    unsigned int green = (rgb555 >> 5) & 0x1F;
+    unsigned int blue = (rgb555 >> 10) & 0x1F;
+    unsigned int pixel = HOST_PIXEL((((red << 3) | (red >> 2)) << 16) | (((green << 3) | (green >> 2)) << 8) | ((blue << 3) | (blue >> 2)));
+
+    if (sprites)
+    {
+        palettes.cgbSprite[colour >> 2][colour & 3] = pixel;
+    }
+    else if (palettes.cgbBackground[colour >> 2][colour & 3] != pixel) // Only redraw the background if it has to
+    {
+        palettes.cgbBackground[colour >> 2][colour & 3] = pixel;
+        palettes.cgbBackgroundStamps[colour >> 2] = ++nextColourStamp;
+    }
+}
+
+// After the theme changes or a save state is loaded
+void rebuildPalettes(void)
+{
+    int colour;
+
+    writePalette(0xFF47, gpu.backgroundPalette);
+    writePalette(0xFF48, gpu.spritePalette[0]);
+    writePalette(0xFF49, gpu.spritePalette[1]);
+
+    for (colour = 0; colour < 32; colour++)
+    {
+        writeColourPalette(0, colour);
+        writeColourPalette(1, colour);
+    }
+}
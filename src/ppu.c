@@ -0,0 +1,143 @@
+/*
+    NAME: TMC
+    INIT DATE: 19/10/2026
+    LAST EDIT DATE: 19/10/2026
+    DESC:
+        PPU engine selection. See 'include/ppu.h'.
+*/
+
+#include "../include/ppu.h"
+#include "../include/gpu.h"
+#include "../include/apu.h"
+#include <ctype.h>
+#include <stdio.h>
+#include <string.h>
+
+const struct ppuEngine fastEngine = {"fast", stepGPU};
+const struct ppuEngine accurateEngine = {"accurate", stepAccurateGPU};
+
+const struct ppuEngine *ppu = &fastEngine;
+
+struct ppuAuto ppuAuto;
+
+static enum ppuSelection selection = PPU_AUTO;
+
+static const char *selectionNames[] = {"fast", "accurate", "auto"};
+
+int parsePpuSelection(const char *name, enum ppuSelection *result)
+{
+    unsigned int i;
+
+    for (i = 0; i < sizeof(selectionNames) / sizeof(selectionNames[0]); i++)
+    {
+        if (!strcmp(name, selectionNames[i]))
+        {
+            *result = (enum ppuSelection)i;
+            return 1;
+        }
+    }
+
+    printf("Unknown PPU engine \"%s\" (fast, accurate, auto).\n", name);
+    return 0;
+}
+
+void selectPpu(enum ppuSelection value)
+{
+    selection = value;
+    ppu = selection == PPU_ACCURATE ? &accurateEngine : &fastEngine;
+    ppuAuto.cleanFrames = 0;
+    ppuAuto.midLineWrites = 0;
+}
+
+// Trim spaces off both ends, in place
+static char *trim(char *text)
+{
+    char *end;
+
+    while (isspace((unsigned char)*text))
+        text++;
+
+    end = text + strlen(text);
+    while (end > text && isspace((unsigned char)end[-1]))
+        *--end = '\0';
+
+    return text;
+}
+
+/*
+    selectPpuForRom
+    ---
+    Use the engine PPU_LIST_FILE gives for this ROM title, if the file exists and has one.
+*/
+void selectPpuForRom(const char *title)
+{
+    FILE *f = fopen(PPU_LIST_FILE, "r");
+    char line[256];
+    enum ppuSelection value;
+
+    if (f == NULL)
+        return;
+
+    while (fgets(line, sizeof(line), f) != NULL)
+    {
+        char *comment = strchr(line, '#');
+        char *equals;
+
+        if (comment != NULL)
+            *comment = '\0';
+
+        equals = strrchr(line, '=');
+        if (equals == NULL)
+            continue;
+        *equals = '\0';
+
+        if (!strcmp(trim(line), title) && parsePpuSelection(trim(equals + 1), &value))
+        {
+            printf("PPU engine \"%s\" for \"%s\" (from %s)\n", selectionNames[value], title, PPU_LIST_FILE);
+            selectPpu(value);
+            break;
+        }
+    }
+
+    fclose(f);
+}
+
+/*
+    ppuMidLineWrite
+    ---
+    A PPU register was written during mode 3. Only 'fast' gets this wrong, auto mode counts these to
+    know when to switch.
+*/
+void ppuMidLineWrite(void)
+{
+    ppuAuto.midLineWrites++;
+}
+
+/*
+    ppuEndFrame
+    ---
+    Called as VBLANK starts. In auto mode, go to 'accurate' for the next frame if this one had
+    mid-line writes, and back to 'fast' once there haven't been any for a while. Switches are only
+    reported on frames with sound: the muted ones run-ahead rewinds would report them again.
+*/
+void ppuEndFrame(void)
+{
+    if (selection == PPU_AUTO)
+    {
+        if (ppuAuto.midLineWrites)
+        {
+            if (ppu != &accurateEngine && !apu.mute)
+                printf("PPU: mid-line register writes, switching to the accurate engine\n");
+            ppu = &accurateEngine;
+            ppuAuto.cleanFrames = 0;
+        }
+        else if (ppu == &accurateEngine && ++ppuAuto.cleanFrames >= PPU_AUTO_HOLD_FRAMES)
+        {
+            if (!apu.mute)
+                printf("PPU: no mid-line writes for %d frames, back to the fast engine\n", PPU_AUTO_HOLD_FRAMES);
+            ppu = &fastEngine;
+        }
+    }
+
+    ppuAuto.midLineWrites = 0;
+}
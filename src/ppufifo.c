@@ -0,0 +1,389 @@
+/*
+    NAME: TMC
+    INIT DATE: 19/10/2026
+    LAST EDIT DATE: 19/10/2026
+    DESC:
+        The accurate PPU engine: a DMG pixel FIFO run one dot at a time through mode 3. See
+        'include/ppu.h'.
+
+        Each dot the fetcher moves on a step, then (unless a sprite fetch is holding things up) one
+        pixel is shifted out of the FIFO, mixed with the sprite FIFO, and run through the palette
+        tables as they are right then.
+
+            - the fetcher takes 6 dots to fetch a tile (index, low byte, high byte) and only pushes
+              its 8 pixels once the FIFO is empty, so in the steady state it keeps up exactly
+            - mode 3 starts with a fetch that is thrown away, then SCX & 7 pixels are thrown away
+            - a sprite stops the pixels while the current background fetch finishes, then for the 6
+              dots its own fetch takes (6 - 11 dots in all)
+            - the window clears the FIFO and starts the fetcher again on the window's tile map
+
+        Mode 3 is then 172 dots plus those extras, and HBLANK is whatever is left of the 456.
+        Registers (SCX, SCY, LCDC, BGP, OBP0/1, WX, the CGB colour palettes) are read when the hardware
+        would, so writes made part way through a line show up from that point on.
+
+        In CGB mode the fetcher also reads the map cell's attribute byte, and each pixel in the FIFO
+        carries its palette & priority bit along with its colour number.
+*/
+
+#include "../include/ppu.h"
+#include "../include/gpu.h"
+#include "../include/cpu.h"
+#include "../include/memory.h"
+#include "../include/display.h"
+#include "../include/frameskip.h"
+#include "../include/palette.h"
+#include "../include/main.h"
+#include "../include/cgb.h"
+#include <string.h>
+
+#define FETCH_DOTS 6
+#define FIRST_FETCH_DOTS 7 // The thrown away fetch at the start of mode 3, plus the dot before it
+#define SPRITE_FETCH_DOTS 6
+#define LINE_DOTS 456
+#define OAM_DOTS 80
+
+struct spritePixel
+{
+    unsigned char colour; // 0 = transparent
+    unsigned char palette;
+    unsigned char behind; // Only show over background colour 0
+    unsigned char index;  // OAM number, for CGB priority
+};
+
+static struct
+{
+    unsigned char pixels[8]; // Background/window FIFO, colour numbers (CGB: | palette << 2 | priority)
+    unsigned char head;
+    unsigned char count;
+    struct spritePixel sprites[8]; // Sprite FIFO, sprites[0] goes with the next pixel out
+
+    // Fetcher
+    unsigned char step; // Dots into the fetch, FETCH_DOTS = waiting to push
+    unsigned char column;
+    unsigned char window;
+    unsigned short tile;
+    unsigned char tileRow;
+    unsigned char attribute; // CGB map attribute, 0 on a DMG
+    unsigned char row[8];
+
+    // The line
+    unsigned int *line; // NULL on frames that aren't drawn
+    int x;              // Next pixel on the screen
+    unsigned char discard;
+    unsigned short dots;
+    unsigned char startup;
+    unsigned char windowUsed;
+    const unsigned char *lineSprites[10];
+    unsigned char spriteCount;
+    unsigned char spriteDone[10];
+    int spriteWait;
+    const unsigned char *spriteFetching;
+
+    unsigned short hblankDots;
+} fifo = {.hblankDots = LINE_DOTS - OAM_DOTS - 172};
+
+/*
+    startLine
+    ---
+    End of mode 2. Find the sprites on this line (the first 10 in OAM, sorted by X with OAM order
+    breaking ties) and reset the FIFOs & fetcher.
+*/
+static void startLine(void)
+{
+    unsigned char height = (gpu.control & GPU_CONTROL_SPRITEVDOUBLE) ? 16 : 8;
+    int i, j;
+
+    fifo.spriteCount = 0;
+    for (i = 0; i < 40 && fifo.spriteCount < 10; i++)
+    {
+        const unsigned char *sprite = oam + i * 4;
+        int top = sprite[0] - 16;
+
+        if (gpu.scanline >= top && gpu.scanline < top + height)
+        {
+            for (j = fifo.spriteCount++; j > 0 && fifo.lineSprites[j - 1][1] > sprite[1]; j--)
+                fifo.lineSprites[j] = fifo.lineSprites[j - 1];
+            fifo.lineSprites[j] = sprite;
+        }
+    }
+    memset(fifo.spriteDone, 0, sizeof(fifo.spriteDone));
+
+    fifo.head = 0;
+    fifo.count = 0;
+    memset(fifo.sprites, 0, sizeof(fifo.sprites));
+    fifo.step = 0;
+    fifo.column = 0;
+    fifo.window = 0;
+
+    fifo.line = frameskip.renderFrame ? framebuffer + gpu.scanline * SCREEN_WIDTH : NULL;
+    fifo.x = 0;
+    fifo.discard = gpu.scrollX & 7;
+    fifo.dots = 0;
+    fifo.startup = FIRST_FETCH_DOTS;
+    fifo.windowUsed = 0;
+    fifo.spriteWait = 0;
+}
+
+// One dot of the background/window fetcher
+static void fetcherDot(void)
+{
+    if (fifo.step < FETCH_DOTS)
+    {
+        fifo.step++;
+
+        if (fifo.step == 2) // Tile index
+        {
+            int map, mapX, mapY;
+
+            if (fifo.window)
+            {
+                map = (gpu.control & GPU_CONTROL_WINDOWTILEMAP) ? 0x1c00 : 0x1800;
+                mapX = fifo.column & 31;
+                mapY = gpu.windowLine;
+            }
+            else
+            {
+                map = (gpu.control & GPU_CONTROL_TILEMAP) ? 0x1c00 : 0x1800;
+                mapX = ((gpu.scrollX >> 3) + fifo.column) & 31;
+                mapY = (gpu.scanline + gpu.scrollY) & 255;
+            }
+
+            fifo.tile = vram[map + ((mapY >> 3) << 5) + mapX];
+            fifo.tileRow = mapY & 7;
+            fifo.attribute = cgb.enabled ? vram[0x2000 + map + ((mapY >> 3) << 5) + mapX] : 0;
+        }
+        else if (fifo.step == FETCH_DOTS) // Tile data, both bytes
+        {
+            unsigned short tile = fifo.tile;
+            unsigned char attribute = fifo.attribute;
+            int row = fifo.tileRow;
+            int x;
+
+            if (!(gpu.control & GPU_CONTROL_TILESET) && tile < 128)
+                tile += 256;
+
+            if (!attribute)
+            {
+                memcpy(fifo.row, tiles[tile][row], 8);
+            }
+            else
+            {
+                if (attribute & GPU_ATTRIBUTE_BANK)
+                    tile += 384;
+                if (attribute & GPU_ATTRIBUTE_YFLIP)
+                    row = 7 - row;
+
+                for (x = 0; x < 8; x++)
+                    fifo.row[x] = tiles[tile][row][(attribute & GPU_ATTRIBUTE_XFLIP) ? 7 - x : x] |
+                                  ((attribute & GPU_ATTRIBUTE_PALETTE) << 2) | (attribute & GPU_ATTRIBUTE_PRIORITY);
+            }
+        }
+    }
+
+    if (fifo.step == FETCH_DOTS && fifo.count == 0)
+    {
+        memcpy(fifo.pixels, fifo.row, 8);
+        fifo.head = 0;
+        fifo.count = 8;
+        fifo.step = 0;
+        fifo.column++;
+    }
+}
+
+// The sprite fetch is done, put its pixels in the sprite FIFO where nothing is already (on a CGB,
+// also over sprites later in OAM)
+static void mergeSprite(const unsigned char *sprite)
+{
+    unsigned char index = (unsigned char)((sprite - oam) / 4);
+    unsigned char height = (gpu.control & GPU_CONTROL_SPRITEVDOUBLE) ? 16 : 8;
+    unsigned char flags = sprite[3];
+    int row = gpu.scanline - (sprite[0] - 16);
+    unsigned short tile = sprite[2];
+    const unsigned char *pixels;
+    int i;
+
+    if (flags & 0x40) // Y flip
+        row = height - 1 - row;
+    if (height == 16)
+        tile = (tile & 0xFE) + (row >> 3);
+    if (cgb.enabled && (flags & GPU_ATTRIBUTE_BANK))
+        tile += 384;
+    pixels = tiles[tile][row & 7];
+
+    for (i = 0; i < 8; i++)
+    {
+        int position = sprite[1] - 8 + i - fifo.x; // Place in the sprite FIFO
+        unsigned char colour = pixels[(flags & 0x20) ? 7 - i : i];
+
+        if (position < 0 || position >= 8)
+            continue;
+        if (fifo.sprites[position].colour && !(cgb.enabled && colour && index < fifo.sprites[position].index))
+            continue;
+
+        fifo.sprites[position].colour = colour;
+        fifo.sprites[position].palette = cgb.enabled ? (flags & GPU_ATTRIBUTE_PALETTE) : (flags >> 4) & 1;
+        fifo.sprites[position].behind = (flags & 0x80) != 0;
+        fifo.sprites[position].index = index;
+    }
+}
+
+/*
+    dot
+    ---
+    One dot of mode 3. Returns 1 once the last pixel of the line is out.
+*/
+static int dot(void)
+{
+    int i;
+
+    fifo.dots++;
+
+    if (fifo.startup)
+    {
+        fifo.startup--;
+        return 0;
+    }
+
+    fetcherDot();
+
+    if (fifo.spriteWait)
+    {
+        if (--fifo.spriteWait == 0)
+            mergeSprite(fifo.spriteFetching);
+        return 0;
+    }
+
+    // The window starts at WX - 7 (WX under 7 starts it off the left edge). LCDC bit 0 only turns it off on a DMG.
+    if (!fifo.window && !fifo.discard && (gpu.control & GPU_CONTROL_WINDOWENABLE) && ((gpu.control & GPU_CONTROL_BGENABLE) || cgb.enabled) &&
+        gpu.scanline >= gpu.windowY && gpu.windowX <= 166 && fifo.x >= gpu.windowX - 7)
+    {
+        fifo.window = 1;
+        fifo.windowUsed = 1;
+        fifo.count = 0;
+        fifo.step = 0;
+        fifo.column = 0;
+        if (gpu.windowX < 7)
+            fifo.discard = 7 - gpu.windowX;
+        return 0;
+    }
+
+    if (fifo.count == 0)
+        return 0;
+
+    // A sprite starting here (or off the left edge, at X 0)
+    if ((gpu.control & GPU_CONTROL_SPRITEENABLE) && !fifo.discard)
+    {
+        for (i = 0; i < fifo.spriteCount; i++)
+        {
+            if (!fifo.spriteDone[i] && fifo.lineSprites[i][1] - 8 <= fifo.x)
+            {
+                fifo.spriteDone[i] = 1;
+                fifo.spriteFetching = fifo.lineSprites[i];
+                fifo.spriteWait = SPRITE_FETCH_DOTS + (FETCH_DOTS - fifo.step);
+                return 0;
+            }
+        }
+    }
+
+    // Shift a pixel out
+    {
+        unsigned char value = fifo.pixels[fifo.head++];
+        unsigned char colour = value & 3;
+        struct spritePixel sprite = fifo.sprites[0];
+        unsigned int pixel;
+        unsigned char hidden; // The background/window goes over the sprite here
+
+        fifo.count--;
+        memmove(fifo.sprites, fifo.sprites + 1, sizeof(fifo.sprites) - sizeof(fifo.sprites[0]));
+        fifo.sprites[7].colour = 0;
+
+        if (fifo.discard)
+        {
+            fifo.discard--;
+            return 0;
+        }
+
+        if (cgb.enabled)
+        {
+            // LCDC bit 0 only takes the background's priority away
+            pixel = palettes.cgbBackground[(value >> 2) & GPU_ATTRIBUTE_PALETTE][colour];
+            hidden = colour && (gpu.control & GPU_CONTROL_BGENABLE) && (sprite.behind || (value & GPU_ATTRIBUTE_PRIORITY));
+        }
+        else if (!(gpu.control & GPU_CONTROL_BGENABLE))
+        {
+            pixel = palettes.theme->shades[0];
+            hidden = 0;
+        }
+        else
+        {
+            pixel = palettes.background[colour];
+            hidden = colour && sprite.behind;
+        }
+
+        if (sprite.colour && (gpu.control & GPU_CONTROL_SPRITEENABLE) && !hidden)
+            pixel = cgb.enabled ? palettes.cgbSprite[sprite.palette][sprite.colour] : palettes.sprite[sprite.palette][sprite.colour];
+
+        if (fifo.line != NULL)
+            fifo.line[fifo.x] = pixel;
+        fifo.x++;
+    }
+
+    return fifo.x == SCREEN_WIDTH;
+}
+
+/*
+    stepAccurateGPU
+    ---
+    Catch the PPU up to the CPU. Modes other than 3 are handled in whole pieces like the fast engine,
+    mode 3 a dot at a time.
+*/
+void stepAccurateGPU(void)
+{
+    gpu.tick += ticks - gpu.lastTicks;
+    gpu.lastTicks = ticks;
+
+    for (;;)
+    {
+        switch (gpu.mode)
+        {
+        case GPU_MODE_HBLANK:
+            if (gpu.tick < fifo.hblankDots)
+                return;
+            gpu.tick -= fifo.hblankDots;
+            endScanline();
+            break;
+
+        case GPU_MODE_VBLANK:
+            if (gpu.tick < LINE_DOTS)
+                return;
+            gpu.tick -= LINE_DOTS;
+            endVblankLine();
+            break;
+
+        case GPU_MODE_OAM:
+            if (gpu.tick < OAM_DOTS)
+                return;
+            gpu.tick -= OAM_DOTS;
+            startLine();
+            gpu.mode = GPU_MODE_VRAM;
+            break;
+
+        case GPU_MODE_VRAM:
+            while (gpu.tick)
+            {
+                gpu.tick--;
+                if (dot())
+                {
+                    fifo.hblankDots = LINE_DOTS - OAM_DOTS - fifo.dots;
+                    if (fifo.windowUsed)
+                        gpu.windowLine++;
+                    setGpuMode(GPU_MODE_HBLANK);
+                    break;
+                }
+            }
+            if (gpu.mode == GPU_MODE_VRAM)
+                return;
+            break;
+        }
+    }
+}
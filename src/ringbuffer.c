@@ -0,0 +1,126 @@
+/*
+    NAME: TMC
+    INIT DATE: 19/10/2026
+    LAST EDIT DATE: 19/10/2026
+    DESC:
+        Lock-free SPSC ring buffer. See 'include/ringbuffer.h'.
+*/
+
+#include "../include/ringbuffer.h"
+#include <stdlib.h>
+#include <string.h>
+
+/*
+    ringbufferInit
+    ---
+    Allocate a ring that holds 'capacity' elements of 'elementSize' bytes. Capacity is rounded up to
+    the next power of two. Returns 1 on success.
+*/
+int ringbufferInit(struct ringbuffer *ring, size_t elementSize, size_t capacity)
+{
+    size_t size = 1;
+    while (size < capacity)
+        size <<= 1;
+
+    ring->data = malloc(size * elementSize);
+    if (ring->data == NULL)
+        return 0;
+
+    ring->elementSize = elementSize;
+    ring->capacity = size;
+    atomic_init(&ring->head, 0);
+    atomic_init(&ring->tail, 0);
+
+    return 1;
+}
+
+void ringbufferFree(struct ringbuffer *ring)
+{
+    free(ring->data);
+    ring->data = NULL;
+}
+
+/*
+    ringbufferClear
+    ---
+    Throw away everything in the ring. Only safe while neither side is using it.
+*/
+void ringbufferClear(struct ringbuffer *ring)
+{
+    atomic_store(&ring->head, 0);
+    atomic_store(&ring->tail, 0);
+}
+
+/*
+    ringbufferWrite
+    ---
+    Producer side. Copies up to 'count' elements in and returns how many actually fit.
+*/
+size_t ringbufferWrite(struct ringbuffer *ring, const void *elements, size_t count)
+{
+    size_t head = atomic_load_explicit(&ring->head, memory_order_relaxed);
+    size_t tail = atomic_load_explicit(&ring->tail, memory_order_acquire);
+    size_t space = ring->capacity - (head - tail);
+    size_t index = head & (ring->capacity - 1);
+    size_t first;
+
+    if (count > space)
+        count = space;
+
+    // The free space may wrap around the end of the array, in which case copy in two parts
+    first = ring->capacity - index;
+    if (first > count)
+        first = count;
+
+    memcpy(ring->data + index * ring->elementSize, elements, first * ring->elementSize);
+    memcpy(ring->data, (const unsigned char *)elements + first * ring->elementSize, (count - first) * ring->elementSize);
+
+    // Publish the new elements only after they have been copied
+    atomic_store_explicit(&ring->head, head + count, memory_order_release);
+
+    return count;
+}
+
+/*
+    ringbufferRead
+    ---
+    Consumer side. Copies up to 'count' elements out and returns how many there were.
+*/
+size_t ringbufferRead(struct ringbuffer *ring, void *elements, size_t count)
+{
+    size_t tail = atomic_load_explicit(&ring->tail, memory_order_relaxed);
+    size_t head = atomic_load_explicit(&ring->head, memory_order_acquire);
+    size_t available = head - tail;
+    size_t index = tail & (ring->capacity - 1);
+    size_t first;
+
+    if (count > available)
+        count = available;
+
+    first = ring->capacity - index;
+    if (first > count)
+        first = count;
+
+    memcpy(elements, ring->data + index * ring->elementSize, first * ring->elementSize);
+    memcpy((unsigned char *)elements + first * ring->elementSize, ring->data, (count - first) * ring->elementSize);
+
+    // Hand the slots back to the producer only after they have been copied out
+    atomic_store_explicit(&ring->tail, tail + count, memory_order_release);
+
+    return count;
+}
+
+/*
+    ringbufferCount
+    ---
+    How many elements are waiting to be read. Safe to call from either side (it's a snapshot).
+*/
+size_t ringbufferCount(struct ringbuffer *ring)
+{
+    return atomic_load_explicit(&ring->head, memory_order_acquire) - atomic_load_explicit(&ring->tail, memory_order_acquire);
+}
+
+size_t ringbufferSpace(struct ringbuffer *ring)
+{
+    return ring->capacity - ringbufferCount(ring);
+}
@@ -36,6 +36,10 @@ const char *romTypeString[256] = {
     [ROM_HUDSON_HUC1] = "ROM_HUDSON_HUC1",
 };
 
+enum romType cartType;
+unsigned short romBankCount;
+unsigned char cartCgb;
+
 int loadROM(char *fileName)
 {
     char name[17];
@@ -104,6 +108,12 @@ int loadROM(char *fileName)
 
     printf("ROM type: %s\n", romTypeString[type]);
 
+    cartCgb = header[ROM_OFFSET_CGB];
+    if ((cartCgb & ROM_CGB_ONLY) == ROM_CGB_ONLY)
+        printf("ROM is for the CGB only.\n");
+    else if (cartCgb & ROM_CGB_ENHANCED)
+        printf("ROM is CGB enhanced.\n");
+
     // BELOW IS SOME ROM AND RAM SIZE CHEKCING I DONT UNDERSTAND YET! IF THE .rom FILE USED IS 100%
     // A PROPER ROM, THESE WILL ALWAYS PASS. WAIT ACTUALLY I THINK THESE ARE NOT NEEDED?
     // MORE TESTING TO FOLLOW, MAYBE DELETE THIS?
@@ -122,7 +132,13 @@ int loadROM(char *fileName)
 
     rewind(f);
 
-    cart = malloc(length);    
+    // Always at least 2 banks, so the switchable bank is never read past the end of the cart
+    cartType = type;
+    romBankCount = 2;
+    while ((size_t)romBankCount * 0x4000 < length)
+        romBankCount *= 2;
+
+    cart = calloc(romBankCount, 0x4000);
     fread(cart, length, 1, f);
     printf("First byte of ROM: %02x\n", cart[0]);
 
@@ -0,0 +1,562 @@
+/*
+    NAME: TMC
+    INIT DATE: 19/10/2026
+    LAST EDIT DATE: 19/10/2026
+    DESC:
+        CPU side upscalers. See 'include/scaler.h'.
+
+        The SIMD kernels work on 4 (SSE2) or 8 (AVX2) pixels of a row at once and write whole output
+        rows. Scale2x/3x need the pixels either side, so the first & last few pixels of each row go
+        through the C version, which clamps at the edges.
+
+        Pixel formats match the framebuffer: 32-bit ARGB. 'pitch' is the length of a destination row
+        in pixels (a locked texture's rows can be longer than the picture).
+*/
+
+#include "../include/scaler.h"
+#include "../include/main.h"
+#include <SDL2/SDL.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+#define SCALER_SIMD
+#include <immintrin.h>
+#define TARGET_SSE2 __attribute__((target("sse2")))
+#define TARGET_AVX2 __attribute__((target("avx2")))
+#endif
+
+#define LCD_FACTOR 3
+#define ALPHA 0xFF000000
+
+enum scalerMode scalerMode;
+
+static const char *scalerNames[] = {"none", "nearest", "scale2x", "scale3x", "lcd"};
+
+int parseScalerMode(const char *name, enum scalerMode *mode)
+{
+    unsigned int i;
+
+    for (i = 0; i < sizeof(scalerNames) / sizeof(scalerNames[0]); i++)
+    {
+        if (!strcmp(name, scalerNames[i]))
+        {
+            *mode = (enum scalerMode)i;
+            return 1;
+        }
+    }
+
+    printf("Unknown scaler \"%s\" (none, nearest, scale2x, scale3x, lcd).\n", name);
+    return 0;
+}
+
+// Average of each byte, rounding up (the same as _mm_avg_epu8)
+static unsigned int averageBytes(unsigned int a, unsigned int b)
+{
+    return (a | b) - (((a ^ b) >> 1) & 0x7F7F7F7F);
+}
+
+// 3/4 brightness, for the LCD grid
+static unsigned int darken(unsigned int pixel)
+{
+    return averageBytes(pixel, averageBytes(pixel, 0)) | ALPHA;
+}
+
+/*===========================================
+    C
+============================================*/
+
+static void copyRows(unsigned int *row, int pitch, int copies, int width)
+{
+    int i;
+
+    for (i = 1; i <= copies; i++)
+        memcpy(row + i * pitch, row, width * sizeof(row[0]));
+}
+
+static void nearestC(struct scaler *scaler, const unsigned int *source, unsigned int *destination, int pitch)
+{
+    int factor = scaler->factor;
+    int x, y, i;
+
+    for (y = 0; y < SCREEN_HEIGHT; y++)
+    {
+        unsigned int *out = destination + y * factor * pitch;
+
+        for (x = 0; x < SCREEN_WIDTH; x++)
+        {
+            for (i = 0; i < factor; i++)
+                *out++ = source[y * SCREEN_WIDTH + x];
+        }
+
+        copyRows(destination + y * factor * pitch, pitch, factor - 1, SCREEN_WIDTH * factor);
+    }
+}
+
+/*
+    scale2xPixels
+    ---
+    Scale2x of pixels [from, to) of row 'y'.
+
+        B        E0 E1
+      D E F  ->  E2 E3
+        H
+*/
+static void scale2xPixels(const unsigned int *source, unsigned int *destination, int pitch, int y, int from, int to)
+{
+    const unsigned int *row = source + y * SCREEN_WIDTH;
+    const unsigned int *up = y > 0 ? row - SCREEN_WIDTH : row;
+    const unsigned int *down = y < SCREEN_HEIGHT - 1 ? row + SCREEN_WIDTH : row;
+    unsigned int *out = destination + y * 2 * pitch;
+    int x;
+
+    for (x = from; x < to; x++)
+    {
+        unsigned int B = up[x], H = down[x], E = row[x];
+        unsigned int D = row[x > 0 ? x - 1 : x];
+        unsigned int F = row[x < SCREEN_WIDTH - 1 ? x + 1 : x];
+
+        if (B != H && D != F)
+        {
+            out[x * 2] = D == B ? D : E;
+            out[x * 2 + 1] = B == F ? F : E;
+            out[pitch + x * 2] = D == H ? D : E;
+            out[pitch + x * 2 + 1] = H == F ? F : E;
+        }
+        else
+        {
+            out[x * 2] = out[x * 2 + 1] = out[pitch + x * 2] = out[pitch + x * 2 + 1] = E;
+        }
+    }
+}
+
+static void scale2xC(struct scaler *scaler, const unsigned int *source, unsigned int *destination, int pitch)
+{
+    int y;
+
+    for (y = 0; y < SCREEN_HEIGHT; y++)
+        scale2xPixels(source, destination, pitch, y, 0, SCREEN_WIDTH);
+}
+
+/*
+    scale3xPixels
+    ---
+    Scale3x of pixels [from, to) of row 'y'.
+
+      A B C      E0 E1 E2
+      D E F  ->  E3 E4 E5
+      G H I      E6 E7 E8
+*/
+static void scale3xPixels(const unsigned int *source, unsigned int *destination, int pitch, int y, int from, int to)
+{
+    const unsigned int *row = source + y * SCREEN_WIDTH;
+    const unsigned int *up = y > 0 ? row - SCREEN_WIDTH : row;
+    const unsigned int *down = y < SCREEN_HEIGHT - 1 ? row + SCREEN_WIDTH : row;
+    unsigned int *out = destination + y * 3 * pitch;
+    int x;
+
+    for (x = from; x < to; x++)
+    {
+        int left = x > 0 ? x - 1 : x;
+        int right = x < SCREEN_WIDTH - 1 ? x + 1 : x;
+        unsigned int A = up[left], B = up[x], C = up[right];
+        unsigned int D = row[left], E = row[x], F = row[right];
+        unsigned int G = down[left], H = down[x], I = down[right];
+        unsigned int *o0 = out + x * 3, *o1 = o0 + pitch, *o2 = o1 + pitch;
+
+        if (B != H && D != F)
+        {
+            o0[0] = D == B ? D : E;
+            o0[1] = (D == B && E != C) || (B == F && E != A) ? B : E;
+            o0[2] = B == F ? F : E;
+            o1[0] = (D == B && E != G) || (D == H && E != A) ? D : E;
+            o1[1] = E;
+            o1[2] = (B == F && E != I) || (H == F && E != C) ? F : E;
+            o2[0] = D == H ? D : E;
+            o2[1] = (D == H && E != I) || (H == F && E != G) ? H : E;
+            o2[2] = H == F ? F : E;
+        }
+        else
+        {
+            o0[0] = o0[1] = o0[2] = o1[0] = o1[1] = o1[2] = o2[0] = o2[1] = o2[2] = E;
+        }
+    }
+}
+
+static void scale3xC(struct scaler *scaler, const unsigned int *source, unsigned int *destination, int pitch)
+{
+    int y;
+
+    for (y = 0; y < SCREEN_HEIGHT; y++)
+        scale3xPixels(source, destination, pitch, y, 0, SCREEN_WIDTH);
+}
+
+/*
+    lcdC
+    ---
+    Blend the frame into the last one (ghosting), then draw each pixel as a 3x3 block with its right
+    column & bottom row darkened (the grid).
+*/
+static void lcdC(struct scaler *scaler, const unsigned int *source, unsigned int *destination, int pitch)
+{
+    int x, y;
+
+    for (y = 0; y < SCREEN_HEIGHT; y++)
+    {
+        unsigned int *previous = scaler->previous + y * SCREEN_WIDTH;
+        unsigned int *out = destination + y * LCD_FACTOR * pitch;
+
+        for (x = 0; x < SCREEN_WIDTH; x++)
+        {
+            unsigned int pixel = averageBytes(previous[x], source[y * SCREEN_WIDTH + x]);
+            unsigned int dark = darken(pixel);
+
+            previous[x] = pixel;
+            out[x * 3] = out[x * 3 + 1] = out[pitch + x * 3] = out[pitch + x * 3 + 1] = pixel;
+            out[x * 3 + 2] = out[pitch + x * 3 + 2] = dark;
+            out[pitch * 2 + x * 3] = out[pitch * 2 + x * 3 + 1] = out[pitch * 2 + x * 3 + 2] = dark;
+        }
+    }
+}
+
+#ifdef SCALER_SIMD
+
+/*===========================================
+    SSE2
+============================================*/
+
+#define SELECT128(mask, a, b) _mm_or_si128(_mm_and_si128(mask, a), _mm_andnot_si128(mask, b))
+
+// a0 b0 c0 a1 | b1 c1 a2 b2 | c2 a3 b3 c3
+TARGET_SSE2 static void interleave3(unsigned int *out, __m128i a, __m128i b, __m128i c)
+{
+    __m128 ab = _mm_castsi128_ps(_mm_unpacklo_epi32(a, b));     // a0 b0 a1 b1
+    __m128 ca = _mm_castsi128_ps(_mm_unpacklo_epi32(c, a));     // c0 a0 c1 a1
+    __m128 bc = _mm_castsi128_ps(_mm_unpacklo_epi32(b, c));     // b0 c0 b1 c1
+    __m128 abHigh = _mm_castsi128_ps(_mm_unpackhi_epi32(a, b)); // a2 b2 a3 b3
+    __m128 caHigh = _mm_castsi128_ps(_mm_unpackhi_epi32(c, a)); // c2 a2 c3 a3
+    __m128 bcHigh = _mm_castsi128_ps(_mm_unpackhi_epi32(b, c)); // b2 c2 b3 c3
+
+    _mm_storeu_ps((float *)out, _mm_shuffle_ps(ab, ca, _MM_SHUFFLE(3, 0, 1, 0)));
+    _mm_storeu_ps((float *)out + 4, _mm_shuffle_ps(bc, abHigh, _MM_SHUFFLE(1, 0, 3, 2)));
+    _mm_storeu_ps((float *)out + 8, _mm_shuffle_ps(caHigh, bcHigh, _MM_SHUFFLE(3, 2, 3, 0)));
+}
+
+TARGET_SSE2 static void nearestSSE2(struct scaler *scaler, const unsigned int *source, unsigned int *destination, int pitch)
+{
+    int factor = scaler->factor;
+    int x, y;
+
+    if (factor != 2 && factor != 3)
+    {
+        nearestC(scaler, source, destination, pitch);
+        return;
+    }
+
+    for (y = 0; y < SCREEN_HEIGHT; y++)
+    {
+        unsigned int *out = destination + y * factor * pitch;
+
+        for (x = 0; x < SCREEN_WIDTH; x += 4)
+        {
+            __m128i p = _mm_loadu_si128((const __m128i *)(source + y * SCREEN_WIDTH + x));
+
+            if (factor == 2)
+            {
+                _mm_storeu_si128((__m128i *)(out + x * 2), _mm_unpacklo_epi32(p, p));
+                _mm_storeu_si128((__m128i *)(out + x * 2 + 4), _mm_unpackhi_epi32(p, p));
+            }
+            else
+            {
+                _mm_storeu_si128((__m128i *)(out + x * 3), _mm_shuffle_epi32(p, _MM_SHUFFLE(1, 0, 0, 0)));
+                _mm_storeu_si128((__m128i *)(out + x * 3 + 4), _mm_shuffle_epi32(p, _MM_SHUFFLE(2, 2, 1, 1)));
+                _mm_storeu_si128((__m128i *)(out + x * 3 + 8), _mm_shuffle_epi32(p, _MM_SHUFFLE(3, 3, 3, 2)));
+            }
+        }
+
+        copyRows(out, pitch, factor - 1, SCREEN_WIDTH * factor);
+    }
+}
+
+TARGET_SSE2 static void scale2xSSE2(struct scaler *scaler, const unsigned int *source, unsigned int *destination, int pitch)
+{
+    const __m128i ones = _mm_set1_epi32(-1);
+    int x, y;
+
+    for (y = 0; y < SCREEN_HEIGHT; y++)
+    {
+        const unsigned int *row = source + y * SCREEN_WIDTH;
+        const unsigned int *up = y > 0 ? row - SCREEN_WIDTH : row;
+        const unsigned int *down = y < SCREEN_HEIGHT - 1 ? row + SCREEN_WIDTH : row;
+        unsigned int *out = destination + y * 2 * pitch;
+
+        scale2xPixels(source, destination, pitch, y, 0, 1);
+
+        for (x = 1; x + 5 <= SCREEN_WIDTH; x += 4)
+        {
+            __m128i B = _mm_loadu_si128((const __m128i *)(up + x));
+            __m128i H = _mm_loadu_si128((const __m128i *)(down + x));
+            __m128i D = _mm_loadu_si128((const __m128i *)(row + x - 1));
+            __m128i E = _mm_loadu_si128((const __m128i *)(row + x));
+            __m128i F = _mm_loadu_si128((const __m128i *)(row + x + 1));
+
+            // B != H && D != F
+            __m128i edge = _mm_andnot_si128(_mm_or_si128(_mm_cmpeq_epi32(B, H), _mm_cmpeq_epi32(D, F)), ones);
+            __m128i e0 = SELECT128(_mm_and_si128(edge, _mm_cmpeq_epi32(D, B)), D, E);
+            __m128i e1 = SELECT128(_mm_and_si128(edge, _mm_cmpeq_epi32(B, F)), F, E);
+            __m128i e2 = SELECT128(_mm_and_si128(edge, _mm_cmpeq_epi32(D, H)), D, E);
+            __m128i e3 = SELECT128(_mm_and_si128(edge, _mm_cmpeq_epi32(H, F)), F, E);
+
+            _mm_storeu_si128((__m128i *)(out + x * 2), _mm_unpacklo_epi32(e0, e1));
+            _mm_storeu_si128((__m128i *)(out + x * 2 + 4), _mm_unpackhi_epi32(e0, e1));
+            _mm_storeu_si128((__m128i *)(out + pitch + x * 2), _mm_unpacklo_epi32(e2, e3));
+            _mm_storeu_si128((__m128i *)(out + pitch + x * 2 + 4), _mm_unpackhi_epi32(e2, e3));
+        }
+
+        scale2xPixels(source, destination, pitch, y, x, SCREEN_WIDTH);
+    }
+}
+
+TARGET_SSE2 static void scale3xSSE2(struct scaler *scaler, const unsigned int *source, unsigned int *destination, int pitch)
+{
+    const __m128i ones = _mm_set1_epi32(-1);
+    int x, y;
+
+    for (y = 0; y < SCREEN_HEIGHT; y++)
+    {
+        const unsigned int *row = source + y * SCREEN_WIDTH;
+        const unsigned int *up = y > 0 ? row - SCREEN_WIDTH : row;
+        const unsigned int *down = y < SCREEN_HEIGHT - 1 ? row + SCREEN_WIDTH : row;
+        unsigned int *out = destination + y * 3 * pitch;
+
+        scale3xPixels(source, destination, pitch, y, 0, 1);
+
+        for (x = 1; x + 5 <= SCREEN_WIDTH; x += 4)
+        {
+            __m128i A = _mm_loadu_si128((const __m128i *)(up + x - 1));
+            __m128i B = _mm_loadu_si128((const __m128i *)(up + x));
+            __m128i C = _mm_loadu_si128((const __m128i *)(up + x + 1));
+            __m128i D = _mm_loadu_si128((const __m128i *)(row + x - 1));
+            __m128i E = _mm_loadu_si128((const __m128i *)(row + x));
+            __m128i F = _mm_loadu_si128((const __m128i *)(row + x + 1));
+            __m128i G = _mm_loadu_si128((const __m128i *)(down + x - 1));
+            __m128i H = _mm_loadu_si128((const __m128i *)(down + x));
+            __m128i I = _mm_loadu_si128((const __m128i *)(down + x + 1));
+
+            __m128i edge = _mm_andnot_si128(_mm_or_si128(_mm_cmpeq_epi32(B, H), _mm_cmpeq_epi32(D, F)), ones);
+            __m128i DB = _mm_and_si128(edge, _mm_cmpeq_epi32(D, B));
+            __m128i BF = _mm_and_si128(edge, _mm_cmpeq_epi32(B, F));
+            __m128i DH = _mm_and_si128(edge, _mm_cmpeq_epi32(D, H));
+            __m128i HF = _mm_and_si128(edge, _mm_cmpeq_epi32(H, F));
+
+            // "E != X" as a mask is "not (E == X)"
+            __m128i e1 = SELECT128(_mm_or_si128(_mm_andnot_si128(_mm_cmpeq_epi32(E, C), DB), _mm_andnot_si128(_mm_cmpeq_epi32(E, A), BF)), B, E);
+            __m128i e3 = SELECT128(_mm_or_si128(_mm_andnot_si128(_mm_cmpeq_epi32(E, G), DB), _mm_andnot_si128(_mm_cmpeq_epi32(E, A), DH)), D, E);
+            __m128i e5 = SELECT128(_mm_or_si128(_mm_andnot_si128(_mm_cmpeq_epi32(E, I), BF), _mm_andnot_si128(_mm_cmpeq_epi32(E, C), HF)), F, E);
+            __m128i e7 = SELECT128(_mm_or_si128(_mm_andnot_si128(_mm_cmpeq_epi32(E, I), DH), _mm_andnot_si128(_mm_cmpeq_epi32(E, G), HF)), H, E);
+
+            interleave3(out + x * 3, SELECT128(DB, D, E), e1, SELECT128(BF, F, E));
+            interleave3(out + pitch + x * 3, e3, E, e5);
+            interleave3(out + pitch * 2 + x * 3, SELECT128(DH, D, E), e7, SELECT128(HF, F, E));
+        }
+
+        scale3xPixels(source, destination, pitch, y, x, SCREEN_WIDTH);
+    }
+}
+
+TARGET_SSE2 static void lcdSSE2(struct scaler *scaler, const unsigned int *source, unsigned int *destination, int pitch)
+{
+    const __m128i zero = _mm_setzero_si128();
+    const __m128i alpha = _mm_set1_epi32((int)ALPHA);
+    int x, y;
+
+    for (y = 0; y < SCREEN_HEIGHT; y++)
+    {
+        unsigned int *previous = scaler->previous + y * SCREEN_WIDTH;
+        unsigned int *out = destination + y * LCD_FACTOR * pitch;
+
+        for (x = 0; x < SCREEN_WIDTH; x += 4)
+        {
+            __m128i pixel = _mm_avg_epu8(_mm_loadu_si128((const __m128i *)(previous + x)), _mm_loadu_si128((const __m128i *)(source + y * SCREEN_WIDTH + x)));
+            __m128i dark = _mm_or_si128(_mm_avg_epu8(pixel, _mm_avg_epu8(pixel, zero)), alpha);
+
+            _mm_storeu_si128((__m128i *)(previous + x), pixel);
+            interleave3(out + x * 3, pixel, pixel, dark);
+            interleave3(out + pitch + x * 3, pixel, pixel, dark);
+            interleave3(out + pitch * 2 + x * 3, dark, dark, dark);
+        }
+    }
+}
+
+/*===========================================
+    AVX2
+============================================*/
+
+// Output pixel n of 8 source pixels tripled comes from source pixel n / 3
+#define TRIPLE_INDEXES(n) _mm256_setr_epi32((n) / 3, ((n) + 1) / 3, ((n) + 2) / 3, ((n) + 3) / 3, ((n) + 4) / 3, ((n) + 5) / 3, ((n) + 6) / 3, ((n) + 7) / 3)
+
+TARGET_AVX2 static void nearestAVX2(struct scaler *scaler, const unsigned int *source, unsigned int *destination, int pitch)
+{
+    const __m256i double0 = _mm256_setr_epi32(0, 0, 1, 1, 2, 2, 3, 3);
+    const __m256i double1 = _mm256_setr_epi32(4, 4, 5, 5, 6, 6, 7, 7);
+    const __m256i triple0 = TRIPLE_INDEXES(0);
+    const __m256i triple1 = TRIPLE_INDEXES(8);
+    const __m256i triple2 = TRIPLE_INDEXES(16);
+    int factor = scaler->factor;
+    int x, y;
+
+    if (factor != 2 && factor != 3)
+    {
+        nearestC(scaler, source, destination, pitch);
+        return;
+    }
+
+    for (y = 0; y < SCREEN_HEIGHT; y++)
+    {
+        unsigned int *out = destination + y * factor * pitch;
+
+        for (x = 0; x < SCREEN_WIDTH; x += 8)
+        {
+            __m256i p = _mm256_loadu_si256((const __m256i *)(source + y * SCREEN_WIDTH + x));
+
+            if (factor == 2)
+            {
+                _mm256_storeu_si256((__m256i *)(out + x * 2), _mm256_permutevar8x32_epi32(p, double0));
+                _mm256_storeu_si256((__m256i *)(out + x * 2 + 8), _mm256_permutevar8x32_epi32(p, double1));
+            }
+            else
+            {
+                _mm256_storeu_si256((__m256i *)(out + x * 3), _mm256_permutevar8x32_epi32(p, triple0));
+                _mm256_storeu_si256((__m256i *)(out + x * 3 + 8), _mm256_permutevar8x32_epi32(p, triple1));
+                _mm256_storeu_si256((__m256i *)(out + x * 3 + 16), _mm256_permutevar8x32_epi32(p, triple2));
+            }
+        }
+
+        copyRows(out, pitch, factor - 1, SCREEN_WIDTH * factor);
+    }
+}
+
+TARGET_AVX2 static void lcdAVX2(struct scaler *scaler, const unsigned int *source, unsigned int *destination, int pitch)
+{
+    const __m256i zero = _mm256_setzero_si256();
+    const __m256i alpha = _mm256_set1_epi32((int)ALPHA);
+    const __m256i triple0 = TRIPLE_INDEXES(0);
+    const __m256i triple1 = TRIPLE_INDEXES(8);
+    const __m256i triple2 = TRIPLE_INDEXES(16);
+    int x, y;
+
+    for (y = 0; y < SCREEN_HEIGHT; y++)
+    {
+        unsigned int *previous = scaler->previous + y * SCREEN_WIDTH;
+        unsigned int *out = destination + y * LCD_FACTOR * pitch;
+
+        for (x = 0; x < SCREEN_WIDTH; x += 8)
+        {
+            __m256i pixel = _mm256_avg_epu8(_mm256_loadu_si256((const __m256i *)(previous + x)), _mm256_loadu_si256((const __m256i *)(source + y * SCREEN_WIDTH + x)));
+            __m256i dark = _mm256_or_si256(_mm256_avg_epu8(pixel, _mm256_avg_epu8(pixel, zero)), alpha);
+            __m256i dark0 = _mm256_permutevar8x32_epi32(dark, triple0);
+            __m256i dark1 = _mm256_permutevar8x32_epi32(dark, triple1);
+            __m256i dark2 = _mm256_permutevar8x32_epi32(dark, triple2);
+
+            // Every third output pixel (the grid column) is dark
+            __m256i row0 = _mm256_blend_epi32(_mm256_permutevar8x32_epi32(pixel, triple0), dark0, 0x24);
+            __m256i row1 = _mm256_blend_epi32(_mm256_permutevar8x32_epi32(pixel, triple1), dark1, 0x49);
+            __m256i row2 = _mm256_blend_epi32(_mm256_permutevar8x32_epi32(pixel, triple2), dark2, 0x92);
+
+            _mm256_storeu_si256((__m256i *)(previous + x), pixel);
+            _mm256_storeu_si256((__m256i *)(out + x * 3), row0);
+            _mm256_storeu_si256((__m256i *)(out + x * 3 + 8), row1);
+            _mm256_storeu_si256((__m256i *)(out + x * 3 + 16), row2);
+            _mm256_storeu_si256((__m256i *)(out + pitch + x * 3), row0);
+            _mm256_storeu_si256((__m256i *)(out + pitch + x * 3 + 8), row1);
+            _mm256_storeu_si256((__m256i *)(out + pitch + x * 3 + 16), row2);
+            _mm256_storeu_si256((__m256i *)(out + pitch * 2 + x * 3), dark0);
+            _mm256_storeu_si256((__m256i *)(out + pitch * 2 + x * 3 + 8), dark1);
+            _mm256_storeu_si256((__m256i *)(out + pitch * 2 + x * 3 + 16), dark2);
+        }
+    }
+}
+
+#endif
+
+/*
+    initScaler
+    ---
+    Pick the fastest version of a scaler this CPU can run. Returns 0 if out of memory.
+*/
+int initScaler(struct scaler *scaler, enum scalerMode mode)
+{
+    static void (*const kernels[][3])(struct scaler *, const unsigned int *, unsigned int *, int) = {
+        // C, SSE2, AVX2
+        [SCALER_NONE] = {NULL, NULL, NULL},
+#ifdef SCALER_SIMD
+        [SCALER_NEAREST] = {nearestC, nearestSSE2, nearestAVX2},
+        [SCALER_SCALE2X] = {scale2xC, scale2xSSE2, scale2xSSE2},
+        [SCALER_SCALE3X] = {scale3xC, scale3xSSE2, scale3xSSE2},
+        [SCALER_LCD] = {lcdC, lcdSSE2, lcdAVX2},
+#else
+        [SCALER_NEAREST] = {nearestC, nearestC, nearestC},
+        [SCALER_SCALE2X] = {scale2xC, scale2xC, scale2xC},
+        [SCALER_SCALE3X] = {scale3xC, scale3xC, scale3xC},
+        [SCALER_LCD] = {lcdC, lcdC, lcdC},
+#endif
+    };
+    static const int factors[] = {[SCALER_NONE] = 1, [SCALER_NEAREST] = SCALING_FACTOR, [SCALER_SCALE2X] = 2, [SCALER_SCALE3X] = 3, [SCALER_LCD] = LCD_FACTOR};
+    static const char *kernelNames[] = {"C", "SSE2", "AVX2"};
+    int level = 0;
+
+    memset(scaler, 0, sizeof(*scaler));
+    scaler->mode = mode;
+    scaler->factor = factors[mode];
+    scaler->name = scalerNames[mode];
+
+#ifdef SCALER_SIMD
+    if (SDL_HasAVX2())
+        level = 2;
+    else if (SDL_HasSSE2())
+        level = 1;
+#endif
+    // Scale2x/3x are held up by the unaligned stores more than the maths, AVX2 was no faster
+    if ((mode == SCALER_SCALE2X || mode == SCALER_SCALE3X) && level == 2)
+        level = 1;
+
+    scaler->scale = kernels[mode][level];
+    scaler->kernel = kernelNames[level];
+
+    if (mode == SCALER_LCD)
+    {
+        scaler->previous = malloc(SCREEN_WIDTH * SCREEN_HEIGHT * sizeof(scaler->previous[0]));
+        if (scaler->previous == NULL)
+            return 0;
+        memset(scaler->previous, 0xFF, SCREEN_WIDTH * SCREEN_HEIGHT * sizeof(scaler->previous[0])); // Start from a white screen
+    }
+
+    return 1;
+}
+
+/*
+    scaleFrame
+    ---
+    Scale a SCREEN_WIDTH x SCREEN_HEIGHT frame into 'destination', which has room for 'factor' times
+    that and rows 'pitch' pixels apart.
+*/
+void scaleFrame(struct scaler *scaler, const unsigned int *source, unsigned int *destination, int pitch)
+{
+    int y;
+
+    if (scaler->scale != NULL)
+    {
+        scaler->scale(scaler, source, destination, pitch);
+        return;
+    }
+
+    for (y = 0; y < SCREEN_HEIGHT; y++)
+        memcpy(destination + y * pitch, source + y * SCREEN_WIDTH, SCREEN_WIDTH * sizeof(source[0]));
+}
+
+void freeScaler(struct scaler *scaler)
+{
+    free(scaler->previous);
+    scaler->previous = NULL;
+}
@@ -0,0 +1,80 @@
+/*
+    NAME: TMC
+    INIT DATE: 19/10/2026
+    LAST EDIT DATE: 19/10/2026
+    DESC:
+        The serial port. See 'include/serial.h'.
+*/
+
+#include "../include/serial.h"
+#include "../include/cpu.h"
+#include "../include/interupts.h"
+#include "../include/link.h"
+
+struct serialPort serialPort;
+
+char serialCapture[SERIAL_CAPTURE_SIZE + 1];
+unsigned int serialCaptureLength;
+
+void serialReset(void)
+{
+    serialPort.data = 0x00;
+    serialPort.control = 0x00;
+    serialPort.transferring = 0;
+    serialPort.endTicks = 0;
+
+    serialCaptureLength = 0;
+    serialCapture[0] = '\0';
+}
+
+unsigned char serialRead(unsigned short address)
+{
+    if (address == 0xFF01)
+        return serialPort.data;
+
+    return serialPort.control | 0x7E; // Unused bits read as 1
+}
+
+void serialWrite(unsigned short address, unsigned char value)
+{
+    if (address == 0xFF01)
+    {
+        serialPort.data = value;
+        return;
+    }
+
+    serialPort.control = value;
+    serialPort.transferring = 0;
+
+    if ((value & (SERIAL_CONTROL_START | SERIAL_CONTROL_INTERNAL)) == (SERIAL_CONTROL_START | SERIAL_CONTROL_INTERNAL))
+    {
+        serialPort.transferring = 1;
+        serialPort.endTicks = ticks + SERIAL_TRANSFER_TICKS;
+
+        if (serialCaptureLength < SERIAL_CAPTURE_SIZE)
+        {
+            serialCapture[serialCaptureLength++] = (char)serialPort.data;
+            serialCapture[serialCaptureLength] = '\0';
+        }
+    }
+}
+
+/*
+    stepSerial
+    ---
+    Finish the transfer in progress once enough ticks have passed. Only called while one is in
+    progress. With a link cable the other end finishes it instead (linkSync).
+*/
+void stepSerial(void)
+{
+    if (linkCable.connected)
+        return;
+
+    if ((long)(ticks - serialPort.endTicks) < 0)
+        return;
+
+    serialPort.data = 0xFF; // Nothing on the other end, so the line stays high
+    serialPort.control &= ~SERIAL_CONTROL_START;
+    serialPort.transferring = 0;
+    interrupt.flags |= INTERRUPTS_SERIAL;
+}
@@ -0,0 +1,87 @@
+/*
+    NAME: TMC
+    INIT DATE: 19/10/2026
+    LAST EDIT DATE: 19/10/2026
+    DESC:
+        In-memory save states. See 'include/state.h'.
+*/
+
+#include "../include/state.h"
+#include "../include/cpu.h"
+#include "../include/memory.h"
+#include "../include/palette.h"
+#include <string.h>
+
+void saveState(struct savestate *state)
+{
+    state->registers = registers;
+    state->interrupt = interrupt;
+    state->gpu = gpu;
+    state->apu = apu;
+    state->blip = blip;
+    state->keys = keys;
+    memcpy(state->joypadTable, joypadTable, sizeof(joypadTable));
+
+    state->ticks = ticks;
+    state->stopped = stopped;
+    state->romBank = romBank;
+    state->serialPort = serialPort;
+    state->cgb = cgb;
+    state->ppu = ppu;
+    state->ppuAuto = ppuAuto;
+    state->serialCaptureLength = serialCaptureLength;
+
+    memcpy(state->sram, sram, sizeof(sram));
+    memcpy(state->io, io, sizeof(io));
+    memcpy(state->vram, vram, sizeof(vram));
+    memcpy(state->oam, oam, sizeof(oam));
+    memcpy(state->wram, wram, sizeof(wram));
+    memcpy(state->hram, hram, sizeof(hram));
+    memcpy(state->tiles, tiles, sizeof(tiles));
+    memcpy(state->packedTiles, packedTiles, sizeof(packedTiles));
+    memcpy(state->tileStamps, tileStamps, sizeof(tileStamps));
+}
+
+/*
+    loadState
+    ---
+    Put the machine back exactly as it was when 'state' was saved. Host-side settings that live in the
+    same structs (like apu.mute) are left alone.
+*/
+void loadState(const struct savestate *state)
+{
+    unsigned char mute = apu.mute;
+
+    registers = state->registers;
+    interrupt = state->interrupt;
+    gpu = state->gpu;
+    apu = state->apu;
+    apu.mute = mute;
+    blip = state->blip;
+    keys = state->keys;
+    memcpy(joypadTable, state->joypadTable, sizeof(joypadTable));
+
+    ticks = state->ticks;
+    stopped = state->stopped;
+    romBank = state->romBank;
+    serialPort = state->serialPort;
+    cgb = state->cgb;
+    mapCgbBanks();
+    ppu = state->ppu;
+    ppuAuto = state->ppuAuto;
+    serialCaptureLength = state->serialCaptureLength;
+    serialCapture[serialCaptureLength] = '\0';
+
+    memcpy(sram, state->sram, sizeof(sram));
+    memcpy(io, state->io, sizeof(io));
+    memcpy(vram, state->vram, sizeof(vram));
+    memcpy(oam, state->oam, sizeof(oam));
+    memcpy(wram, state->wram, sizeof(wram));
+    memcpy(hram, state->hram, sizeof(hram));
+    memcpy(tiles, state->tiles, sizeof(tiles));
+    memcpy(packedTiles, state->packedTiles, sizeof(packedTiles));
+    memcpy(tileStamps, state->tileStamps, sizeof(tileStamps)); // The background cache checks these
+
+    // The palette tables follow BGP/OBP0/OBP1, which have just come back in 'gpu', and the CGB palette RAM
+    rebuildPalettes();
+}
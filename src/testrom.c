@@ -0,0 +1,120 @@
+/*
+    NAME: TMC
+    INIT DATE: 19/10/2026
+    LAST EDIT DATE: 19/10/2026
+    DESC:
+        Test ROM mode. See 'include/testrom.h'.
+*/
+
+#include "../include/testrom.h"
+#include "../include/serial.h"
+#include "../include/registers.h"
+#include "../include/machine.h"
+#include <stdio.h>
+#include <string.h>
+
+struct testRom testRom;
+
+static const char *resultNames[] = {"RUNNING", "PASSED", "FAILED", "TIMEOUT", "ERROR"};
+
+int startTestRom(const char *resultName)
+{
+    // Make sure the result file can be written before spending any time running the ROM
+    FILE *f = fopen(resultName, "w");
+    if (f == NULL)
+    {
+        printf("Failed to open test result file \"%s\".\n", resultName);
+        return 0;
+    }
+    fclose(f);
+
+    testRom.enabled = 1;
+    testRom.result = TEST_RUNNING;
+    testRom.resultName = resultName;
+    testRom.checkedLength = 0;
+    return 1;
+}
+
+static void setResult(enum testResult result)
+{
+    testRom.result = result;
+    atomic_store(&emulationRunning, 0);
+}
+
+/*
+    testRomEndFrame
+    ---
+    Look for a result in anything new the serial port has sent, and stop once the cycle budget is
+    used up. Called once a frame.
+*/
+void testRomEndFrame(void)
+{
+    // Search from a little before the new output, in case a word was split across frames
+    const char *start;
+
+    if (serialCaptureLength != testRom.checkedLength)
+    {
+        start = serialCapture + (testRom.checkedLength > 8 ? testRom.checkedLength - 8 : 0);
+        testRom.checkedLength = serialCaptureLength;
+
+        if (strstr(start, "Passed"))
+        {
+            setResult(TEST_PASSED);
+            return;
+        }
+
+        if (strstr(start, "Failed"))
+        {
+            setResult(TEST_FAILED);
+            return;
+        }
+    }
+
+    if (cycleLimit && elapsedTicks >= cycleLimit)
+        setResult(TEST_TIMEOUT);
+}
+
+/*
+    testRomBreakpoint
+    ---
+    'LD B, B' was run. Mooneye's test ROMs do this when they finish, with the result in the registers.
+*/
+void testRomBreakpoint(void)
+{
+    if (registers.b == 3 && registers.c == 5 && registers.d == 8 && registers.e == 13 && registers.h == 21 && registers.l == 34)
+        setResult(TEST_PASSED);
+    else if (registers.b == 0x42 && registers.c == 0x42 && registers.d == 0x42 && registers.e == 0x42 && registers.h == 0x42 && registers.l == 0x42)
+        setResult(TEST_FAILED);
+}
+
+/*
+    finishTestRom
+    ---
+    Write the result file. Called on the way out of the emulator, however it is leaving. Returns 0 if
+    a test ROM ran and didn't pass, 1 otherwise.
+*/
+int finishTestRom(void)
+{
+    FILE *f;
+
+    if (!testRom.enabled)
+        return 1;
+
+    if (testRom.result == TEST_RUNNING)
+        testRom.result = TEST_ERROR;
+
+    testRom.enabled = 0;
+
+    f = fopen(testRom.resultName, "w");
+    if (f == NULL)
+        return testRom.result == TEST_PASSED;
+
+    fprintf(f, "%s\n", resultNames[testRom.result]);
+    fprintf(f, "cycles: %llu\n", elapsedTicks);
+    fprintf(f, "registers: A:%02X F:%02X B:%02X C:%02X D:%02X E:%02X H:%02X L:%02X SP:%04X PC:%04X\n",
+            registers.a, registers.f, registers.b, registers.c, registers.d, registers.e, registers.h, registers.l, registers.sp, registers.pc);
+    fprintf(f, "serial:\n%s\n", serialCapture);
+    fclose(f);
+
+    return testRom.result == TEST_PASSED;
+}
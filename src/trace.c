@@ -0,0 +1,99 @@
+/*
+    NAME: TMC
+    INIT DATE: 19/10/2026
+    LAST EDIT DATE: 19/10/2026
+    DESC:
+        Binary instruction trace recorder. See 'include/trace.h'.
+*/
+
+#include "../include/trace.h"
+#include "../include/registers.h"
+#include "../include/memory.h"
+#include "../include/cpu.h"
+#include "../include/gpu.h"
+#include <stdio.h>
+#include <string.h>
+
+#define TRACE_BUFFER_RECORDS 65536 // 1.5MB, written out in one go
+
+unsigned char traceEnabled;
+
+static FILE *traceFile;
+static struct traceRecord traceBuffer[TRACE_BUFFER_RECORDS];
+static unsigned int traceCount;
+
+/*
+    startTrace
+    ---
+    Start writing a trace to 'fileName'. To pipe the trace straight into another program, give it the
+    path of a named pipe (FIFO); stdout can't be used as it is full of debug output. Returns 1 on success.
+*/
+int startTrace(const char *fileName)
+{
+    struct traceHeader header;
+
+    traceFile = fopen(fileName, "wb");
+    if (traceFile == NULL)
+    {
+        printf("Failed to open trace file \"%s\".\n", fileName);
+        return 0;
+    }
+
+    memcpy(header.magic, TRACE_MAGIC, sizeof(header.magic));
+    header.version = TRACE_VERSION;
+    header.recordSize = sizeof(struct traceRecord);
+    fwrite(&header, sizeof(header), 1, traceFile);
+
+    traceCount = 0;
+    traceEnabled = 1;
+    return 1;
+}
+
+static void flushTrace(void)
+{
+    fwrite(traceBuffer, sizeof(struct traceRecord), traceCount, traceFile);
+    traceCount = 0;
+}
+
+/*
+    traceInstruction
+    ---
+    Record the machine as it is just before the instruction at registers.pc runs. Only called while
+    traceEnabled is set.
+*/
+void traceInstruction(void)
+{
+    struct traceRecord *record = &traceBuffer[traceCount];
+
+    record->a = registers.a;
+    record->f = registers.f;
+    record->b = registers.b;
+    record->c = registers.c;
+    record->d = registers.d;
+    record->e = registers.e;
+    record->h = registers.h;
+    record->l = registers.l;
+    record->sp = registers.sp;
+    record->pc = registers.pc;
+    record->pcmem[0] = peekByte(registers.pc);
+    record->pcmem[1] = peekByte(registers.pc + 1);
+    record->pcmem[2] = peekByte(registers.pc + 2);
+    record->pcmem[3] = peekByte(registers.pc + 3);
+    record->ticks = (unsigned int)ticks;
+    record->ly = gpu.scanline;
+    record->padding[0] = record->padding[1] = record->padding[2] = 0;
+
+    if (++traceCount == TRACE_BUFFER_RECORDS)
+        flushTrace();
+}
+
+void stopTrace(void)
+{
+    if (!traceEnabled)
+        return;
+
+    flushTrace();
+    fclose(traceFile);
+
+    traceEnabled = 0;
+}
@@ -0,0 +1,38 @@
+/*
+    NAME: TMC
+    INIT DATE: 19/10/2026
+    LAST EDIT DATE: 19/10/2026
+    DESC:
+        Lock-free triple buffer. See 'include/triplebuffer.h'.
+*/
+
+#include "../include/triplebuffer.h"
+
+/*
+    triplebufferPublish
+    ---
+    Producer side. The back buffer is finished: swap it into the middle (marked as new) and take
+    whatever was there as the new back buffer, which is returned.
+*/
+void *triplebufferPublish(struct triplebuffer *triple)
+{
+    triple->back = atomic_exchange_explicit(&triple->middle, triple->back | TRIPLEBUFFER_NEW, memory_order_acq_rel) & 3;
+
+    return triple->buffers[triple->back];
+}
+
+/*
+    triplebufferAcquire
+    ---
+    Consumer side. If a new frame has been published, swap it to the front and return 1. Otherwise the
+    front buffer is left alone and 0 is returned.
+*/
+int triplebufferAcquire(struct triplebuffer *triple)
+{
+    if (!(atomic_load_explicit(&triple->middle, memory_order_relaxed) & TRIPLEBUFFER_NEW))
+        return 0;
+
+    triple->front = atomic_exchange_explicit(&triple->middle, triple->front, memory_order_acq_rel) & 3;
+
+    return 1;
+}
@@ -0,0 +1,111 @@
+/*
+    NAME: TMC
+    INIT DATE: 19/10/2026
+    LAST EDIT DATE: 19/10/2026
+    DESC:
+        XXH64 (https://github.com/Cyan4973/xxHash). Used for frame hashes (framehash.c) and to identify
+        ROM files (tools/romindex.c), so it depends on nothing else.
+*/
+
+#include "../include/xxhash.h"
+#include <string.h>
+
+#define PRIME64_1 0x9E3779B185EBCA87ULL
+#define PRIME64_2 0xC2B2AE3D27D4EB4FULL
+#define PRIME64_3 0x165667B19E3779F9ULL
+#define PRIME64_4 0x85EBCA77C2B2AE63ULL
+#define PRIME64_5 0x27D4EB2F165667C5ULL
+
+#define ROTL64(x, r) (((x) << (r)) | ((x) >> (64 - (r))))
+
+static unsigned long long read64(const unsigned char *p)
+{
+    unsigned long long value;
+    memcpy(&value, p, sizeof(value)); // Little endian host, as everywhere else
+    return value;
+}
+
+static unsigned int read32(const unsigned char *p)
+{
+    unsigned int value;
+    memcpy(&value, p, sizeof(value));
+    return value;
+}
+
+static unsigned long long xxh64Round(unsigned long long accumulator, unsigned long long input)
+{
+    accumulator += input * PRIME64_2;
+    accumulator = ROTL64(accumulator, 31);
+    return accumulator * PRIME64_1;
+}
+
+static unsigned long long xxh64Merge(unsigned long long hash, unsigned long long accumulator)
+{
+    hash ^= xxh64Round(0, accumulator);
+    return hash * PRIME64_1 + PRIME64_4;
+}
+
+/*
+    xxh64
+    ---
+    XXH64 of 'length' bytes. Four independent accumulators eat 32 bytes per round, so the loop isn't
+    held up waiting on one long chain of multiplies.
+*/
+unsigned long long xxh64(const void *data, size_t length, unsigned long long seed)
+{
+    const unsigned char *p = data;
+    const unsigned char *end = p + length;
+    unsigned long long hash;
+
+    if (length >= 32)
+    {
+        unsigned long long v1 = seed + PRIME64_1 + PRIME64_2;
+        unsigned long long v2 = seed + PRIME64_2;
+        unsigned long long v3 = seed;
+        unsigned long long v4 = seed - PRIME64_1;
+
+        do
+        {
+            v1 = xxh64Round(v1, read64(p));
+            v2 = xxh64Round(v2, read64(p + 8));
+            v3 = xxh64Round(v3, read64(p + 16));
+            v4 = xxh64Round(v4, read64(p + 24));
+            p += 32;
+        } while (end - p >= 32);
+
+        hash = ROTL64(v1, 1) + ROTL64(v2, 7) + ROTL64(v3, 12) + ROTL64(v4, 18);
+        hash = xxh64Merge(hash, v1);
+        hash = xxh64Merge(hash, v2);
+        hash = xxh64Merge(hash, v3);
+        hash = xxh64Merge(hash, v4);
+    }
+    else
+        hash = seed + PRIME64_5;
+
+    hash += length;
+
+    for (; end - p >= 8; p += 8)
+    {
+        hash ^= xxh64Round(0, read64(p));
+        hash = ROTL64(hash, 27) * PRIME64_1 + PRIME64_4;
+    }
+    if (end - p >= 4)
+    {
+        hash ^= read32(p) * PRIME64_1;
+        hash = ROTL64(hash, 23) * PRIME64_2 + PRIME64_3;
+        p += 4;
+    }
+    for (; p < end; p++)
+    {
+        hash ^= *p * PRIME64_5;
+        hash = ROTL64(hash, 11) * PRIME64_1;
+    }
+
+    // Avalanche
+    hash ^= hash >> 33;
+    hash *= PRIME64_2;
+    hash ^= hash >> 29;
+    hash *= PRIME64_3;
+    hash ^= hash >> 32;
+    return hash;
+}
@@ -0,0 +1,300 @@
+; Sprite test: draws a fixed set of sprites that covers each rule renderSprites (gpu.c) follows, and
+; is checked against the frame hashes in tests/sprites.golden.
+;
+;   emu_out --headless --nosound --nopace --ppu fast --golden tests\sprites.golden tests\sprites.gb
+;
+; Frames 1 - 5 (8x8 sprites, background on):
+;   lines 16 - 23   one tile, plain / X flip / Y flip / X & Y flip (OBP1), from x 88
+;   lines 32 - 39   the priority flag: hidden over background colour 1 (x 16), shown over colour 0 (x 96)
+;   lines 48 - 55   two sprites overlapping: the one with the smaller X wins, though it's later in OAM
+;   lines 64 - 71   12 sprites on the line: only the first 10 in OAM are drawn
+; From frame 6 on, the background is switched off (LCDC bit 0) and sprites are 8x16. Everything is
+; drawn over shade 0, so both priority sprites show, and Y flip swaps the two tiles of a pair.
+;
+; The background is tile 1 (colour 1, light grey) in the top left 80 x 72 pixels, colour 0 (white)
+; elsewhere. OBP0 gives sprite colours 1 - 3 black, dark & dark, OBP1 black, light & light, so every
+; sprite pixel stands out from both.
+
+    .title "TEST SPRITES"
+
+    .org 0x150
+start:
+    di
+    ld sp, 0xFFFE
+    xor a
+    ldh (0x40), a       ; LCD off while VRAM & OAM are set up
+
+    ; Tile 1: colour 1
+    ld hl, 0x801F
+    ld b, 8
+tile1:
+    xor a
+    ldd (hl), a
+    ld a, 0xFF
+    ldd (hl), a
+    dec b
+    jr nz, tile1
+
+    ; Tile 2: colour 1 along the top & left, colour 2 along the bottom (3 bottom left). Written from
+    ; the last byte back, high byte of each row first.
+    ld hl, 0x802F
+    ld a, 0xFF
+    ldd (hl), a
+    ld a, 0x80
+    ldd (hl), a
+    ld b, 6
+tile2:
+    xor a
+    ldd (hl), a
+    ld a, 0x80
+    ldd (hl), a
+    dec b
+    jr nz, tile2
+    xor a
+    ldd (hl), a
+    ld a, 0xFF
+    ldd (hl), a
+
+    ; Tile 3: colour 3
+    ld hl, 0x803F
+    ld b, 16
+    ld a, 0xFF
+tile3:
+    ldd (hl), a
+    dec b
+    jr nz, tile3
+
+    ; Background: tile 1 in columns 0 - 9 of rows 0 - 8
+    ld hl, 0x9809
+    call fillrow
+    ld hl, 0x9829
+    call fillrow
+    ld hl, 0x9849
+    call fillrow
+    ld hl, 0x9869
+    call fillrow
+    ld hl, 0x9889
+    call fillrow
+    ld hl, 0x98A9
+    call fillrow
+    ld hl, 0x98C9
+    call fillrow
+    ld hl, 0x98E9
+    call fillrow
+    ld hl, 0x9909
+    call fillrow
+
+    ; OAM, written from the last byte of the last sprite back: flags, tile, X, Y
+    ld hl, 0xFE4F
+
+    ; Sprites 19 - 8: 12 on lines 64 - 71, X = 8 + 12 * n. 18 & 19 are over the limit.
+    xor a
+    ldd (hl), a
+    ld a, 2
+    ldd (hl), a
+    ld a, 140
+    ldd (hl), a
+    ld a, 80
+    ldd (hl), a
+    xor a
+    ldd (hl), a
+    ld a, 2
+    ldd (hl), a
+    ld a, 128
+    ldd (hl), a
+    ld a, 80
+    ldd (hl), a
+    xor a
+    ldd (hl), a
+    ld a, 2
+    ldd (hl), a
+    ld a, 116
+    ldd (hl), a
+    ld a, 80
+    ldd (hl), a
+    xor a
+    ldd (hl), a
+    ld a, 2
+    ldd (hl), a
+    ld a, 104
+    ldd (hl), a
+    ld a, 80
+    ldd (hl), a
+    xor a
+    ldd (hl), a
+    ld a, 2
+    ldd (hl), a
+    ld a, 92
+    ldd (hl), a
+    ld a, 80
+    ldd (hl), a
+    xor a
+    ldd (hl), a
+    ld a, 2
+    ldd (hl), a
+    ld a, 80
+    ldd (hl), a
+    ld a, 80
+    ldd (hl), a
+    xor a
+    ldd (hl), a
+    ld a, 2
+    ldd (hl), a
+    ld a, 68
+    ldd (hl), a
+    ld a, 80
+    ldd (hl), a
+    xor a
+    ldd (hl), a
+    ld a, 2
+    ldd (hl), a
+    ld a, 56
+    ldd (hl), a
+    ld a, 80
+    ldd (hl), a
+    xor a
+    ldd (hl), a
+    ld a, 2
+    ldd (hl), a
+    ld a, 44
+    ldd (hl), a
+    ld a, 80
+    ldd (hl), a
+    xor a
+    ldd (hl), a
+    ld a, 2
+    ldd (hl), a
+    ld a, 32
+    ldd (hl), a
+    ld a, 80
+    ldd (hl), a
+    xor a
+    ldd (hl), a
+    ld a, 2
+    ldd (hl), a
+    ld a, 20
+    ldd (hl), a
+    ld a, 80
+    ldd (hl), a
+    xor a
+    ldd (hl), a
+    ld a, 2
+    ldd (hl), a
+    ld a, 8
+    ldd (hl), a
+    ld a, 80
+    ldd (hl), a
+
+    ; Sprite 7: tile 2, X 100, OBP1. Sprite 6: tile 3, X 104. 7 wins where they overlap.
+    ld a, 0x10
+    ldd (hl), a
+    ld a, 2
+    ldd (hl), a
+    ld a, 100
+    ldd (hl), a
+    ld a, 64
+    ldd (hl), a
+    xor a
+    ldd (hl), a
+    ld a, 3
+    ldd (hl), a
+    ld a, 104
+    ldd (hl), a
+    ld a, 64
+    ldd (hl), a
+
+    ; Sprite 5: priority, over colour 0. Sprite 4: priority, over colour 1.
+    ld a, 0x80
+    ldd (hl), a
+    ld a, 2
+    ldd (hl), a
+    ld a, 104
+    ldd (hl), a
+    ld a, 48
+    ldd (hl), a
+    ld a, 0x80
+    ldd (hl), a
+    ld a, 2
+    ldd (hl), a
+    ld a, 24
+    ldd (hl), a
+    ld a, 48
+    ldd (hl), a
+
+    ; Sprites 3 - 0: X & Y flip (OBP1), Y flip, X flip, plain
+    ld a, 0x70
+    ldd (hl), a
+    ld a, 2
+    ldd (hl), a
+    ld a, 144
+    ldd (hl), a
+    ld a, 32
+    ldd (hl), a
+    ld a, 0x40
+    ldd (hl), a
+    ld a, 2
+    ldd (hl), a
+    ld a, 128
+    ldd (hl), a
+    ld a, 32
+    ldd (hl), a
+    ld a, 0x20
+    ldd (hl), a
+    ld a, 2
+    ldd (hl), a
+    ld a, 112
+    ldd (hl), a
+    ld a, 32
+    ldd (hl), a
+    xor a
+    ldd (hl), a
+    ld a, 2
+    ldd (hl), a
+    ld a, 96
+    ldd (hl), a
+    ld a, 32
+    ldd (hl), a
+
+    ld a, 0xE4
+    ldh (0x47), a
+    ld a, 0xAC
+    ldh (0x48), a
+    ld a, 0x5C
+    ldh (0x49), a
+
+    ld a, 0x93          ; LCD on, tiles at 0x8000, sprites, background
+    ldh (0x40), a
+
+    ld b, 6
+phase1:
+    call frame
+    dec b
+    jr nz, phase1
+
+    ld a, 0x96          ; LCD on, tiles at 0x8000, 8x16 sprites, no background
+    ldh (0x40), a
+
+done:
+    call frame
+    jp done
+
+; Write tile 1 to the 10 map entries ending at HL
+fillrow:
+    ld b, 10
+    ld a, 1
+fillrow_loop:
+    ldd (hl), a
+    dec b
+    jr nz, fillrow_loop
+    ret
+
+; Wait for VBLANK, then for line 0 of the next frame
+frame:
+    ldh a, (0x44)
+    cp 144
+    jr nz, frame
+frame_end:
+    ldh a, (0x44)
+    cp 0
+    jr nz, frame_end
+    ret
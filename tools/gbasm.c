@@ -0,0 +1,77 @@
+/*
+    NAME: TMC
+    INIT DATE: 19/10/2026
+    LAST EDIT DATE: 19/10/2026
+    DESC:
+        Command line front end for the assembler ('include/assembler.h'). Turns one source file into
+        a cartridge image with a valid header, ready to load in the emulator.
+
+            gbasm <source.asm> <output.gb>
+
+        The workloads in 'bench/' are built with it, see 'compile.txt'.
+
+        Build: gcc .\tools\gbasm.c .\src\assembler.c -O2 -o gbasm
+*/
+
+#include "../include/assembler.h"
+#include <stdio.h>
+#include <stdlib.h>
+
+int main(int argc, char *argv[])
+{
+    FILE *f;
+    char *source;
+    long length;
+    unsigned char *rom;
+    size_t size;
+
+    if (argc != 3)
+    {
+        printf("Usage: %s <source.asm> <output.gb>\n", argv[0]);
+        return 2;
+    }
+
+    f = fopen(argv[1], "rb");
+    if (f == NULL)
+    {
+        printf("Failed to open \"%s\".\n", argv[1]);
+        return 2;
+    }
+
+    fseek(f, 0, SEEK_END);
+    length = ftell(f);
+    rewind(f);
+
+    source = malloc(length + 1);
+    if (source == NULL || fread(source, 1, length, f) != (size_t)length)
+    {
+        printf("Failed to read \"%s\".\n", argv[1]);
+        fclose(f);
+        free(source);
+        return 2;
+    }
+    source[length] = '\0';
+    fclose(f);
+
+    if (!assemble(source, argv[1], &rom, &size))
+    {
+        free(source);
+        return 1;
+    }
+    free(source);
+
+    f = fopen(argv[2], "wb");
+    if (f == NULL || fwrite(rom, 1, size, f) != size)
+    {
+        printf("Failed to write \"%s\".\n", argv[2]);
+        if (f != NULL)
+            fclose(f);
+        free(rom);
+        return 1;
+    }
+
+    fclose(f);
+    free(rom);
+    printf("%s: %zu bytes\n", argv[2], size);
+    return 0;
+}
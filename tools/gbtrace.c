@@ -0,0 +1,277 @@
+/*
+    NAME: TMC
+    INIT DATE: 19/10/2026
+    LAST EDIT DATE: 19/10/2026
+    DESC:
+        Tool for the binary instruction traces written by 'src/trace.c' (--trace <file>).
+
+            gbtrace text <trace> [output.txt]
+                Convert a binary trace to the common text log format, one line per instruction:
+                "A:01 F:B0 B:00 C:13 D:00 E:D8 H:01 L:4D SP:FFFE PC:0100 PCMEM:00,C3,13,02"
+
+            gbtrace diff <trace or log> <trace or log>
+                Stream through two traces and report the first instruction where they differ. Either side
+                can be a binary trace or a text log in the format above (e.g. from a reference emulator).
+                Ticks & LY are only compared when both sides are binary traces.
+
+        Build: gcc .\tools\gbtrace.c -O2 -o gbtrace
+*/
+
+#include "../include/trace.h"
+#include <stddef.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define READ_BUFFER_SIZE (1 << 20)
+
+struct traceReader
+{
+    FILE *file;
+    const char *name;
+    unsigned char binary;
+    unsigned long long index; // Records read so far
+};
+
+static int openReader(struct traceReader *reader, const char *fileName)
+{
+    struct traceHeader header;
+
+    reader->file = fopen(fileName, "rb");
+    if (reader->file == NULL)
+    {
+        printf("Failed to open \"%s\".\n", fileName);
+        return 0;
+    }
+
+    setvbuf(reader->file, NULL, _IOFBF, READ_BUFFER_SIZE);
+    reader->name = fileName;
+    reader->index = 0;
+
+    // Anything without the magic is treated as a text log
+    if (fread(&header, sizeof(header), 1, reader->file) == 1 && !memcmp(header.magic, TRACE_MAGIC, sizeof(header.magic)))
+    {
+        if (header.version != TRACE_VERSION || header.recordSize != sizeof(struct traceRecord))
+        {
+            printf("\"%s\" is a trace from a different version (version %u, %u byte records).\n", fileName, header.version, header.recordSize);
+            fclose(reader->file);
+            return 0;
+        }
+
+        reader->binary = 1;
+    }
+    else
+    {
+        reader->binary = 0;
+        rewind(reader->file);
+    }
+
+    return 1;
+}
+
+/*
+    readRecord
+    ---
+    Read the next instruction from either kind of file. Text lines that aren't log lines are skipped.
+    Returns 0 at the end of the file.
+*/
+static int readRecord(struct traceReader *reader, struct traceRecord *record)
+{
+    char line[256];
+    unsigned int v[14];
+
+    if (reader->binary)
+    {
+        if (fread(record, sizeof(*record), 1, reader->file) != 1)
+            return 0;
+
+        reader->index++;
+        return 1;
+    }
+
+    while (fgets(line, sizeof(line), reader->file))
+    {
+        if (sscanf(line, "A:%x F:%x B:%x C:%x D:%x E:%x H:%x L:%x SP:%x PC:%x PCMEM:%x,%x,%x,%x",
+                   &v[0], &v[1], &v[2], &v[3], &v[4], &v[5], &v[6], &v[7], &v[8], &v[9], &v[10], &v[11], &v[12], &v[13]) != 14)
+            continue;
+
+        memset(record, 0, sizeof(*record));
+        record->a = v[0];
+        record->f = v[1];
+        record->b = v[2];
+        record->c = v[3];
+        record->d = v[4];
+        record->e = v[5];
+        record->h = v[6];
+        record->l = v[7];
+        record->sp = v[8];
+        record->pc = v[9];
+        record->pcmem[0] = v[10];
+        record->pcmem[1] = v[11];
+        record->pcmem[2] = v[12];
+        record->pcmem[3] = v[13];
+
+        reader->index++;
+        return 1;
+    }
+
+    return 0;
+}
+
+static void printRecord(FILE *output, const struct traceRecord *record)
+{
+    fprintf(output, "A:%02X F:%02X B:%02X C:%02X D:%02X E:%02X H:%02X L:%02X SP:%04X PC:%04X PCMEM:%02X,%02X,%02X,%02X\n",
+            record->a, record->f, record->b, record->c, record->d, record->e, record->h, record->l,
+            record->sp, record->pc, record->pcmem[0], record->pcmem[1], record->pcmem[2], record->pcmem[3]);
+}
+
+static int convertTrace(const char *inputName, const char *outputName)
+{
+    struct traceReader reader;
+    struct traceRecord record;
+    FILE *output = stdout;
+
+    if (!openReader(&reader, inputName))
+        return 2;
+
+    if (outputName != NULL)
+    {
+        output = fopen(outputName, "w");
+        if (output == NULL)
+        {
+            printf("Failed to open \"%s\".\n", outputName);
+            return 2;
+        }
+    }
+
+    setvbuf(output, NULL, _IOFBF, READ_BUFFER_SIZE);
+
+    while (readRecord(&reader, &record))
+        printRecord(output, &record);
+
+    fclose(reader.file);
+    if (output != stdout)
+        fclose(output);
+
+    return 0;
+}
+
+/*
+    printDifferences
+    ---
+    List every field that differs between two records.
+*/
+static void printDifferences(const struct traceRecord *first, const struct traceRecord *second, int compareTiming)
+{
+    printf("Differs in:");
+
+#define CHECK(field, name)              \
+    if (first->field != second->field)  \
+        printf(" %s", name);
+
+    CHECK(a, "A")
+    CHECK(f, "F")
+    CHECK(b, "B")
+    CHECK(c, "C")
+    CHECK(d, "D")
+    CHECK(e, "E")
+    CHECK(h, "H")
+    CHECK(l, "L")
+    CHECK(sp, "SP")
+    CHECK(pc, "PC")
+    if (memcmp(first->pcmem, second->pcmem, sizeof(first->pcmem)))
+        printf(" PCMEM");
+
+    if (compareTiming)
+    {
+        CHECK(ticks, "TICKS")
+        CHECK(ly, "LY")
+    }
+
+#undef CHECK
+
+    printf("\n");
+}
+
+static int sameRecord(const struct traceRecord *first, const struct traceRecord *second, int compareTiming)
+{
+    // Everything up to (but not including) the timing fields
+    if (memcmp(first, second, offsetof(struct traceRecord, ticks)))
+        return 0;
+
+    return !compareTiming || (first->ticks == second->ticks && first->ly == second->ly);
+}
+
+static int diffTraces(const char *firstName, const char *secondName)
+{
+    struct traceReader first;
+    struct traceReader second;
+    struct traceRecord firstRecord;
+    struct traceRecord secondRecord;
+    struct traceRecord previous = {0};
+    int compareTiming;
+    int firstMore;
+    int secondMore;
+
+    if (!openReader(&first, firstName) || !openReader(&second, secondName))
+        return 2;
+
+    compareTiming = first.binary && second.binary;
+
+    for (;;)
+    {
+        firstMore = readRecord(&first, &firstRecord);
+        secondMore = readRecord(&second, &secondRecord);
+
+        if (!firstMore || !secondMore)
+            break;
+
+        if (!sameRecord(&firstRecord, &secondRecord, compareTiming))
+        {
+            printf("First divergence at instruction %llu.\n", first.index - 1);
+            if (first.index > 1)
+            {
+                printf("Last matching:\n  ");
+                printRecord(stdout, &previous);
+            }
+
+            printf("%s:\n  ", firstName);
+            printRecord(stdout, &firstRecord);
+            if (compareTiming)
+                printf("  TICKS:%u LY:%u\n", firstRecord.ticks, firstRecord.ly);
+
+            printf("%s:\n  ", secondName);
+            printRecord(stdout, &secondRecord);
+            if (compareTiming)
+                printf("  TICKS:%u LY:%u\n", secondRecord.ticks, secondRecord.ly);
+
+            printDifferences(&firstRecord, &secondRecord, compareTiming);
+            return 1;
+        }
+
+        previous = firstRecord;
+    }
+
+    if (firstMore != secondMore)
+    {
+        printf("Traces match for %llu instructions, then \"%s\" ends.\n", (firstMore ? second.index : first.index), firstMore ? secondName : firstName);
+        return 1;
+    }
+
+    printf("Traces match (%llu instructions).\n", first.index);
+    return 0;
+}
+
+int main(int argc, char *argv[])
+{
+    if (argc >= 3 && !strcmp(argv[1], "text"))
+        return convertTrace(argv[2], argc >= 4 ? argv[3] : NULL);
+
+    if (argc >= 4 && !strcmp(argv[1], "diff"))
+        return diffTraces(argv[2], argv[3]);
+
+    printf("Usage:\n");
+    printf("  %s text <trace> [output.txt]\n", argv[0]);
+    printf("  %s diff <trace or log> <trace or log>\n", argv[0]);
+    return 2;
+}
@@ -0,0 +1,600 @@
+/*
+    NAME: TMC
+    INIT DATE: 19/10/2026
+    LAST EDIT DATE: 19/10/2026
+    DESC:
+        Indexes a ROM library for a launcher. Walks a directory tree for .gb / .gbc files and for each
+        one takes the header fields loadROM uses (title, CGB byte, type, ROM & RAM size), checks the
+        header & global checksums, and hashes the whole file with XXH64. The results are kept in an
+        index file, and a later run only opens the files that are new, or whose size or modification
+        time has changed. Every other file costs one stat, so a warm start takes milliseconds.
+
+            romindex <rom directory> [-i <index file>] [-j <jobs>] [-l]
+
+            -i  index file (default romindex.bin)
+            -j  files read at once (default: number of CPUs)
+            -l  list every ROM on stdout, one per line, tab separated:
+                <hash> <header checksum ok> <global checksum ok> <flags> <cgb> <type> <rom size> <ram size> <title> <path>
+                (the summary then goes to stderr, as do all messages, so stdout is only the list)
+                <flags> is the index's flags byte in hex (ROM_* below), so a file too small to be a ROM
+                or one that couldn't be read can be told from a bad checksum.
+
+        Files are mapped (mmap / MapViewOfFile), not read. The header fields come from the first page
+        only, and the checksum & hash read the mapping straight from the page cache, without a copy.
+
+        Index file (little endian, records sorted by path):
+
+            "GBRI", u32 version, u32 count
+            per ROM: u64 size, i64 mtime (ns), u64 hash, u8 type, u8 cgb, u8 rom size, u8 ram size,
+                     u8 flags, char title[16], u16 path length, path (no terminator)
+
+        The mtime is in nanoseconds (on Windows the file time: 100ns units since 1601), so a file
+        rewritten at the same size within the same second still counts as changed. A damaged index, or one from
+        another version, is ignored and rebuilt.
+
+        Build: gcc .\tools\romindex.c .\src\xxhash.c -O2 -o romindex -lpthread
+*/
+
+#include "../include/rom.h"
+#include "../include/xxhash.h"
+#include <dirent.h>
+#include <pthread.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/stat.h>
+#include <time.h>
+
+#ifdef _WIN32
+#include <windows.h>
+#define PATH_SEPARATOR "\\"
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <unistd.h>
+#define PATH_SEPARATOR "/"
+#endif
+
+#define INDEX_MAGIC "GBRI"
+#define INDEX_VERSION 2
+#define DEFAULT_INDEX "romindex.bin"
+#define MAX_PATH_LENGTH 1024
+#define TITLE_LENGTH 16
+
+#define RECORD_FIXED_SIZE (8 + 8 + 8 + 5 + TITLE_LENGTH + 2) // Before the path
+
+// 'flags'
+#define ROM_HEADER_OK (1 << 0)  // Header checksum (0x14D) matches
+#define ROM_GLOBAL_OK (1 << 1)  // Global checksum (0x14E) matches
+#define ROM_TOO_SMALL (1 << 2)  // Shorter than a header, nothing else filled in
+#define ROM_UNREADABLE (1 << 3) // Couldn't be read (or changed size), nothing else filled in
+
+struct romEntry
+{
+    char *path;
+    unsigned long long size;
+    long long mtime; // See modificationTime
+    unsigned long long hash;
+    unsigned char type;
+    unsigned char cgb;
+    unsigned char romSize; // Header codes (0x148 / 0x149), not bytes
+    unsigned char ramSize;
+    unsigned char flags;
+    char title[TITLE_LENGTH + 1];
+};
+
+struct romList
+{
+    struct romEntry *entries;
+    int count;
+    int capacity;
+};
+
+static struct romList library; // What's on disk now
+static struct romList indexed; // What the index file had
+
+static int *stale; // Entries of 'library' that have to be read
+static int staleCount;
+static int nextStale;
+static pthread_mutex_t lock = PTHREAD_MUTEX_INITIALIZER;
+
+static int isRom(const char *name)
+{
+    const char *extension = strrchr(name, '.');
+    return extension != NULL && (!strcmp(extension, ".gb") || !strcmp(extension, ".gbc"));
+}
+
+static int compareEntries(const void *a, const void *b)
+{
+    return strcmp(((const struct romEntry *)a)->path, ((const struct romEntry *)b)->path);
+}
+
+static int cpuCount(void)
+{
+#ifdef _WIN32
+    SYSTEM_INFO info;
+    GetSystemInfo(&info);
+    return (int)info.dwNumberOfProcessors;
+#else
+    long count = sysconf(_SC_NPROCESSORS_ONLN);
+    return count > 0 ? (int)count : 1;
+#endif
+}
+
+static double now(void)
+{
+    struct timespec time;
+    timespec_get(&time, TIME_UTC);
+    return time.tv_sec + time.tv_nsec / 1e9;
+}
+
+static struct romEntry *addEntry(struct romList *list)
+{
+    if (list->count == list->capacity)
+    {
+        list->capacity = list->capacity ? list->capacity * 2 : 256;
+        list->entries = realloc(list->entries, sizeof(struct romEntry) * list->capacity);
+        if (list->entries == NULL)
+        {
+            fprintf(stderr, "Out of memory.\n");
+            exit(2);
+        }
+    }
+
+    memset(&list->entries[list->count], 0, sizeof(struct romEntry));
+    return &list->entries[list->count++];
+}
+
+/*===========================================
+    INDEX FILE
+============================================*/
+
+// Take 'length' bytes from 'p', if there are that many left before 'end'
+static int take(const unsigned char **p, const unsigned char *end, void *out, size_t length)
+{
+    if ((size_t)(end - *p) < length)
+        return 0;
+
+    memcpy(out, *p, length);
+    *p += length;
+    return 1;
+}
+
+static void freeList(struct romList *list)
+{
+    int i;
+
+    for (i = 0; i < list->count; i++)
+        free(list->entries[i].path);
+    free(list->entries);
+    memset(list, 0, sizeof(*list));
+}
+
+/*
+    loadIndex
+    ---
+    Read the index into 'indexed'. A missing index is just an empty one.
+*/
+static void loadIndex(const char *fileName)
+{
+    FILE *f = fopen(fileName, "rb");
+    unsigned char *data;
+    const unsigned char *p, *end;
+    long length;
+    char magic[4];
+    unsigned int version, count, i;
+
+    if (f == NULL)
+        return;
+
+    fseek(f, 0, SEEK_END);
+    length = ftell(f);
+    rewind(f);
+    data = malloc(length > 0 ? length : 1);
+    if (data == NULL || fread(data, 1, length, f) != (size_t)length)
+    {
+        free(data);
+        fclose(f);
+        return;
+    }
+    fclose(f);
+
+    p = data;
+    end = data + length;
+    if (!take(&p, end, magic, 4) || memcmp(magic, INDEX_MAGIC, 4) || !take(&p, end, &version, 4) ||
+        version != INDEX_VERSION || !take(&p, end, &count, 4))
+    {
+        fprintf(stderr, "Index \"%s\" isn't one this version can read, rebuilding it.\n", fileName);
+        free(data);
+        return;
+    }
+
+    for (i = 0; i < count; i++)
+    {
+        struct romEntry *rom = addEntry(&indexed);
+        unsigned short pathLength;
+
+        if (!take(&p, end, &rom->size, 8) || !take(&p, end, &rom->mtime, 8) || !take(&p, end, &rom->hash, 8) ||
+            !take(&p, end, &rom->type, 1) || !take(&p, end, &rom->cgb, 1) || !take(&p, end, &rom->romSize, 1) ||
+            !take(&p, end, &rom->ramSize, 1) || !take(&p, end, &rom->flags, 1) || !take(&p, end, rom->title, TITLE_LENGTH) ||
+            !take(&p, end, &pathLength, 2) || (size_t)(end - p) < pathLength || (rom->path = malloc(pathLength + 1)) == NULL)
+        {
+            indexed.count--;
+            fprintf(stderr, "Index \"%s\" is damaged, rebuilding it.\n", fileName);
+            freeList(&indexed);
+            break;
+        }
+
+        take(&p, end, rom->path, pathLength);
+        rom->path[pathLength] = '\0';
+    }
+
+    free(data);
+
+    // It's written sorted, but the lookups depend on it
+    qsort(indexed.entries, indexed.count, sizeof(struct romEntry), compareEntries);
+}
+
+static int saveIndex(const char *fileName)
+{
+    FILE *f = fopen(fileName, "wb");
+    unsigned int version = INDEX_VERSION;
+    unsigned int count = (unsigned int)library.count;
+    int i;
+
+    if (f == NULL)
+    {
+        fprintf(stderr, "Failed to open \"%s\".\n", fileName);
+        return 0;
+    }
+
+    fwrite(INDEX_MAGIC, 4, 1, f);
+    fwrite(&version, 4, 1, f);
+    fwrite(&count, 4, 1, f);
+
+    for (i = 0; i < library.count; i++)
+    {
+        const struct romEntry *rom = &library.entries[i];
+        unsigned char record[RECORD_FIXED_SIZE];
+        unsigned char *p = record;
+        unsigned short pathLength = (unsigned short)strlen(rom->path);
+
+        memcpy(p, &rom->size, 8), p += 8;
+        memcpy(p, &rom->mtime, 8), p += 8;
+        memcpy(p, &rom->hash, 8), p += 8;
+        *p++ = rom->type;
+        *p++ = rom->cgb;
+        *p++ = rom->romSize;
+        *p++ = rom->ramSize;
+        *p++ = rom->flags;
+        memcpy(p, rom->title, TITLE_LENGTH), p += TITLE_LENGTH;
+        memcpy(p, &pathLength, 2);
+
+        fwrite(record, sizeof(record), 1, f);
+        fwrite(rom->path, pathLength, 1, f);
+    }
+
+    fclose(f);
+    return 1;
+}
+
+/*===========================================
+    SCANNING
+============================================*/
+
+// Modification time, as finely as the file system keeps it: nanoseconds, or the file time on Windows
+static long long modificationTime(const char *path, const struct stat *info)
+{
+#ifdef _WIN32
+    WIN32_FILE_ATTRIBUTE_DATA attributes;
+
+    if (GetFileAttributesExA(path, GetFileExInfoStandard, &attributes))
+        return (long long)(((unsigned long long)attributes.ftLastWriteTime.dwHighDateTime << 32) |
+                           attributes.ftLastWriteTime.dwLowDateTime);
+    return ((long long)info->st_mtime + 11644473600LL) * 10000000; // The same, from the seconds
+#else
+    (void)path;
+    return (long long)info->st_mtim.tv_sec * 1000000000 + info->st_mtim.tv_nsec;
+#endif
+}
+
+/*
+    walk
+    ---
+    Add every ROM under 'directory' to 'library', with just what a stat gives.
+*/
+static void walk(const char *directory)
+{
+    DIR *dir = opendir(directory);
+    struct dirent *entry;
+    char path[MAX_PATH_LENGTH];
+    struct stat info;
+
+    if (dir == NULL)
+    {
+        fprintf(stderr, "Failed to open \"%s\".\n", directory);
+        return;
+    }
+
+    while ((entry = readdir(dir)) != NULL)
+    {
+        if (!strcmp(entry->d_name, ".") || !strcmp(entry->d_name, ".."))
+            continue;
+        if (snprintf(path, sizeof(path), "%s" PATH_SEPARATOR "%s", directory, entry->d_name) >= (int)sizeof(path))
+            continue;
+        if (stat(path, &info) != 0)
+            continue;
+
+        if (S_ISDIR(info.st_mode))
+            walk(path);
+        else if (S_ISREG(info.st_mode) && isRom(entry->d_name))
+        {
+            struct romEntry *rom = addEntry(&library);
+            rom->path = strdup(path);
+            rom->size = (unsigned long long)info.st_size;
+            rom->mtime = modificationTime(path, &info);
+        }
+    }
+
+    closedir(dir);
+}
+
+/*
+    mapFile
+    ---
+    Map the whole of a file read only. 'handle' is what unmapFile needs back. Fails if the file isn't
+    'size' bytes any more: touching a mapping past the end of a file that shrank since the stat would
+    raise SIGBUS.
+*/
+static const unsigned char *mapFile(const char *path, size_t size, void **handle)
+{
+#ifdef _WIN32
+    HANDLE file = CreateFileA(path, GENERIC_READ, FILE_SHARE_READ, NULL, OPEN_EXISTING, FILE_FLAG_SEQUENTIAL_SCAN, NULL);
+    HANDLE mapping;
+    LARGE_INTEGER fileSize;
+    const unsigned char *data;
+
+    if (file == INVALID_HANDLE_VALUE)
+        return NULL;
+
+    if (!GetFileSizeEx(file, &fileSize) || (unsigned long long)fileSize.QuadPart != size)
+    {
+        CloseHandle(file);
+        return NULL;
+    }
+
+    mapping = CreateFileMappingA(file, NULL, PAGE_READONLY, 0, 0, NULL);
+    CloseHandle(file); // The mapping keeps it open
+    if (mapping == NULL)
+        return NULL;
+
+    data = MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, size);
+    if (data == NULL)
+    {
+        CloseHandle(mapping);
+        return NULL;
+    }
+
+    *handle = mapping;
+    return data;
+#else
+    int file = open(path, O_RDONLY);
+    struct stat info;
+    void *data;
+
+    if (file < 0)
+        return NULL;
+
+    if (fstat(file, &info) != 0 || (unsigned long long)info.st_size != size)
+    {
+        close(file);
+        return NULL;
+    }
+
+    data = mmap(NULL, size, PROT_READ, MAP_PRIVATE, file, 0);
+    close(file); // The mapping keeps it open
+    if (data == MAP_FAILED)
+        return NULL;
+
+    *handle = NULL;
+    return data;
+#endif
+}
+
+static void unmapFile(const unsigned char *data, size_t size, void *handle)
+{
+#ifdef _WIN32
+    UnmapViewOfFile(data);
+    CloseHandle(handle);
+#else
+    (void)handle;
+    munmap((void *)data, size);
+#endif
+}
+
+/*
+    readRom
+    ---
+    Fill in everything but the path, size & mtime from the file itself.
+*/
+static void readRom(struct romEntry *rom)
+{
+    size_t size = (size_t)rom->size;
+    const unsigned char *data;
+    void *handle;
+    unsigned char headerSum = 0;
+    unsigned short globalSum = 0;
+    size_t i;
+
+    rom->flags = 0;
+    rom->hash = 0;
+    memset(rom->title, 0, sizeof(rom->title));
+
+    if (size < ROM_HEADER_END)
+    {
+        rom->flags = ROM_TOO_SMALL;
+        return;
+    }
+
+    data = mapFile(rom->path, size, &handle);
+    if (data == NULL)
+    {
+        rom->flags = ROM_UNREADABLE;
+        return;
+    }
+
+    // The title stops where loadROM's does, and anything that isn't printable ends it too
+    for (i = 0; i < TITLE_LENGTH; i++)
+    {
+        unsigned char c = data[ROM_OFFSET_NAME + i];
+        if (c < 0x20 || c > 0x7E)
+            break;
+        rom->title[i] = (char)c;
+    }
+
+    rom->cgb = data[ROM_OFFSET_CGB];
+    rom->type = data[ROM_OFFSET_TYPE];
+    rom->romSize = data[ROM_OFFSET_ROM_SIZE];
+    rom->ramSize = data[ROM_OFFSET_RAM_SIZE];
+
+    // What the boot ROM checks: x = x - byte - 1 over 0x134 - 0x14C
+    for (i = ROM_OFFSET_NAME; i < ROM_OFFSET_HEADER_CHECKSUM; i++)
+        headerSum = headerSum - data[i] - 1;
+    if (headerSum == data[ROM_OFFSET_HEADER_CHECKSUM])
+        rom->flags |= ROM_HEADER_OK;
+
+    // Every byte but the checksum itself, which is big endian
+    for (i = 0; i < size; i++)
+        globalSum += data[i];
+    globalSum -= data[ROM_OFFSET_GLOBAL_CHECKSUM] + data[ROM_OFFSET_GLOBAL_CHECKSUM + 1];
+    if (globalSum == ((data[ROM_OFFSET_GLOBAL_CHECKSUM] << 8) | data[ROM_OFFSET_GLOBAL_CHECKSUM + 1]))
+        rom->flags |= ROM_GLOBAL_OK;
+
+    rom->hash = xxh64(data, size, 0);
+
+    unmapFile(data, size, handle);
+}
+
+static void *worker(void *data)
+{
+    int index;
+
+    (void)data;
+
+    for (;;)
+    {
+        pthread_mutex_lock(&lock);
+        index = nextStale++;
+        pthread_mutex_unlock(&lock);
+
+        if (index >= staleCount)
+            return NULL;
+
+        readRom(&library.entries[stale[index]]);
+    }
+}
+
+static void listRoms(void)
+{
+    int i;
+
+    for (i = 0; i < library.count; i++)
+    {
+        const struct romEntry *rom = &library.entries[i];
+
+        printf("%016llx\t%d\t%d\t%02X\t%02X\t%02X\t%02X\t%02X\t%s\t%s\n", rom->hash, !!(rom->flags & ROM_HEADER_OK),
+               !!(rom->flags & ROM_GLOBAL_OK), rom->flags, rom->cgb, rom->type, rom->romSize, rom->ramSize, rom->title,
+               rom->path);
+    }
+}
+
+int main(int argc, char *argv[])
+{
+    pthread_t threads[64];
+    const char *directory = NULL;
+    const char *indexName = DEFAULT_INDEX;
+    int jobs = 0;
+    int list = 0;
+    int kept = 0;
+    int found = 0; // Of the indexed ROMs, changed or not
+    int badChecksums = 0;
+    int i;
+    double start = now();
+
+    for (i = 1; i < argc; i++)
+    {
+        if (!strcmp(argv[i], "-i") && i + 1 < argc)
+            indexName = argv[++i];
+        else if (!strcmp(argv[i], "-j") && i + 1 < argc)
+            jobs = atoi(argv[++i]);
+        else if (!strcmp(argv[i], "-l"))
+            list = 1;
+        else
+            directory = argv[i];
+    }
+
+    if (directory == NULL)
+    {
+        printf("Usage: %s <rom directory> [-i <index file>] [-j <jobs>] [-l]\n", argv[0]);
+        return 2;
+    }
+
+    loadIndex(indexName);
+    walk(directory);
+    qsort(library.entries, library.count, sizeof(struct romEntry), compareEntries);
+
+    // Anything indexed with the same size & mtime is taken as it is, the rest gets read
+    stale = malloc(sizeof(int) * (library.count ? library.count : 1));
+    for (i = 0; i < library.count; i++)
+    {
+        struct romEntry *rom = &library.entries[i];
+        const struct romEntry *old = bsearch(rom, indexed.entries, indexed.count, sizeof(struct romEntry), compareEntries);
+
+        found += old != NULL;
+        if (old != NULL && old->size == rom->size && old->mtime == rom->mtime)
+        {
+            char *path = rom->path;
+            *rom = *old;
+            rom->path = path;
+            kept++;
+        }
+        else
+            stale[staleCount++] = i;
+    }
+
+    if (staleCount)
+    {
+        if (jobs <= 0)
+            jobs = cpuCount();
+        if (jobs > (int)(sizeof(threads) / sizeof(threads[0])))
+            jobs = sizeof(threads) / sizeof(threads[0]);
+        if (jobs > staleCount)
+            jobs = staleCount;
+
+        for (i = 0; i < jobs; i++)
+            pthread_create(&threads[i], NULL, worker, NULL);
+        for (i = 0; i < jobs; i++)
+            pthread_join(threads[i], NULL);
+    }
+
+    // Only written when something changed: new or changed files, or ones that have gone
+    if (staleCount || found != indexed.count)
+        saveIndex(indexName);
+
+    if (list)
+        listRoms();
+
+    for (i = 0; i < library.count; i++)
+    {
+        if ((library.entries[i].flags & (ROM_HEADER_OK | ROM_GLOBAL_OK)) != (ROM_HEADER_OK | ROM_GLOBAL_OK))
+            badChecksums++;
+    }
+
+    fprintf(list ? stderr : stdout, "%d ROMs (%d read, %d removed, %d with a bad checksum) in %.1fms\n",
+            library.count, staleCount, indexed.count - found, badChecksums, (now() - start) * 1000);
+
+    free(stale);
+    freeList(&library);
+    freeList(&indexed);
+    return 0;
+}
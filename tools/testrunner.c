@@ -0,0 +1,299 @@
+/*
+    NAME: TMC
+    INIT DATE: 19/10/2026
+    LAST EDIT DATE: 19/10/2026
+    DESC:
+        Runs every test ROM (.gb / .gbc) in a directory through the emulator, several at once, and
+        reports which passed. Each ROM gets its own headless emulator process in test ROM mode (see
+        'include/testrom.h'), so a crash or hang in one can't take the others with it.
+
+        Single step CPU test files (.json, one per opcode, see 'include/cputest.h') are run the same
+        way with --cputest. The CPU's state is global, so a process per file is also what lets them
+        run in parallel. A full set (500 files, 500,000 vectors) takes a couple of seconds.
+
+            testrunner <emulator> <rom directory> [-j <jobs>] [-c <cycles>] [-v]
+
+            -j  ROMs to run at once (default: number of CPUs)
+            -c  cycle budget per ROM (default 200000000, about 48 emulated seconds)
+            -v  print the serial output of ROMs that didn't pass (the failures, for .json files)
+
+        Exits with 0 only if every ROM passed.
+
+        Build: gcc .\tools\testrunner.c -O2 -o testrunner -lpthread
+*/
+
+#include <dirent.h>
+#include <pthread.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#ifdef _WIN32
+#include <windows.h>
+#define NULL_DEVICE "NUL"
+#define PATH_SEPARATOR "\\"
+#else
+#include <unistd.h>
+#define NULL_DEVICE "/dev/null"
+#define PATH_SEPARATOR "/"
+#endif
+
+#define MAX_ROMS 4096
+#define MAX_PATH_LENGTH 1024
+#define DEFAULT_CYCLES 200000000ULL
+
+struct testCase
+{
+    char name[256];
+    char result[16];       // First line of the result file
+    char serial[256];      // Start of the serial output (or the failures), for -v
+    unsigned long long cycles;
+    double seconds;
+};
+
+static const char *emulator;
+static const char *directory;
+static unsigned long long cycleBudget = DEFAULT_CYCLES;
+static int verbose;
+
+static struct testCase tests[MAX_ROMS];
+static int testCount;
+static int nextTest;
+static int finished;
+static pthread_mutex_t lock = PTHREAD_MUTEX_INITIALIZER;
+
+static int isRom(const char *name)
+{
+    const char *extension = strrchr(name, '.');
+    return extension != NULL && (!strcmp(extension, ".gb") || !strcmp(extension, ".gbc"));
+}
+
+static int isCpuTest(const char *name)
+{
+    const char *extension = strrchr(name, '.');
+    return extension != NULL && !strcmp(extension, ".json");
+}
+
+static int compareTests(const void *a, const void *b)
+{
+    return strcmp(((const struct testCase *)a)->name, ((const struct testCase *)b)->name);
+}
+
+static int cpuCount(void)
+{
+#ifdef _WIN32
+    SYSTEM_INFO info;
+    GetSystemInfo(&info);
+    return (int)info.dwNumberOfProcessors;
+#else
+    long count = sysconf(_SC_NPROCESSORS_ONLN);
+    return count > 0 ? (int)count : 1;
+#endif
+}
+
+static int processId(void)
+{
+#ifdef _WIN32
+    return (int)GetCurrentProcessId();
+#else
+    return (int)getpid();
+#endif
+}
+
+static double now(void)
+{
+    struct timespec time;
+    timespec_get(&time, TIME_UTC);
+    return time.tv_sec + time.tv_nsec / 1e9;
+}
+
+/*
+    readResult
+    ---
+    Pull the verdict, cycle count and the start of the serial output out of a result file.
+*/
+static void readResult(struct testCase *test, const char *resultName)
+{
+    FILE *f = fopen(resultName, "r");
+    char line[512];
+    size_t length = 0;
+    int inSerial = 0;
+
+    strcpy(test->result, "ERROR"); // No file means the emulator never got going
+    test->serial[0] = '\0';
+    if (f == NULL)
+        return;
+
+    if (fgets(line, sizeof(line), f))
+        sscanf(line, "%15s", test->result);
+
+    while (fgets(line, sizeof(line), f))
+    {
+        if (inSerial)
+        {
+            strncpy(test->serial + length, line, sizeof(test->serial) - 1 - length);
+            test->serial[sizeof(test->serial) - 1] = '\0';
+            length = strlen(test->serial);
+        }
+        else if (!strncmp(line, "cycles:", 7))
+            test->cycles = strtoull(line + 7, NULL, 10);
+        else if (!strncmp(line, "serial:", 7) || !strncmp(line, "details:", 8))
+            inSerial = 1;
+    }
+
+    fclose(f);
+
+    // One line is enough for a summary
+    for (length = 0; test->serial[length] != '\0'; length++)
+    {
+        if (test->serial[length] == '\n' || test->serial[length] == '\r')
+            test->serial[length] = ' ';
+    }
+    while (length > 0 && test->serial[length - 1] == ' ')
+        test->serial[--length] = '\0';
+}
+
+/*
+    runTest
+    ---
+    Run one ROM (or CPU test file) to completion in its own emulator process. The emulator's own
+    console output is thrown away, only the result file matters. Its name has the runner's process ID
+    in it, so runners started from the same directory don't read each other's results.
+*/
+static void runTest(struct testCase *test, int index)
+{
+    char resultName[64];
+    char command[MAX_PATH_LENGTH * 2 + 256];
+    double start = now();
+
+    sprintf(resultName, "testrunner_%d_%d.result", processId(), index);
+    remove(resultName);
+
+    if (isCpuTest(test->name))
+        snprintf(command, sizeof(command), "\"%s\" --test \"%s\" --cputest \"%s" PATH_SEPARATOR "%s\" > " NULL_DEVICE " 2>&1",
+                 emulator, resultName, directory, test->name);
+    else
+        snprintf(command, sizeof(command), "\"%s\" --headless --nosound --nopace --test \"%s\" --cycles %llu \"%s" PATH_SEPARATOR "%s\" > " NULL_DEVICE " 2>&1",
+                 emulator, resultName, cycleBudget, directory, test->name);
+#ifdef _WIN32
+    // cmd.exe strips the first and last quote of the whole line
+    memmove(command + 1, command, strlen(command) + 1);
+    command[0] = '"';
+    strcat(command, "\"");
+#endif
+    system(command);
+
+    readResult(test, resultName);
+    remove(resultName);
+    test->seconds = now() - start;
+}
+
+static void *worker(void *data)
+{
+    int index;
+
+    for (;;)
+    {
+        pthread_mutex_lock(&lock);
+        index = nextTest++;
+        pthread_mutex_unlock(&lock);
+
+        if (index >= testCount)
+            return NULL;
+
+        runTest(&tests[index], index);
+
+        pthread_mutex_lock(&lock);
+        finished++;
+        printf("[%d/%d] %-7s %s (%.2fs)\n", finished, testCount, tests[index].result, tests[index].name, tests[index].seconds);
+        fflush(stdout);
+        pthread_mutex_unlock(&lock);
+    }
+}
+
+int main(int argc, char *argv[])
+{
+    pthread_t threads[64];
+    int jobs = 0;
+    int passed = 0;
+    int i;
+    DIR *dir;
+    struct dirent *entry;
+    double start;
+
+    for (i = 1; i < argc; i++)
+    {
+        if (!strcmp(argv[i], "-j") && i + 1 < argc)
+            jobs = atoi(argv[++i]);
+        else if (!strcmp(argv[i], "-c") && i + 1 < argc)
+            cycleBudget = strtoull(argv[++i], NULL, 0);
+        else if (!strcmp(argv[i], "-v"))
+            verbose = 1;
+        else if (emulator == NULL)
+            emulator = argv[i];
+        else
+            directory = argv[i];
+    }
+
+    if (emulator == NULL || directory == NULL)
+    {
+        printf("Usage: %s <emulator> <rom directory> [-j <jobs>] [-c <cycles>] [-v]\n", argv[0]);
+        return 2;
+    }
+
+    dir = opendir(directory);
+    if (dir == NULL)
+    {
+        printf("Failed to open \"%s\".\n", directory);
+        return 2;
+    }
+
+    while ((entry = readdir(dir)) != NULL && testCount < MAX_ROMS)
+    {
+        if ((isRom(entry->d_name) || isCpuTest(entry->d_name)) && strlen(entry->d_name) < sizeof(tests[0].name))
+            strcpy(tests[testCount++].name, entry->d_name);
+    }
+    closedir(dir);
+
+    if (testCount == 0)
+    {
+        printf("No ROMs or CPU tests in \"%s\".\n", directory);
+        return 2;
+    }
+
+    qsort(tests, testCount, sizeof(tests[0]), compareTests);
+
+    if (jobs <= 0)
+        jobs = cpuCount();
+    if (jobs > (int)(sizeof(threads) / sizeof(threads[0])))
+        jobs = sizeof(threads) / sizeof(threads[0]);
+    if (jobs > testCount)
+        jobs = testCount;
+
+    printf("Running %d tests, %d at a time...\n", testCount, jobs);
+    start = now();
+
+    for (i = 0; i < jobs; i++)
+        pthread_create(&threads[i], NULL, worker, NULL);
+    for (i = 0; i < jobs; i++)
+        pthread_join(threads[i], NULL);
+
+    // Summary, in name order
+    printf("\n");
+    for (i = 0; i < testCount; i++)
+    {
+        if (!strcmp(tests[i].result, "PASSED"))
+        {
+            passed++;
+            continue;
+        }
+
+        printf("%-7s %s (%llu cycles)\n", tests[i].result, tests[i].name, tests[i].cycles);
+        if (verbose && tests[i].serial[0] != '\0')
+            printf("        %s\n", tests[i].serial);
+    }
+
+    printf("\n%d/%d passed in %.2fs\n", passed, testCount, now() - start);
+    return passed == testCount ? 0 : 1;
+}